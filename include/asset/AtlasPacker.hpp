@@ -0,0 +1,69 @@
+#ifndef ASSET_ATLASPACKER_HPP
+#define ASSET_ATLASPACKER_HPP
+
+#include <string>
+#include <vector>
+
+struct AtlasImage
+{
+	std::string name;
+	int width;
+	int height;
+	// tightly packed RGBA8
+	std::vector<unsigned char> pixels;
+};
+
+struct AtlasEntry
+{
+	std::string name;
+	int page;
+	// texel rectangle of the image itself, without its gutter
+	int x;
+	int y;
+	int width;
+	int height;
+	float u0;
+	float v0;
+	float u1;
+	float v1;
+
+	// maps a UV in [0, 1] over the source image onto the page
+	void remap(float &u, float &v) const;
+};
+
+struct AtlasPage
+{
+	int width;
+	int height;
+	std::vector<unsigned char> pixels;
+	// texels covered by images, gutters excluded
+	size_t usedTexels;
+
+	float occupancy() const;
+};
+
+struct AtlasOptions
+{
+	int pageSize = 1024;
+	// edge texels repeated around every image so filtering never reads a neighbour
+	int gutter = 4;
+	// rectangles start and end on 2^mipLevels boundaries, so that many levels below the base stay clean
+	int mipLevels = 2;
+};
+
+// MaxRects bin packing (best short side fit) of small images into shared RGBA8 pages.
+// Repeat wrapping does not survive atlasing, only images sampled within [0, 1] belong here.
+class AtlasPacker
+{
+public:
+	static bool pack(const std::vector<AtlasImage> &images, const AtlasOptions &options, std::vector<AtlasPage> &pages, std::vector<AtlasEntry> &entries);
+
+	// rewrites the UV pair at uvOffset of every vertex, stride and offset are in floats
+	static void remapUVs(float *vertices, const int &vertexCount, const int &stride, const int &uvOffset, const AtlasEntry &entry);
+
+	// text manifest, one "page <file> <width> <height>" line per page, then one line per image
+	static bool writeManifest(const std::string &path, const std::vector<std::string> &pageFiles, const std::vector<AtlasPage> &pages, const std::vector<AtlasEntry> &entries);
+	static bool readManifest(const std::string &path, std::vector<std::string> &pageFiles, std::vector<AtlasEntry> &entries);
+};
+
+#endif // ASSET_ATLASPACKER_HPP
\ No newline at end of file
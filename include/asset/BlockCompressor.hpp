@@ -0,0 +1,34 @@
+#ifndef ASSET_BLOCKCOMPRESSOR_HPP
+#define ASSET_BLOCKCOMPRESSOR_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "asset/TextureFile.hpp"
+
+enum BC_QUALITY
+{
+	// bounding box endpoints, one pass
+	BC_FAST,
+	// principal axis endpoints refined by least squares
+	BC_NORMAL
+};
+
+// CPU encoder for BC1 (DXT1, opaque RGB) and BC3 (DXT5, RGB + interpolated alpha) blocks.
+// Levels are split into block rows across the shared ThreadPool, the per pixel palette search
+// uses SSE2 when the compiler targets it.
+class BlockCompressor
+{
+public:
+	static void encodeBC1Block(const unsigned char rgba[64], unsigned char out[8], const BC_QUALITY &quality);
+	static void encodeBC3Block(const unsigned char rgba[64], unsigned char out[16], const BC_QUALITY &quality);
+	static void decodeBC1Block(const unsigned char block[8], unsigned char rgba[64]);
+	static void decodeBC3Block(const unsigned char block[16], unsigned char rgba[64]);
+
+	// format is TEX_FMT_BC1 or TEX_FMT_BC3, channels is the channel count of level (3 or 4)
+	static TextureLevel compress(const TextureLevel &level, const int &channels, const uint32_t &format, const BC_QUALITY &quality, const bool &parallel = true);
+	// back to tightly packed RGBA8, used to measure quality
+	static std::vector<unsigned char> decompress(const TextureLevel &level, const uint32_t &format);
+};
+
+#endif // ASSET_BLOCKCOMPRESSOR_HPP
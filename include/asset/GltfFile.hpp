@@ -0,0 +1,170 @@
+#ifndef ASSET_GLTFFILE_HPP
+#define ASSET_GLTFFILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "asset/MeshFile.hpp"
+#include "asset/TextureFile.hpp"
+#include "util/MappedFile.hpp"
+
+// accessor component types, the values are the GL enums
+enum GLTF_COMPONENT_TYPES
+{
+	GLTF_BYTE = 5120,
+	GLTF_UNSIGNED_BYTE = 5121,
+	GLTF_SHORT = 5122,
+	GLTF_UNSIGNED_SHORT = 5123,
+	GLTF_UNSIGNED_INT = 5125,
+	GLTF_FLOAT = 5126
+};
+
+struct GltfBufferView
+{
+	int buffer;
+	size_t offset;
+	size_t length;
+	// 0 when tightly packed
+	size_t stride;
+};
+
+struct GltfAccessor
+{
+	// -1 when the accessor has no data of its own (all zeros, usually with sparse values on top)
+	int bufferView;
+	size_t offset;
+	uint32_t componentType;
+	bool normalized;
+	size_t count;
+	int components;
+	bool hasBounds;
+	float min[3];
+	float max[3];
+	// sparse substitution, sparseCount 0 when there is none
+	size_t sparseCount;
+	int sparseIndexView;
+	size_t sparseIndexOffset;
+	uint32_t sparseIndexType;
+	int sparseValueView;
+	size_t sparseValueOffset;
+};
+
+struct GltfPrimitive
+{
+	// attribute location, accessor
+	std::vector<std::pair<uint32_t, int>> attributes;
+	// -1 for non-indexed geometry
+	int indices;
+	int material;
+	int mode;
+};
+
+struct GltfMesh
+{
+	std::string name;
+	std::vector<GltfPrimitive> primitives;
+};
+
+struct GltfImage
+{
+	// relative to the document, empty when the image is in a buffer view
+	std::string uri;
+	int bufferView;
+};
+
+struct GltfMaterial
+{
+	float baseColor[4];
+	// image index, -1 when untextured
+	int baseColorImage;
+};
+
+// A .gltf or .glb with its buffers. The file and every external buffer are memory mapped, so buffer
+// data points into the mappings, only data: URIs are decoded into memory.
+struct GltfDocument
+{
+	std::string directory;
+	std::vector<std::shared_ptr<MappedFile>> files;
+	std::vector<std::vector<unsigned char>> embedded;
+	std::vector<const unsigned char *> bufferData;
+	std::vector<size_t> bufferSize;
+
+	std::vector<GltfBufferView> bufferViews;
+	std::vector<GltfAccessor> accessors;
+	std::vector<GltfMesh> meshes;
+	std::vector<GltfImage> images;
+	std::vector<GltfMaterial> materials;
+};
+
+// One vertex attribute or index stream in the layout GL is given. When the accessor can be drawn from
+// as it is the stream is a window into its buffer view, otherwise it owns converted bytes.
+struct GltfStream
+{
+	uint32_t location;
+	uint32_t componentType;
+	int components;
+	bool normalized;
+	size_t stride;
+	size_t offset;
+	// -1 when converted
+	int bufferView;
+	std::vector<unsigned char> converted;
+};
+
+struct GltfPreparedPrimitive
+{
+	std::vector<GltfStream> attributes;
+	GltfStream indices;
+	size_t indexCount;
+	int material;
+	// false when an index reaches past the shortest attribute stream
+	bool valid;
+};
+
+struct GltfPreparedImage
+{
+	// native channel count, full mip chain, empty when the image could not be decoded
+	int channels;
+	std::vector<TextureLevel> levels;
+};
+
+// everything the GL side needs, built off the render thread
+struct GltfPrepared
+{
+	std::vector<GltfPreparedPrimitive> primitives;
+	std::vector<GltfPreparedImage> images;
+	// buffer views referenced by a stream, each becomes one GL buffer
+	std::vector<char> viewUsed;
+	MeshBounds bounds;
+	size_t viewBytes;
+	size_t convertedBytes;
+	// primitives that are not triangle lists
+	int skipped;
+};
+
+class GltfFile
+{
+public:
+	// attribute semantics imported, at the locations setupTriangles and bake mesh use
+	static const uint32_t POSITION_LOCATION = 0;
+	static const uint32_t COLOR_LOCATION = 1;
+	static const uint32_t TEXCOORD_LOCATION = 2;
+	static const uint32_t NORMAL_LOCATION = 4;
+
+	static int componentSize(const uint32_t &componentType);
+
+	static bool open(const std::string &path, GltfDocument &document);
+	static const unsigned char *viewData(const GltfDocument &document, const int &bufferView);
+
+	// Validates accessors and decides per stream whether it can be used in place. Conversion is only
+	// needed for sparse accessors, accessors without data, 8 bit indices (widened to 16 bits, which
+	// every driver handles natively) and non-indexed primitives (given sequential indices). Images are
+	// decoded and mipmapped in the same pass; with parallel set, primitives and images are spread over
+	// the shared ThreadPool and the pages of every used buffer view are faulted in ahead of the upload.
+	static bool prepare(const GltfDocument &document, GltfPrepared &prepared, const bool &parallel = true);
+};
+
+#endif // ASSET_GLTFFILE_HPP
\ No newline at end of file
@@ -0,0 +1,24 @@
+#ifndef ASSET_JPEGDECODER_HPP
+#define ASSET_JPEGDECODER_HPP
+
+#include <cstddef>
+
+// Baseline (sequential Huffman, 8 bit) JPEG decoder that spreads a single image across the shared
+// ThreadPool. With restart markers every interval is entropy decoded independently; without them
+// entropy decoding runs serially and the dequantisation/IDCT of finished MCU rows is handed to the
+// pool as it goes. Colour conversion is split by rows. The IDCT and YCbCr conversion use SSE2 when
+// the compiler targets it.
+//
+// Returns NULL for anything else (progressive, arithmetic, 12 bit, CMYK, corrupt data), callers
+// fall back to stb_image. Pixels are allocated with malloc, the same as stb_image, so both are
+// released with stbi_image_free.
+class JpegDecoder
+{
+public:
+	// stbi_load conventions: desiredChannels 0 keeps the image's own (1 or 3)
+	static unsigned char *load(const char *path, int *width, int *height, int *channels, const int &desiredChannels, const bool &parallel = true);
+	static unsigned char *decode(const unsigned char *data, const size_t &size, int *width, int *height, int *channels, const int &desiredChannels, const bool &parallel = true);
+	static bool isJpeg(const unsigned char *data, const size_t &size);
+};
+
+#endif // ASSET_JPEGDECODER_HPP
\ No newline at end of file
@@ -0,0 +1,119 @@
+#ifndef ASSET_MESHFILE_HPP
+#define ASSET_MESHFILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// component types of a vertex attribute, the GL type each maps to is picked by the loader
+enum MESH_COMPONENT_TYPES
+{
+	MESH_FLOAT32 = 0,
+	MESH_FLOAT16 = 1,
+	MESH_INT8 = 2,
+	MESH_UINT8 = 3,
+	MESH_INT16 = 4,
+	MESH_UINT16 = 5
+};
+
+// one glVertexAttribPointer call
+struct MeshAttribute
+{
+	uint32_t location;
+	uint32_t type;
+	uint32_t components;
+	uint32_t normalized;
+	uint32_t offset;
+};
+
+// a level of detail, a range of the index blob drawing the shared vertices. error is how far the
+// simplification moved the surface at most, in mesh space, 0 for the full detail level
+struct MeshLod
+{
+	uint32_t indexOffset;
+	uint32_t indexCount;
+	float error;
+};
+
+struct MeshBounds
+{
+	float min[3];
+	float max[3];
+	float center[3];
+	float radius;
+};
+
+// Baked mesh container (".lmesh"): a fixed header, the attribute and LOD tables, then one interleaved vertex
+// blob and one index blob. Both blobs start on a DATA_ALIGNMENT (page) boundary, so the ranges of a
+// memory mapping can be handed to glBufferData as they are, nothing is parsed or copied on load.
+// Quantized positions are stored relative to the mesh: position = stored * dequantizeScale +
+// dequantizeOffset, which the renderer folds into its transform. Bounds are in mesh space.
+struct MeshFileHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t attributeCount;
+	uint32_t stride;
+	uint32_t vertexCount;
+	uint32_t indexCount;
+	// 2 or 4 bytes per index
+	uint32_t indexSize;
+	// 0 when the whole index blob is the only level
+	uint32_t lodCount;
+	uint64_t vertexOffset;
+	uint64_t indexOffset;
+	MeshBounds bounds;
+	float dequantizeScale[3];
+	float dequantizeOffset[3];
+};
+
+// a mesh being built, indices are narrowed to 16 bits on write when they fit
+struct MeshData
+{
+	std::vector<MeshAttribute> attributes;
+	uint32_t stride;
+	std::vector<unsigned char> vertices;
+	std::vector<uint32_t> indices;
+	// finest first, empty when indices are a single level
+	std::vector<MeshLod> lods;
+	// identity unless positions are quantized, see MeshFileHeader
+	float dequantizeScale[3] = {1.f, 1.f, 1.f};
+	float dequantizeOffset[3] = {0.f, 0.f, 0.f};
+};
+
+// a parsed file, pointers reference the caller's buffer (usually a MappedFile)
+struct MeshFileView
+{
+	MeshFileHeader header;
+	std::vector<MeshAttribute> attributes;
+	std::vector<MeshLod> lods;
+	const unsigned char *vertices;
+	size_t vertexBytes;
+	const unsigned char *indices;
+	size_t indexBytes;
+};
+
+class MeshFile
+{
+public:
+	static const uint32_t VERSION = 3;
+	static const uint32_t DATA_ALIGNMENT = 4096;
+	static const uint32_t MAX_ATTRIBUTES = 16;
+	static const uint32_t MAX_LODS = 32;
+	// the bounds are taken from the attribute at this location
+	static const uint32_t POSITION_LOCATION = 0;
+
+	static int componentSize(const uint32_t &type);
+	// decodes up to 4 components of one vertex's attribute to float, normalized types to [0, 1] or [-1, 1]
+	static void readAttribute(const unsigned char *vertices, const uint32_t &stride, const MeshAttribute &attribute, const size_t &vertex, float out[4]);
+	// in mesh space, positions are dequantized first
+	static MeshBounds computeBounds(const MeshData &mesh);
+
+	static bool write(const std::string &path, const MeshData &mesh);
+	static bool parse(const unsigned char *data, const size_t &size, MeshFileView &view);
+	// copies a parsed file back into an editable mesh, indices widened to 32 bits
+	static void read(const MeshFileView &view, MeshData &mesh);
+};
+
+#endif // ASSET_MESHFILE_HPP
\ No newline at end of file
@@ -0,0 +1,51 @@
+#ifndef ASSET_MESHOPTIMIZER_HPP
+#define ASSET_MESHOPTIMIZER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "asset/MeshFile.hpp"
+
+// post-transform cache behaviour of an index buffer, simulated as a FIFO of cacheSize vertices
+struct VertexCacheStats
+{
+	// average cache miss ratio, vertices transformed per triangle: 0.5 at best, 3 at worst
+	float acmr;
+	// average transform to vertex ratio, vertices transformed per vertex: 1 at best
+	float atvr;
+};
+
+struct OptimizeOptions
+{
+	int cacheSize = 16;
+	// clusters may be split for overdraw ordering while their ACMR stays within this factor of the mesh's
+	float overdrawThreshold = 1.05f;
+	bool overdraw = true;
+	bool fetch = true;
+};
+
+// Index and vertex reordering for baked meshes, in three passes. Triangles are first reordered for the
+// post-transform vertex cache with Tipsify (Sander, Nehab, Barczak 2007), which fans around recently
+// used vertices and records where it had to jump to a cold part of the mesh. Those jumps split the
+// triangles into clusters that are then sorted front to back from the mesh centre along their average
+// normal, so early-Z rejects more of what is drawn later. Finally vertices are renumbered in the order
+// the index buffer first uses them, which keeps vertex fetch sequential.
+class MeshOptimizer
+{
+public:
+	static VertexCacheStats analyzeVertexCache(const std::vector<uint32_t> &indices, const size_t &vertexCount, const int &cacheSize);
+
+	// clusterStarts receives the first triangle of every cluster, the first one is always 0
+	static void optimizeVertexCache(std::vector<uint32_t> &indices, const size_t &vertexCount, const int &cacheSize,
+									std::vector<uint32_t> *clusterStarts = NULL);
+	static void optimizeOverdraw(const MeshData &mesh, std::vector<uint32_t> &indices, const std::vector<uint32_t> &clusterStarts,
+								 const int &cacheSize, const float &threshold);
+	// drops vertices no triangle uses
+	static void optimizeVertexFetch(MeshData &mesh);
+
+	// the whole index buffer as one level, run it before LODs are added
+	static void optimize(MeshData &mesh, const OptimizeOptions &options = OptimizeOptions());
+};
+
+#endif // ASSET_MESHOPTIMIZER_HPP
\ No newline at end of file
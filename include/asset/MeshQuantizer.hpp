@@ -0,0 +1,55 @@
+#ifndef ASSET_MESHQUANTIZER_HPP
+#define ASSET_MESHQUANTIZER_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "asset/MeshFile.hpp"
+
+enum QUANTIZE_POSITIONS
+{
+	QUANTIZE_POSITION_FLOAT = 0,
+	// half floats of the position scaled into [-1, 1] around the bounds centre
+	QUANTIZE_POSITION_HALF,
+	// 16 bit integers over the bounds, read unnormalized so the exact step lives in the dequantize scale
+	QUANTIZE_POSITION_INT16
+};
+
+struct QuantizeOptions
+{
+	QUANTIZE_POSITIONS position = QUANTIZE_POSITION_INT16;
+	// colours as normalized unsigned bytes
+	bool colors = true;
+	// texcoords as normalized unsigned shorts, half floats where they leave [0, 1]
+	bool texcoords = true;
+	// normals as normalized shorts
+	bool normals = true;
+};
+
+// difference between an attribute before and after quantization, in the units of the attribute
+// (mesh space for positions), measured per vertex as the length of the difference vector
+struct QuantizeError
+{
+	uint32_t location;
+	uint32_t bytesBefore;
+	uint32_t bytesAfter;
+	float maxError;
+	float rmsError;
+};
+
+// Shrinks the interleaved vertex format of a mesh. Every attribute starts on a 4 byte boundary, so
+// a float position/colour/uv vertex of 32 bytes becomes 16 (8 for an int16 position, 4 for the
+// colour, 4 for the uv). Attributes at other locations are copied as they are. Positions are
+// quantized against the mesh bounds and the mesh carries the transform back, see MeshFileHeader.
+class MeshQuantizer
+{
+public:
+	// "float" (no quantization at all), "half" or "int16"
+	static bool parseFormat(const std::string &name, QuantizeOptions &options);
+
+	static void quantize(const MeshData &source, const QuantizeOptions &options, MeshData &quantized);
+	static void measure(const MeshData &original, const MeshData &quantized, std::vector<QuantizeError> &errors);
+};
+
+#endif // ASSET_MESHQUANTIZER_HPP
\ No newline at end of file
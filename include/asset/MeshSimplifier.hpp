@@ -0,0 +1,42 @@
+#ifndef ASSET_MESHSIMPLIFIER_HPP
+#define ASSET_MESHSIMPLIFIER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "asset/MeshFile.hpp"
+
+struct LodOptions
+{
+	// every level aims for this fraction of the previous level's triangles
+	float ratio = 0.5f;
+	// including the full detail level
+	int maxLevels = 8;
+	// no level is simplified further once it is this small
+	size_t minTriangles = 64;
+	// the chain stops once its error would exceed this fraction of the bounding radius
+	float maxError = 0.05f;
+	int cacheSize = 16;
+};
+
+// Edge collapse simplification driven by quadric error metrics (Garland, Heckbert 1997). Vertices only
+// ever collapse onto other existing vertices, so every level indexes the same vertex buffer and a LOD
+// is nothing more than another range of the index blob. Vertices sharing a position are welded for
+// the error quadrics, but the attributes that split them stay intact: border vertices only move along
+// the border, vertices on a UV or normal seam move along the seam together with their twin on the
+// other side, and vertices where more than two charts meet never move at all. Collapses that would
+// flip a triangle are rejected.
+class MeshSimplifier
+{
+public:
+	// simplifies the triangles of indices towards targetIndexCount without moving the surface more
+	// than maxError (mesh units), returns the error actually reached
+	static float simplify(const MeshData &mesh, const std::vector<uint32_t> &indices, const size_t &targetIndexCount, const float &maxError,
+						  std::vector<uint32_t> &result);
+	// appends every coarser level to mesh.indices and fills mesh.lods, the existing indices stay level
+	// 0. Each level is simplified from the one before it and reordered for the vertex cache.
+	static void buildLods(MeshData &mesh, const LodOptions &options = LodOptions());
+};
+
+#endif // ASSET_MESHSIMPLIFIER_HPP
\ No newline at end of file
@@ -0,0 +1,35 @@
+#ifndef ASSET_MIPGENERATOR_HPP
+#define ASSET_MIPGENERATOR_HPP
+
+#include <vector>
+
+#include "asset/TextureFile.hpp"
+
+enum MIP_FILTERS
+{
+	// 2x2 average
+	MIP_BOX,
+	// 6 tap windowed sinc, sharper than the box without ringing much
+	MIP_KAISER
+};
+
+struct MipOptions
+{
+	MIP_FILTERS filter = MIP_BOX;
+	// colour channels hold sRGB encoded values, filter them in linear space
+	bool srgb = true;
+	// > 0: rescale alpha on every level so the fraction of texels above this cutoff matches level 0
+	float alphaCutoff = 0.f;
+	// split the rows of each level across the shared ThreadPool
+	bool parallel = true;
+};
+
+// CPU mip chain generation, levels are kept in linear float between steps so rounding does not
+// accumulate down the chain. The separable filter passes use SSE2/AVX when the compiler targets them.
+class MipGenerator
+{
+public:
+	static void generate(const unsigned char *pixels, const int &width, const int &height, const int &channels, const MipOptions &options, std::vector<TextureLevel> &levels);
+};
+
+#endif // ASSET_MIPGENERATOR_HPP
\ No newline at end of file
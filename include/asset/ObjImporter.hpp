@@ -0,0 +1,18 @@
+#ifndef ASSET_OBJIMPORTER_HPP
+#define ASSET_OBJIMPORTER_HPP
+
+#include <string>
+
+#include "asset/MeshFile.hpp"
+
+// Wavefront OBJ to MeshData for the bake tool. Reads v/vt/vn and f (polygons are fanned into
+// triangles, negative indices count from the end), everything else is skipped. Each distinct
+// position/uv/normal triple becomes one vertex: position at location 0, uv at 2 and normal at 4,
+// the last two only when the file has them.
+class ObjImporter
+{
+public:
+	static bool load(const std::string &path, MeshData &mesh);
+};
+
+#endif // ASSET_OBJIMPORTER_HPP
\ No newline at end of file
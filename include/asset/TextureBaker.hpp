@@ -0,0 +1,31 @@
+#ifndef ASSET_TEXTUREBAKER_HPP
+#define ASSET_TEXTUREBAKER_HPP
+
+#include <string>
+#include <vector>
+
+#include "asset/TextureFile.hpp"
+#include "asset/BlockCompressor.hpp"
+#include "asset/MipGenerator.hpp"
+
+struct BakeOptions
+{
+	// BC1 for opaque images, BC3 when there is an alpha channel
+	bool compress = false;
+	BC_QUALITY quality = BC_NORMAL;
+	MipOptions mips;
+};
+
+// Offline conversion of source images into baked .ltex files with a full mip chain.
+class TextureBaker
+{
+public:
+	// "res/textures/container.jpg" -> "res/textures/container.ltex"
+	static std::string bakedPathFor(const std::string &sourcePath);
+	// true if there is no baked file, or the source is newer than it
+	static bool isStale(const std::string &sourcePath, const std::string &bakedPath);
+
+	static bool bake(const std::string &sourcePath, const std::string &outputPath, const BakeOptions &options = BakeOptions());
+};
+
+#endif // ASSET_TEXTUREBAKER_HPP
\ No newline at end of file
@@ -0,0 +1,76 @@
+#ifndef ASSET_TEXTUREFILE_HPP
+#define ASSET_TEXTUREFILE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum TEXTURE_FORMATS
+{
+	TEX_FMT_R8 = 1,
+	TEX_FMT_RG8 = 2,
+	TEX_FMT_RGB8 = 3,
+	TEX_FMT_RGBA8 = 4,
+	// 4x4 block compressed, 8 and 16 bytes per block
+	TEX_FMT_BC1 = 16,
+	TEX_FMT_BC3 = 17
+};
+
+// Baked texture container (".ltex"): a fixed header, one entry per mip level, then the level data,
+// each level starting on a DATA_ALIGNMENT boundary so it can be handed to GL straight from a mapping.
+struct TextureFileHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t format;
+	uint32_t width;
+	uint32_t height;
+	uint32_t mipCount;
+	uint32_t flags;
+	uint32_t reserved;
+};
+
+struct TextureFileMip
+{
+	uint64_t offset;
+	uint64_t size;
+	uint32_t width;
+	uint32_t height;
+};
+
+enum TEXTURE_FILE_FLAGS
+{
+	TEX_FLAG_SRGB = 1 << 0
+};
+
+struct TextureLevel
+{
+	uint32_t width;
+	uint32_t height;
+	std::vector<unsigned char> data;
+};
+
+// a parsed file, pointers reference the caller's buffer (usually a MappedFile)
+struct TextureFileView
+{
+	TextureFileHeader header;
+	std::vector<TextureFileMip> mips;
+	std::vector<const unsigned char *> data;
+};
+
+class TextureFile
+{
+public:
+	static const uint32_t VERSION = 1;
+	static const uint32_t DATA_ALIGNMENT = 16;
+	static const uint32_t MAX_MIPS = 16;
+
+	// 0 for block compressed formats
+	static int bytesPerPixel(const uint32_t &format);
+	static bool isCompressed(const uint32_t &format);
+	static size_t levelSize(const uint32_t &format, const uint32_t &width, const uint32_t &height);
+	static bool write(const std::string &path, const uint32_t &format, const uint32_t &flags, const std::vector<TextureLevel> &levels);
+	static bool parse(const unsigned char *data, const size_t &size, TextureFileView &view);
+};
+
+#endif // ASSET_TEXTUREFILE_HPP
\ No newline at end of file
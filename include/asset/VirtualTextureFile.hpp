@@ -0,0 +1,61 @@
+#ifndef ASSET_VIRTUALTEXTUREFILE_HPP
+#define ASSET_VIRTUALTEXTUREFILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "asset/TextureFile.hpp"
+
+// Tiled page file for virtual texturing (".vtex"). Every mip level is cut into tileSize x tileSize
+// pages, stored level by level in row major order after the header. Each tile is RGBA8 and carries
+// `border` extra texels on every side, copied from its neighbours (clamped at the image edge), so
+// bilinear filtering inside a cache slot never reads another page. All tiles have the same size,
+// so a page's offset follows from its index. Levels stop at the first one that fits in one page.
+struct VirtualTextureHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t width;
+	uint32_t height;
+	uint32_t tileSize;
+	uint32_t border;
+	uint32_t levels;
+	uint32_t reserved;
+};
+
+// a parsed file, tile pointers reference the caller's buffer (usually a MappedFile)
+struct VirtualTextureView
+{
+	VirtualTextureHeader header;
+	// per level
+	std::vector<uint32_t> pagesX;
+	std::vector<uint32_t> pagesY;
+	std::vector<uint32_t> firstPage;
+	const unsigned char *tiles;
+	size_t tileBytes;
+
+	// texels per side of a stored tile, border included
+	uint32_t paddedSize() const;
+	const unsigned char *tile(const uint32_t &level, const uint32_t &x, const uint32_t &y) const;
+};
+
+class VirtualTextureFile
+{
+public:
+	static const uint32_t VERSION = 1;
+	static const uint32_t DATA_ALIGNMENT = 4096;
+	static const uint32_t MAX_LEVELS = 24;
+	// a page with its border on both sides, one of them must fit in any GL texture
+	static const uint32_t MAX_PADDED_SIZE = 4096;
+	// page coordinates are packed into 24 bits each
+	static const uint32_t MAX_PAGES_PER_SIDE = 1u << 24;
+
+	static uint32_t pageCount(const uint32_t &texels, const uint32_t &tileSize);
+	// levels is a full RGBA8 mip chain, as MipGenerator builds it, only the levels needed are written
+	static bool write(const std::string &path, const std::vector<TextureLevel> &levels, const uint32_t &tileSize, const uint32_t &border);
+	static bool parse(const unsigned char *data, const size_t &size, VirtualTextureView &view);
+};
+
+#endif // ASSET_VIRTUALTEXTUREFILE_HPP
\ No newline at end of file
@@ -0,0 +1,25 @@
+#ifndef BENCH_BENCH_HPP
+#define BENCH_BENCH_HPP
+
+#include <chrono>
+#include <iostream>
+
+#include "graphics/Shader.hpp"
+#include "util/Hash.hpp"
+
+class Bench
+{
+public:
+	// compares per call cost of string lookups against cached handles, run with --bench
+	static void uniformSetters(Shader &shader, const char *uniformName, const int &updatesPerFrame, const int &frames);
+	// CPU mip chains (generation plus upload of the extra levels) against glGenerateMipmap
+	static void mipGeneration(const char *imagePath, const int &repeats);
+	// level 0 upload throughput per internal format, mutable glTexImage2D against immutable storage
+	static void textureUpload(const char *imagePath, const int &repeats);
+	// mapped .lmesh straight into buffers, against only reading the same file into memory
+	static void meshLoad(const char *meshPath, const int &repeats);
+	// glTF import split into parsing, preparation on the pool and the GL upload
+	static void gltfImport(const char *gltfPath, const int &repeats);
+};
+
+#endif // BENCH_BENCH_HPP
\ No newline at end of file
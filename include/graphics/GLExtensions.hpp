@@ -0,0 +1,87 @@
+#ifndef GRAPHICS_GLEXTENSIONS_HPP
+#define GRAPHICS_GLEXTENSIONS_HPP
+
+#include <glad/glad.h>
+
+#include <string>
+#include <vector>
+
+// glad is generated for plain 3.3 core, entry points from optional extensions are loaded here
+// and exposed under their usual gl* names, the same way glad does it.
+
+#ifndef GL_ARB_get_program_binary
+#define GL_ARB_get_program_binary 1
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#define GL_PROGRAM_BINARY_FORMATS 0x87FF
+typedef void(APIENTRYP PFNGLGETPROGRAMBINARYPROC)(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
+typedef void(APIENTRYP PFNGLPROGRAMBINARYPROC)(GLuint program, GLenum binaryFormat, const void *binary, GLsizei length);
+typedef void(APIENTRYP PFNGLPROGRAMPARAMETERIPROC)(GLuint program, GLenum pname, GLint value);
+extern PFNGLGETPROGRAMBINARYPROC ext_glGetProgramBinary;
+extern PFNGLPROGRAMBINARYPROC ext_glProgramBinary;
+extern PFNGLPROGRAMPARAMETERIPROC ext_glProgramParameteri;
+#define glGetProgramBinary ext_glGetProgramBinary
+#define glProgramBinary ext_glProgramBinary
+#define glProgramParameteri ext_glProgramParameteri
+#endif
+
+#ifndef GL_KHR_parallel_shader_compile
+#define GL_KHR_parallel_shader_compile 1
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+typedef void(APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+extern PFNGLMAXSHADERCOMPILERTHREADSKHRPROC ext_glMaxShaderCompilerThreadsKHR;
+#define glMaxShaderCompilerThreadsKHR ext_glMaxShaderCompilerThreadsKHR
+#endif
+
+#ifndef GL_EXT_texture_compression_s3tc
+#define GL_EXT_texture_compression_s3tc 1
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+#ifndef GL_ARB_texture_storage
+#define GL_ARB_texture_storage 1
+#define GL_TEXTURE_IMMUTABLE_FORMAT 0x912F
+typedef void(APIENTRYP PFNGLTEXSTORAGE2DPROC)(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height);
+typedef void(APIENTRYP PFNGLTEXSTORAGE3DPROC)(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth);
+extern PFNGLTEXSTORAGE2DPROC ext_glTexStorage2D;
+extern PFNGLTEXSTORAGE3DPROC ext_glTexStorage3D;
+#define glTexStorage2D ext_glTexStorage2D
+#define glTexStorage3D ext_glTexStorage3D
+#endif
+
+#ifndef GL_ARB_internalformat_query2
+#define GL_ARB_internalformat_query2 1
+#define GL_INTERNALFORMAT_PREFERRED 0x8270
+#define GL_TEXTURE_IMAGE_FORMAT 0x828F
+typedef void(APIENTRYP PFNGLGETINTERNALFORMATIVPROC)(GLenum target, GLenum internalformat, GLenum pname, GLsizei bufSize, GLint *params);
+extern PFNGLGETINTERNALFORMATIVPROC ext_glGetInternalformativ;
+#define glGetInternalformativ ext_glGetInternalformativ
+#endif
+
+class GLExtensions
+{
+private:
+	static std::vector<std::string> m_extensions;
+	static int m_major, m_minor;
+
+public:
+	static bool programBinary;
+	// KHR or ARB parallel_shader_compile, both share the GL_COMPLETION_STATUS_KHR token
+	static bool parallelShaderCompile;
+	// BC1/BC3 uploads through glCompressedTexImage2D, core only defines the entry point
+	static bool s3tc;
+	// immutable storage with glTexStorage2D/3D, core since 4.2
+	static bool textureStorage;
+	// glGetInternalformativ with the query2 pnames, core since 4.3
+	static bool internalformatQuery;
+
+	// call once after gladLoadGLLoader, with the same loader
+	static void load(GLADloadproc loader);
+	static bool has(const char *extension);
+	static bool atLeast(const int &major, const int &minor);
+};
+
+#endif // GRAPHICS_GLEXTENSIONS_HPP
\ No newline at end of file
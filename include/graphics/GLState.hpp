@@ -0,0 +1,54 @@
+#ifndef GRAPHICS_GLSTATE_HPP
+#define GRAPHICS_GLSTATE_HPP
+
+#include <glad/glad.h>
+
+#include <vector>
+
+// Shadow copy of the render context's bindings and fixed function state. Calls that would not
+// change anything are skipped and counted. Only for the thread owning the render context, other
+// contexts (e.g. the shader reloader's) keep calling GL directly.
+class GLState
+{
+public:
+	struct Counters
+	{
+		unsigned int issued;
+		unsigned int elided;
+	};
+
+	static const int MAX_TEXTURE_UNITS = 32;
+	static const int MAX_UNIFORM_BINDINGS = 16;
+
+	static void useProgram(const unsigned int &program);
+	static void bindFramebuffer(const unsigned int &framebuffer);
+	static void bindVertexArray(const unsigned int &vao);
+	static void bindBuffer(const GLenum &target, const unsigned int &buffer);
+	static void bindBufferRange(const GLenum &target, const unsigned int &index, const unsigned int &buffer, const GLintptr &offset, const GLsizeiptr &size);
+	// also leaves unit active, so the texture can be edited straight after
+	static void bindTexture(const unsigned int &unit, const GLenum &target, const unsigned int &texture);
+	static void polygonMode(const GLenum &mode);
+	static void setEnabled(const GLenum &capability, const bool &enabled);
+	static void blendFunc(const GLenum &source, const GLenum &destination);
+	static void depthFunc(const GLenum &func);
+	static void clearColor(const float &r, const float &g, const float &b, const float &a);
+	static void viewport(const int &x, const int &y, const int &width, const int &height);
+
+	// deleting a bound object resets its binding, these keep the shadow copy in sync
+	static void deleteProgram(const unsigned int &program);
+	static void deleteVertexArray(const unsigned int &vao);
+	static void deleteBuffer(const unsigned int &buffer);
+	static void deleteTexture(const unsigned int &texture);
+
+	// forget everything, the next call of each kind goes to GL, call once the context is current
+	static void invalidate();
+
+	// closes the frame's counters, lastFrame() reports them until the next endFrame()
+	static void endFrame();
+	static const Counters &lastFrame();
+	static const Counters &currentFrame();
+	// programs bound for the first time ever during the last closed frame
+	static const std::vector<unsigned int> &lastFrameFirstUses();
+};
+
+#endif // GRAPHICS_GLSTATE_HPP
\ No newline at end of file
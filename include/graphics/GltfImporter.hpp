@@ -0,0 +1,60 @@
+#ifndef GRAPHICS_GLTFIMPORTER_HPP
+#define GRAPHICS_GLTFIMPORTER_HPP
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "asset/GltfFile.hpp"
+
+// one glDrawElements call, per glTF primitive
+struct GltfDraw
+{
+	unsigned int vao;
+	GLsizei indexCount;
+	GLenum indexType;
+	// byte offset into the index buffer the VAO references
+	size_t indexOffset;
+	// base colour texture, 0 when the material has none
+	unsigned int texture;
+};
+
+struct GltfScene
+{
+	std::vector<GltfDraw> draws;
+	// one per used buffer view plus one per converted stream, the draws share them
+	std::vector<unsigned int> buffers;
+	std::vector<unsigned int> textures;
+	// of every position accessor, node transforms are not applied
+	MeshBounds bounds;
+};
+
+struct GltfImportStats
+{
+	double openMs;
+	double prepareMs;
+	double uploadMs;
+	// handed to GL straight from the mappings, and converted on the CPU first
+	size_t viewBytes;
+	size_t convertedBytes;
+	size_t textureBytes;
+	size_t triangles;
+	int images;
+	int skipped;
+};
+
+// Imports the meshes and base colour images of a glTF 2.0 file (.gltf or .glb) into VAOs laid out like
+// the rest of the renderer (position 0, colour 1, texcoord 2, normal 4). Every buffer view a primitive
+// draws from becomes one GL buffer filled straight from the memory mapping, primitives only differ in
+// the offsets and strides their VAO records. Parsing, image decoding, mip generation and the few
+// conversions run on the shared ThreadPool (see GltfFile::prepare), only the GL calls stay here.
+class GltfImporter
+{
+public:
+	static bool import(const std::string &path, GltfScene &scene, GltfImportStats *stats = NULL);
+	static void destroy(GltfScene &scene);
+};
+
+#endif // GRAPHICS_GLTFIMPORTER_HPP
\ No newline at end of file
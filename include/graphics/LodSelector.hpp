@@ -0,0 +1,48 @@
+#ifndef GRAPHICS_LODSELECTOR_HPP
+#define GRAPHICS_LODSELECTOR_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "asset/MeshFile.hpp"
+
+// Picks a level of detail for every draw from the number of pixels its simplification error spans
+// on screen, the coarsest level whose error stays under pixelError wins. A draw only moves to a
+// coarser level once that level is comfortably under the threshold, and back to a finer one once
+// its current level is clearly over it, so a mesh resting near a switching distance does not pop
+// between two levels every frame.
+class LodSelector
+{
+public:
+	struct Counters
+	{
+		// of the draws with levels, what the finest levels would have drawn and what was drawn
+		size_t fullTriangles;
+		size_t drawnTriangles;
+		// level changes since create()
+		int switches;
+	};
+
+private:
+	float m_pixelError;
+	float m_hysteresis;
+	std::vector<size_t> m_levels;
+	Counters m_counters;
+
+public:
+	static constexpr float DEFAULT_PIXEL_ERROR = 1.0f;
+	// the band around pixelError, as a fraction of it, in which a draw keeps its level
+	static constexpr float DEFAULT_HYSTERESIS = 0.25f;
+
+	LodSelector();
+
+	void create(const float &pixelError = DEFAULT_PIXEL_ERROR, const float &hysteresis = DEFAULT_HYSTERESIS);
+	// once per frame, chains holds the levels of every draw (empty for draws that have none) and
+	// pixelsPerUnit how many pixels one mesh unit covers on screen
+	void update(const std::vector<std::vector<MeshLod>> &chains, const float &pixelsPerUnit);
+	// index into the draw's chain
+	size_t level(const size_t &draw) const;
+	const Counters &counters() const;
+};
+
+#endif // GRAPHICS_LODSELECTOR_HPP
\ No newline at end of file
@@ -0,0 +1,46 @@
+#ifndef GRAPHICS_MESHLOADER_HPP
+#define GRAPHICS_MESHLOADER_HPP
+
+#include <glad/glad.h>
+
+#include <string>
+#include <vector>
+
+#include "asset/MeshFile.hpp"
+
+// GL objects of a loaded mesh, the VAO records the attribute layout and the index buffer
+struct GpuMesh
+{
+	unsigned int vao;
+	unsigned int vertexBuffer;
+	unsigned int indexBuffer;
+	GLsizei indexCount;
+	GLenum indexType;
+	MeshBounds bounds;
+	// position = attribute * dequantizeScale + dequantizeOffset, for the model transform
+	float dequantizeScale[3];
+	float dequantizeOffset[3];
+	// ranges of the index buffer, empty when indexCount is the only level
+	std::vector<MeshLod> lods;
+};
+
+// Loads .lmesh files. The file is memory mapped and the vertex and index ranges of the mapping go
+// straight to glBufferData, the only copy is the driver's own, so load time is bounded by how fast
+// the pages come off disk. The mapping is released once the driver has its copy.
+class MeshLoader
+{
+private:
+	static void upload(const std::vector<MeshAttribute> &attributes, const uint32_t &stride, const void *vertices, const size_t &vertexBytes,
+					   const void *indices, const size_t &indexCount, const uint32_t &indexSize, GpuMesh &mesh);
+
+public:
+	static GLenum glType(const uint32_t &type);
+	static bool load(const std::string &path, GpuMesh &mesh);
+	// uploads an already parsed view, e.g. one that stays mapped for other uses
+	static void upload(const MeshFileView &view, GpuMesh &mesh);
+	// a mesh built at runtime, indices are narrowed to 16 bits when the vertex count allows it
+	static void upload(const MeshData &data, GpuMesh &mesh);
+	static void destroy(GpuMesh &mesh);
+};
+
+#endif // GRAPHICS_MESHLOADER_HPP
\ No newline at end of file
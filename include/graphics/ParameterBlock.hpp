@@ -0,0 +1,63 @@
+#ifndef GRAPHICS_PARAMETERBLOCK_HPP
+#define GRAPHICS_PARAMETERBLOCK_HPP
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "util/Hash.hpp"
+
+// CPU side copy of a program's plain uniforms, addressed by name hashes ("name"_hash). Setters only
+// record the value and mark it dirty if it changed, flush() then issues one glUniform* per dirty
+// uniform. Arrays are reachable through their first element only.
+class ParameterBlock
+{
+private:
+	struct Param
+	{
+		uint32_t hash;
+		int location;
+		GLenum type;
+		int components;
+		bool isInt;
+		bool dirty;
+		union
+		{
+			float f[16];
+			int i[16];
+		} value;
+	};
+	std::vector<Param> m_params;
+	std::vector<unsigned int> m_dirty;
+
+	Param *find(const uint32_t &name);
+	void write(const uint32_t &name, const float *values, const int &components);
+	void write(const uint32_t &name, const int *values, const int &components);
+	void upload(const Param &param) const;
+
+public:
+	// called by Shader once the program is linked
+	void add(const std::string &name, const int &location, const GLenum &type);
+	void sort();
+
+	bool has(const uint32_t &name) const;
+
+	void setBool(const uint32_t &name, bool value);
+	void setInt(const uint32_t &name, int value);
+	void setFloat(const uint32_t &name, float value);
+	void setVec2(const uint32_t &name, float x, float y);
+	void setVec3(const uint32_t &name, float x, float y, float z);
+	void setVec4(const uint32_t &name, float x, float y, float z, float w);
+	// column major, like glUniformMatrix* with transpose GL_FALSE
+	void setMat3(const uint32_t &name, const float *value);
+	void setMat4(const uint32_t &name, const float *value);
+
+	// uploads changed values, the owning program has to be in use
+	void flush();
+	// takes over the values of another block, e.g. the program this one replaces after a reload
+	void adopt(const ParameterBlock &other);
+};
+
+#endif // GRAPHICS_PARAMETERBLOCK_HPP
\ No newline at end of file
@@ -0,0 +1,40 @@
+#ifndef GRAPHICS_PIPELINEWARMUP_HPP
+#define GRAPHICS_PIPELINEWARMUP_HPP
+
+#include <glad/glad.h>
+
+#include <vector>
+
+#include "graphics/Shader.hpp"
+
+// Drivers often finish compiling a program only when it is first drawn with a given vertex layout.
+// run() draws one triangle with every program/VAO pair into a 1x1 offscreen target and waits for
+// it, so that cost is paid during loading instead of in the first frames of the render loop.
+class PipelineWarmup
+{
+public:
+	// returns the time spent in milliseconds, indexed VAOs are drawn with their entry of indexTypes
+	// (GL_UNSIGNED_INT for any without one)
+	static double run(const std::vector<Shader *> &shaders, const std::vector<unsigned int> &vaos, const std::vector<GLenum> &indexTypes = {});
+};
+
+// Flags frames that blow the frame budget while binding a program for the first time, those are
+// the first-use stalls warm-up is meant to remove.
+class HitchDetector
+{
+private:
+	double m_budgetMs;
+	double m_frameStart;
+	unsigned long long m_frame;
+	unsigned int m_hitches;
+
+public:
+	explicit HitchDetector(const double &budgetMs);
+
+	void beginFrame(const double &now);
+	// call after GLState::endFrame()
+	void endFrame(const double &now);
+	unsigned int hitches() const;
+};
+
+#endif // GRAPHICS_PIPELINEWARMUP_HPP
\ No newline at end of file
@@ -0,0 +1,43 @@
+#ifndef GRAPHICS_PIXELUPLOADRING_HPP
+#define GRAPHICS_PIXELUPLOADRING_HPP
+
+#include <glad/glad.h>
+
+#include <vector>
+
+// A ring of pixel unpack buffers for texture uploads that do not stall the render thread. The
+// pixels are copied into the next slot, the glTexImage calls source offsets in it and the driver
+// copies from there asynchronously. A fence guards each slot, and a slot the GPU still reads is
+// skipped until a later frame instead of being waited on.
+class PixelUploadRing
+{
+private:
+	struct Slot
+	{
+		unsigned int buffer;
+		GLsizeiptr capacity;
+		GLsync fence;
+	};
+
+	std::vector<Slot> m_slots;
+	int m_next;
+
+public:
+	static const int DEFAULT_SLOTS = 4;
+
+	PixelUploadRing();
+
+	void create(const int &slots = DEFAULT_SLOTS);
+	void destroy();
+
+	// whether the next slot is free, never waits
+	bool ready();
+	// binds the next slot to GL_PIXEL_UNPACK_BUFFER and maps size bytes of it, NULL if that failed
+	unsigned char *map(const GLsizeiptr &size);
+	// the texture calls reading from the slot go between unmap() and submit()
+	void unmap();
+	// fences the slot's copies, unbinds it and moves on to the next one
+	void submit();
+};
+
+#endif // GRAPHICS_PIXELUPLOADRING_HPP
\ No newline at end of file
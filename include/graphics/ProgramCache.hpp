@@ -0,0 +1,36 @@
+#ifndef GRAPHICS_PROGRAMCACHE_HPP
+#define GRAPHICS_PROGRAMCACHE_HPP
+
+#include <glad/glad.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+
+#include "graphics/GLExtensions.hpp"
+
+// On-disk cache of linked program binaries. Entries are keyed by a hash of the shader sources and
+// the GL_RENDERER/GL_VERSION strings, so a driver or GPU change simply misses instead of failing.
+class ProgramCache
+{
+private:
+	static std::string m_directory;
+
+	static std::string pathFor(const std::string &vertexCode, const std::string &fragmentCode);
+
+public:
+	// counted on the render thread and on the shader reloader's worker
+	static std::atomic<int> hits;
+	static std::atomic<int> misses;
+
+	static void setDirectory(const std::string &directory);
+
+	// tries to load a cached binary into program, returns false if there is none or the driver rejected it
+	static bool load(const unsigned int &program, const std::string &vertexCode, const std::string &fragmentCode);
+	// stores the binary of a successfully linked program
+	static void store(const unsigned int &program, const std::string &vertexCode, const std::string &fragmentCode);
+};
+
+#endif // GRAPHICS_PROGRAMCACHE_HPP
\ No newline at end of file
@@ -4,25 +4,61 @@
 #include <glad/glad.h> // include glad to get all the required OpenGL headers
 
 #include <string>
+#include <vector>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 
+#include "graphics/ParameterBlock.hpp"
+
 class Shader
 {
+	friend class ShaderBatch;
+
 private:
-	void compileShader(const unsigned int &shader, const char *source, const char *name);
-	void linkShaders(const unsigned int &program, unsigned int &vertex, unsigned int &fragment);
+	// one entry per active uniform, sorted by name so lookups are a binary search instead of a driver call
+	struct Uniform
+	{
+		std::string name;
+		int location;
+	};
+	std::vector<Uniform> m_uniforms;
+	bool m_linked;
+
+	// submitting and checking are split so a batch can queue every compile before waiting on any of them
+	static void compileShader(const unsigned int &shader, const char *source);
+	static bool checkShader(const unsigned int &shader, const char *name);
+	static void linkShaders(const unsigned int &program, const unsigned int &vertex, const unsigned int &fragment);
+	static bool checkProgram(const unsigned int &program);
+	void cacheUniforms();
+	void bindUniformBlocks();
 
 public:
 	unsigned int programId;
+	// deferred, dirty tracked uniform values, flush() after use() and before drawing
+	ParameterBlock params;
 
+	// paths go through ShaderSource, so bare names of embedded shaders ("triangle.vs") work too
 	Shader(const char *vertexPath, const char *fragmentPath);
+	// adopts an already linked program
+	explicit Shader(const unsigned int &program);
+
+	static bool readFile(const char *path, std::string &out);
+
 	void use();
+	bool isLinked() const;
+
+	// returns the cached location of an active uniform, or -1 (ignored by glUniform*) if there is none
+	int getUniformLocation(const std::string &name) const;
 
 	void setBool(const std::string &name, bool value) const;
 	void setInt(const std::string &name, int value) const;
 	void setFloat(const std::string &name, float value) const;
+
+	// handle based setters for hot loops, takes a location from getUniformLocation
+	void setBool(int location, bool value) const;
+	void setInt(int location, int value) const;
+	void setFloat(int location, float value) const;
 };
 
 #endif // GRAHICS_SHADER_HPP
\ No newline at end of file
@@ -0,0 +1,39 @@
+#ifndef GRAPHICS_SHADERBATCH_HPP
+#define GRAPHICS_SHADERBATCH_HPP
+
+#include <glad/glad.h>
+
+#include <string>
+#include <vector>
+
+#include "graphics/Shader.hpp"
+
+// Builds many programs at once: sources are read on worker threads, every compile and link is
+// submitted before any status is queried, so the driver can overlap them (in parallel when
+// KHR/ARB_parallel_shader_compile is available) instead of serializing on each program.
+class ShaderBatch
+{
+private:
+	struct Entry
+	{
+		std::string vertexPath;
+		std::string fragmentPath;
+		std::vector<std::string> defines;
+		std::vector<std::string> dependencies;
+		std::string vertexCode;
+		std::string fragmentCode;
+		unsigned int vertex = 0;
+		unsigned int fragment = 0;
+		unsigned int program = 0;
+		bool cached = false;
+	};
+	std::vector<Entry> m_entries;
+
+public:
+	// queues a program, returns its index in the result of build()
+	int add(const std::string &vertexPath, const std::string &fragmentPath, const std::vector<std::string> &defines = {});
+	// dependencies, if given, receives every file each program was built from (includes too)
+	std::vector<Shader> build(std::vector<std::vector<std::string>> *dependencies = NULL);
+};
+
+#endif // GRAPHICS_SHADERBATCH_HPP
\ No newline at end of file
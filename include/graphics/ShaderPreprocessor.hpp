@@ -0,0 +1,20 @@
+#ifndef GRAPHICS_SHADERPREPROCESSOR_HPP
+#define GRAPHICS_SHADERPREPROCESSOR_HPP
+
+#include <string>
+#include <vector>
+
+// Resolves #include "file" (relative to the including file, each file included once) and injects
+// feature #defines right after #version. #line directives keep driver error messages pointing at
+// the original file and line, the source string number is the index into dependencies.
+class ShaderPreprocessor
+{
+private:
+	static bool expand(const std::string &path, const std::vector<std::string> &defines, std::string &out, std::vector<std::string> &dependencies, const bool &topLevel);
+	static std::string directoryOf(const std::string &path);
+
+public:
+	static bool process(const std::string &path, const std::vector<std::string> &defines, std::string &out, std::vector<std::string> &dependencies);
+};
+
+#endif // GRAPHICS_SHADERPREPROCESSOR_HPP
\ No newline at end of file
@@ -0,0 +1,57 @@
+#ifndef GRAPHICS_SHADERRELOADER_HPP
+#define GRAPHICS_SHADERRELOADER_HPP
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "graphics/Shader.hpp"
+#include "graphics/ShaderVariants.hpp"
+#include "util/FileWatcher.hpp"
+
+// Rebuilds shader permutations whose sources (or includes) changed on disk. Reading, compiling and
+// linking happen on a worker thread with its own hidden context shared with the render window,
+// the render thread only swaps finished programs in through apply().
+class ShaderReloader
+{
+private:
+	struct Reloaded
+	{
+		ShaderVariants *variants;
+		unsigned int mask;
+		Shader shader;
+		std::vector<std::string> dependencies;
+	};
+
+	GLFWwindow *m_context;
+	FileWatcher m_watcher;
+	std::vector<ShaderVariants *> m_watched;
+	std::vector<Reloaded> m_results;
+	std::mutex m_mutex;
+	std::atomic<bool> m_pending;
+	std::thread m_thread;
+
+	void run();
+
+public:
+	// must be created on the thread that owns window
+	ShaderReloader(GLFWwindow *window, const std::string &directory);
+	~ShaderReloader();
+
+	ShaderReloader(const ShaderReloader &) = delete;
+	ShaderReloader &operator=(const ShaderReloader &) = delete;
+
+	// register everything to watch before start()
+	void watch(ShaderVariants *variants);
+	void start();
+
+	// swaps in programs that rebuilt successfully, costs one atomic load when nothing changed
+	bool apply();
+};
+
+#endif // GRAPHICS_SHADERRELOADER_HPP
\ No newline at end of file
@@ -0,0 +1,20 @@
+#ifndef GRAPHICS_SHADERSOURCE_HPP
+#define GRAPHICS_SHADERSOURCE_HPP
+
+#include <string>
+
+// Resolves shader sources either from the copies baked into the executable at build time
+// (tools/embed_shaders.cpp) or from disk. Embedded sources are looked up by file name, so a path
+// like "./res/shaders/triangle.vs" and the bare name "triangle.vs" find the same source.
+class ShaderSource
+{
+public:
+	// development switch: read from disk first (e.g. for hot reload), embedded copies are the fallback
+	static bool preferDisk;
+
+	static bool load(const std::string &path, std::string &out);
+	static bool loadEmbedded(const std::string &path, std::string &out);
+	static int embeddedCount();
+};
+
+#endif // GRAPHICS_SHADERSOURCE_HPP
@@ -0,0 +1,46 @@
+#ifndef GRAPHICS_SHADERVARIANTS_HPP
+#define GRAPHICS_SHADERVARIANTS_HPP
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "graphics/Shader.hpp"
+
+// Permutations of one vertex/fragment source pair. Bit i of a feature mask enables the i-th
+// feature #define, each permutation is compiled the first time it is requested.
+class ShaderVariants
+{
+private:
+	std::string m_vertexPath;
+	std::string m_fragmentPath;
+	std::vector<std::string> m_features;
+	std::map<unsigned int, Shader> m_variants;
+	std::vector<std::string> m_dependencies;
+	mutable std::mutex m_mutex;
+
+	void addDependencies(const std::vector<std::string> &files);
+
+public:
+	ShaderVariants(const std::string &vertexPath, const std::string &fragmentPath, const std::vector<std::string> &features);
+
+	const std::string &vertexPath() const;
+	const std::string &fragmentPath() const;
+	std::vector<std::string> definesFor(const unsigned int &mask) const;
+
+	// returns the permutation, compiling it first if needed
+	Shader &get(const unsigned int &mask);
+	// compiles every missing permutation in one batch
+	void prepare(const std::vector<unsigned int> &masks);
+
+	// snapshots, safe to call from another thread
+	std::vector<unsigned int> compiled() const;
+	bool dependsOn(const std::string &fileName) const;
+
+	// swaps in a rebuilt permutation and deletes the program it replaces
+	void replace(const unsigned int &mask, const Shader &shader, const std::vector<std::string> &dependencies);
+	void clear();
+};
+
+#endif // GRAPHICS_SHADERVARIANTS_HPP
\ No newline at end of file
@@ -0,0 +1,74 @@
+#ifndef GRAPHICS_STD140_HPP
+#define GRAPHICS_STD140_HPP
+
+#include <cstddef>
+#include <type_traits>
+
+// Member types for C++ mirrors of std140 uniform blocks. alignas reproduces the std140 base
+// alignment of each type, so a struct built from them gets the same member offsets as GLSL.
+// There is deliberately no vec3: std140 lets a scalar follow a vec3 in its last 4 bytes, which a
+// 16 byte aligned C++ type cannot express, use Vec4 instead.
+namespace std140
+{
+	struct alignas(4) Float
+	{
+		float value;
+		Float &operator=(const float &v)
+		{
+			value = v;
+			return *this;
+		}
+	};
+
+	struct alignas(4) Int
+	{
+		int value;
+		Int &operator=(const int &v)
+		{
+			value = v;
+			return *this;
+		}
+	};
+
+	struct alignas(8) Vec2
+	{
+		float x, y;
+	};
+
+	struct alignas(16) Vec4
+	{
+		float x, y, z, w;
+	};
+
+	// column major, each column padded to a vec4
+	struct alignas(16) Mat3
+	{
+		Vec4 columns[3];
+	};
+
+	// column major
+	struct alignas(16) Mat4
+	{
+		float m[16];
+	};
+
+	// array elements are padded to a multiple of 16 bytes
+	template <typename T>
+	struct alignas(16) Element
+	{
+		T value;
+	};
+
+	// a block struct has to be usable with memcpy and end on a 16 byte boundary
+	template <typename T>
+	constexpr bool isBlock()
+	{
+		return std::is_standard_layout<T>::value && std::is_trivially_copyable<T>::value && alignof(T) == 16 && sizeof(T) % 16 == 0;
+	}
+}
+
+// checks a member against the offset the GLSL block gives it
+#define STD140_OFFSET(Block, member, offset) \
+	static_assert(offsetof(Block, member) == (offset), #Block "::" #member " does not match its std140 offset")
+
+#endif // GRAPHICS_STD140_HPP
\ No newline at end of file
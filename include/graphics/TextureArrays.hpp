@@ -0,0 +1,52 @@
+#ifndef GRAPHICS_TEXTUREARRAYS_HPP
+#define GRAPHICS_TEXTUREARRAYS_HPP
+
+#include <glad/glad.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "asset/TextureFile.hpp"
+
+struct TextureLayer
+{
+	unsigned int texture;
+	int layer;
+};
+
+// Groups images of the same size and channel count into GL_TEXTURE_2D_ARRAY objects. Objects
+// drawn from one array only differ in the layer index they pass to the shader, so switching
+// between them needs no bind, and unlike an atlas every layer keeps its own repeat wrapping.
+class TextureArrays
+{
+private:
+	struct Image
+	{
+		std::string path;
+		int width;
+		int height;
+		int channels;
+		std::vector<TextureLevel> levels;
+	};
+
+	std::vector<std::string> m_paths;
+	std::vector<unsigned int> m_arrays;
+	std::map<std::string, TextureLayer> m_layers;
+
+	static void decode(Image &image);
+	unsigned int upload(const std::vector<const Image *> &group, const GLenum &wrap);
+
+public:
+	// queues an image, nothing is read until build()
+	void add(const std::string &path);
+	// decodes and mipmaps every queued image on the shared ThreadPool, then creates one array per group
+	void build(const GLenum &wrap = GL_REPEAT);
+	void destroy();
+
+	bool find(const std::string &path, TextureLayer &layer) const;
+	int arrayCount() const;
+	int layerCount() const;
+};
+
+#endif // GRAPHICS_TEXTUREARRAYS_HPP
\ No newline at end of file
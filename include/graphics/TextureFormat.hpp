@@ -0,0 +1,50 @@
+#ifndef GRAPHICS_TEXTUREFORMAT_HPP
+#define GRAPHICS_TEXTUREFORMAT_HPP
+
+#include <glad/glad.h>
+
+#include <cstddef>
+
+#include "asset/TextureFile.hpp"
+
+// sized internal format and the client format uploads are given in, always GL_UNSIGNED_BYTE
+struct PixelFormat
+{
+	GLenum internalFormat;
+	GLenum format;
+	int channels;
+};
+
+// Picks how decoded images are stored. Every channel count gets a sized internal format so the
+// driver never has to guess, rows are uploaded with the largest unpack alignment they satisfy, and
+// RGB is padded to RGBA on the CPU when the driver stores RGB8 as RGBA8 anyway (it would otherwise
+// do the same conversion itself, on the render thread). Grey and grey-alpha stay R8/RG8 and are
+// swizzled back to grey.
+class TextureFormat
+{
+private:
+	static bool m_padRgb;
+
+public:
+	// call once after GLExtensions::load
+	static void detect();
+	static bool padRgb();
+
+	// srgb picks GL_SRGB8(_ALPHA8) for 3 and 4 channels, the others have no sRGB variant in core
+	static PixelFormat forChannels(const int &channels, const bool &srgb = false);
+	// channel count to hand to the GL for an image decoded with this many
+	static int uploadChannels(const int &channels);
+	// largest of 8, 4, 2 and 1 that divides a row of the given width
+	static int unpackAlignment(const int &width, const int &bytesPerPixel);
+	static void setSwizzle(const GLenum &target, const int &channels);
+
+	// appends an opaque alpha to every pixel
+	static void padToRgba(const unsigned char *rgb, unsigned char *rgba, const size_t &pixels);
+	static void padToRgba(TextureLevel &level);
+
+	// immutable storage for every level when available, otherwise each level specified empty
+	static void allocate2D(const GLenum &target, const int &levels, const PixelFormat &format, const int &width, const int &height);
+	static void allocate3D(const GLenum &target, const int &levels, const PixelFormat &format, const int &width, const int &height, const int &depth);
+};
+
+#endif // GRAPHICS_TEXTUREFORMAT_HPP
\ No newline at end of file
@@ -0,0 +1,74 @@
+#ifndef GRAPHICS_TEXTURELOADER_HPP
+#define GRAPHICS_TEXTURELOADER_HPP
+
+#include <glad/glad.h>
+
+#include <atomic>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "asset/TextureFile.hpp"
+#include "graphics/PixelUploadRing.hpp"
+#include "graphics/TextureResidency.hpp"
+#include "util/MappedFile.hpp"
+
+// Streams textures in without blocking the render thread. load() returns a texture name at once,
+// backed by a 1x1 placeholder. Images are decoded and mipmapped on the shared ThreadPool and update()
+// copies finished chains into a ring of pixel unpack buffers, re-specifying the same texture object from
+// there, so callers never have to swap handles. If an up to date baked .ltex exists next to the
+// image it is memory mapped instead and every mip level is uploaded straight from the mapping.
+class TextureLoader
+{
+private:
+	struct Decoded
+	{
+		unsigned int texture;
+		std::string path;
+		int width;
+		int height;
+		// of the levels, after any RGB padding
+		int channels;
+		// full mip chain built on the decoding thread
+		std::vector<TextureLevel> levels;
+		// set instead of levels when a baked file was found
+		std::shared_ptr<MappedFile> baked;
+		TextureFileView view;
+	};
+
+	PixelUploadRing m_ring;
+	size_t m_bytesPerFrame;
+	TextureResidency *m_residency;
+
+	std::mutex m_mutex;
+	std::deque<Decoded> m_decoded;
+	std::vector<std::future<void>> m_tasks;
+	std::atomic<int> m_pending;
+	int m_uploaded;
+
+	void upload(const Decoded &decoded);
+	void uploadBaked(const Decoded &decoded);
+	static bool openBaked(const std::string &path, Decoded &decoded);
+
+public:
+	static const size_t DEFAULT_BYTES_PER_FRAME = 16 * 1024 * 1024;
+
+	TextureLoader();
+
+	void create(const size_t &bytesPerFrame = DEFAULT_BYTES_PER_FRAME);
+	void destroy();
+	// finished images are handed to the residency manager instead of being uploaded in full
+	void setResidency(TextureResidency *residency);
+
+	unsigned int load(const std::string &path, const GLenum &wrap = GL_REPEAT);
+	// uploads decoded images within the per frame byte budget, call once per frame
+	void update();
+
+	int pending() const;
+	int uploaded() const;
+};
+
+#endif // GRAPHICS_TEXTURELOADER_HPP
\ No newline at end of file
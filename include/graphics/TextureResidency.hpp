@@ -0,0 +1,113 @@
+#ifndef GRAPHICS_TEXTURERESIDENCY_HPP
+#define GRAPHICS_TEXTURERESIDENCY_HPP
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "asset/TextureFile.hpp"
+#include "graphics/PixelUploadRing.hpp"
+#include "util/MappedFile.hpp"
+
+// CPU side copy of a texture's mip chain, either decoded levels or a mapped baked file
+struct ResidencySource
+{
+	uint32_t format;
+	std::vector<TextureLevel> levels;
+	std::shared_ptr<MappedFile> baked;
+	TextureFileView view;
+};
+
+// Keeps the textures it tracks within a VRAM budget. Every texture starts with only its small
+// tail levels resident, callers report use with touch() and the screen size it is drawn at, and
+// update() streams in the finer levels that size asks for, largest gap first, within a per frame
+// byte budget. Streamed levels are copied through a PixelUploadRing so the driver uploads them
+// asynchronously, a frame whose slot is still busy streams nothing. When over budget the top
+// levels of the least recently used textures are released again (zero sized re-specification),
+// down to the tail. GL_TEXTURE_BASE_LEVEL always points at the finest resident level, so a
+// texture is complete at any residency.
+class TextureResidency
+{
+public:
+	struct Counters
+	{
+		size_t residentBytes;
+		size_t budgetBytes;
+		// textures that were reduced all the way to their tail
+		int evictions;
+		int droppedLevels;
+		int streamedLevels;
+		// time from a level being requested to it being resident
+		double lastStreamInMs;
+		double maxStreamInMs;
+		double averageStreamInMs;
+	};
+
+private:
+	struct Entry
+	{
+		uint32_t format;
+		std::vector<const unsigned char *> data;
+		std::vector<TextureFileMip> mips;
+		// finest resident level and finest level asked for, mips.size() would mean nothing
+		int top;
+		int requested;
+		// coarsest level that never leaves
+		int tail;
+		long long lastUsed;
+		bool waiting;
+		// has levels planned for this frame's upload, so it is never evicted meanwhile
+		bool streaming;
+		std::chrono::steady_clock::time_point requestedAt;
+		ResidencySource source;
+	};
+
+	// a planned level, uploaded from offset in this frame's slot
+	struct Upload
+	{
+		unsigned int texture;
+		Entry *entry;
+		int level;
+		size_t offset;
+	};
+
+	std::unordered_map<unsigned int, Entry> m_entries;
+	PixelUploadRing m_ring;
+	size_t m_bytesPerFrame;
+	long long m_frame;
+	int m_streamInSamples;
+	double m_streamInTotalMs;
+	Counters m_counters;
+
+	// pixels is client memory, or an offset when a pixel unpack buffer is bound
+	void uploadLevel(const unsigned int &texture, const Entry &entry, const int &level, const void *pixels);
+	void releaseLevel(const unsigned int &texture, Entry &entry);
+	bool makeRoom(const size_t &bytes);
+
+public:
+	// levels at or below this size stay resident for as long as a texture is tracked
+	static const uint32_t TAIL_SIZE = 64;
+	static const size_t DEFAULT_BUDGET = 256 * 1024 * 1024;
+	static const size_t DEFAULT_BYTES_PER_FRAME = 8 * 1024 * 1024;
+
+	TextureResidency();
+
+	void create(const size_t &budgetBytes = DEFAULT_BUDGET, const size_t &bytesPerFrame = DEFAULT_BYTES_PER_FRAME);
+	void destroy();
+
+	// takes over the texture's storage, only the tail is uploaded here
+	void track(const unsigned int &texture, ResidencySource source);
+	void untrack(const unsigned int &texture);
+	// marks the texture used this frame, drawn covering about screenWidth x screenHeight pixels
+	void touch(const unsigned int &texture, const int &screenWidth, const int &screenHeight);
+	// streams and evicts, call once per frame
+	void update();
+
+	static int mipForScreenSize(const uint32_t &width, const uint32_t &height, const int &screenWidth, const int &screenHeight);
+	const Counters &counters() const;
+};
+
+#endif // GRAPHICS_TEXTURERESIDENCY_HPP
\ No newline at end of file
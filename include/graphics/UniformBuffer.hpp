@@ -0,0 +1,76 @@
+#ifndef GRAPHICS_UNIFORMBUFFER_HPP
+#define GRAPHICS_UNIFORMBUFFER_HPP
+
+#include <glad/glad.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "graphics/Std140.hpp"
+
+// fixed binding points, every linked Shader binds blocks of these names to them
+enum UNIFORM_BINDINGS
+{
+	UBO_FRAME = 0
+};
+
+// A ring of equally sized slots in one uniform buffer. Each upload writes the next slot (waiting
+// on a fence only if the GPU still reads it) and binds that slot with glBindBufferRange, so all
+// programs read per-frame data from one binding instead of dozens of glUniform* calls.
+class UniformBuffer
+{
+private:
+	static std::map<std::string, unsigned int> m_bindings;
+
+	unsigned int m_buffer;
+	unsigned int m_binding;
+	int m_size;
+	int m_stride;
+	int m_slot;
+	std::vector<GLsync> m_fences;
+
+public:
+	static const int DEFAULT_SLOTS = 3;
+
+	// block name -> binding point lookup used by Shader after linking
+	static void registerBlock(const std::string &name, const unsigned int &binding);
+	static bool bindingFor(const std::string &name, unsigned int &binding);
+
+	UniformBuffer();
+
+	void create(const unsigned int &binding, const int &size, const int &slots = DEFAULT_SLOTS);
+	void upload(const void *data);
+	void destroy();
+};
+
+// typed front end, the layout of T is checked at compile time
+template <typename T>
+class UniformBlock
+{
+	static_assert(std140::isBlock<T>(), "uniform block structs must be trivially copyable, 16 byte aligned and a multiple of 16 bytes");
+
+private:
+	UniformBuffer m_buffer;
+
+public:
+	T data;
+
+	void create(const std::string &name, const unsigned int &binding)
+	{
+		UniformBuffer::registerBlock(name, binding);
+		m_buffer.create(binding, sizeof(T));
+	}
+
+	void upload()
+	{
+		m_buffer.upload(&data);
+	}
+
+	void destroy()
+	{
+		m_buffer.destroy();
+	}
+};
+
+#endif // GRAPHICS_UNIFORMBUFFER_HPP
\ No newline at end of file
@@ -0,0 +1,156 @@
+#ifndef GRAPHICS_VIRTUALTEXTURE_HPP
+#define GRAPHICS_VIRTUALTEXTURE_HPP
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "asset/VirtualTextureFile.hpp"
+#include "graphics/ParameterBlock.hpp"
+#include "util/MappedFile.hpp"
+
+struct VirtualTextureOptions
+{
+	// the physical cache holds cachePages x cachePages tiles
+	int cachePages = 16;
+	// the feedback pass renders at 1/feedbackScale of the framebuffer in each direction
+	int feedbackScale = 8;
+	// tiles copied into the cache per update()
+	int uploadsPerFrame = 8;
+	// tile reads queued on the ThreadPool at any time
+	int maxReadsInFlight = 32;
+};
+
+// Sparse virtual texturing on plain GL 3.3 core, for images far larger than VRAM. The image lives in a
+// tiled .vtex page file that is memory mapped; only the pages the frame actually needs are copied into a
+// fixed size physical cache texture, least recently used pages make room for new ones.
+//
+// Each frame the scene is first drawn into a small RGBA16UI target with the VT_FEEDBACK shader variant,
+// which writes the page and level every pixel would sample. That target is read back through a ring of
+// pixel pack buffers and consumed a frame later, so the read never stalls. Missing pages are read on the
+// shared ThreadPool (that is when the mapping faults them in from disk) and uploaded within a per frame
+// budget.
+//
+// The page table is an RGBA8UI texture with one mip level per virtual level and one texel per page:
+// cache slot x/y and the level whose data the slot holds. A page that is not resident points at its
+// nearest resident ancestor, the single page of the coarsest level never leaves the cache, so every
+// lookup finds something. Lookups are done in res/shaders/virtual_texture.glsl.
+class VirtualTexture
+{
+public:
+	struct Counters
+	{
+		int residentPages;
+		int cacheCapacity;
+		// distinct pages seen in the last feedback read
+		int visiblePages;
+		int pendingReads;
+		long long uploads;
+		long long evictions;
+		// finished reads dropped because every slot was in use by visible pages
+		long long dropped;
+	};
+
+private:
+	struct Slot
+	{
+		// page key, or NO_PAGE for a free slot
+		uint64_t page;
+		long long lastUsed;
+	};
+
+	struct Tile
+	{
+		uint64_t page;
+		std::vector<unsigned char> pixels;
+	};
+
+	struct Readback
+	{
+		unsigned int buffer;
+		GLsync fence;
+		int width;
+		int height;
+	};
+
+	struct DirtyRect
+	{
+		int x0, y0, x1, y1;
+	};
+
+	std::shared_ptr<MappedFile> m_file;
+	VirtualTextureView m_view;
+	VirtualTextureOptions m_options;
+
+	unsigned int m_cache;
+	unsigned int m_pageTable;
+	std::vector<Slot> m_slots;
+	std::unordered_map<uint64_t, int> m_resident;
+	// CPU copy of every page table level, 4 bytes per texel
+	std::vector<std::vector<unsigned char>> m_table;
+	std::vector<int> m_tableWidth;
+	std::vector<int> m_tableHeight;
+	std::vector<DirtyRect> m_dirty;
+
+	std::unordered_set<uint64_t> m_pending;
+	std::vector<std::future<void>> m_reads;
+	std::mutex m_mutex;
+	std::deque<Tile> m_loaded;
+
+	unsigned int m_feedbackFramebuffer;
+	unsigned int m_feedbackColor;
+	int m_feedbackWidth;
+	int m_feedbackHeight;
+	int m_viewportWidth;
+	int m_viewportHeight;
+	std::vector<Readback> m_readbacks;
+	int m_nextReadback;
+
+	long long m_frame;
+	Counters m_counters;
+
+	static uint64_t pageKey(const uint32_t &level, const uint32_t &x, const uint32_t &y);
+	static void pageOf(const uint64_t &key, uint32_t &level, uint32_t &x, uint32_t &y);
+
+	void readFeedback(std::vector<uint64_t> &requests);
+	void requestReads(std::vector<uint64_t> &requests);
+	bool upload(const Tile &tile);
+	void evict(const int &slot);
+	// re-points the page and everything below it at their nearest resident ancestor
+	void refreshTable(const uint32_t &level, const uint32_t &x, const uint32_t &y);
+	void uploadTable();
+	void resizeFeedback(const int &width, const int &height);
+
+public:
+	static const uint64_t NO_PAGE = ~0ull;
+	static const int READBACK_COUNT = 3;
+
+	VirtualTexture();
+
+	bool open(const std::string &path, const VirtualTextureOptions &options = VirtualTextureOptions());
+	void destroy();
+	bool isOpen() const;
+
+	// binds the feedback target sized for this framebuffer, draw the scene with the feedback variant next
+	void beginFeedback(const int &framebufferWidth, const int &framebufferHeight);
+	// queues the asynchronous read of the feedback and rebinds the default framebuffer
+	void endFeedback();
+	// consumes the oldest finished feedback, queues tile reads and uploads finished ones, once per frame
+	void update();
+
+	// values for the vtInfo/vtCacheInfo uniforms, the feedback variant needs its mip bias
+	void setUniforms(ParameterBlock &params, const bool &feedback) const;
+	unsigned int cacheTexture() const;
+	unsigned int pageTableTexture() const;
+	const Counters &counters() const;
+};
+
+#endif // GRAPHICS_VIRTUALTEXTURE_HPP
\ No newline at end of file
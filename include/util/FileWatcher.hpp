@@ -0,0 +1,33 @@
+#ifndef UTIL_FILEWATCHER_HPP
+#define UTIL_FILEWATCHER_HPP
+
+#include <string>
+#include <vector>
+
+// Watches one directory for written or replaced files. Backed by inotify on Linux; on other
+// platforms the watcher reports itself inactive and wait() returns immediately.
+class FileWatcher
+{
+private:
+	int m_inotify;
+	int m_watch;
+	int m_wakePipe[2];
+
+	void drain(std::vector<std::string> &changed);
+
+public:
+	explicit FileWatcher(const std::string &directory);
+	~FileWatcher();
+
+	FileWatcher(const FileWatcher &) = delete;
+	FileWatcher &operator=(const FileWatcher &) = delete;
+
+	bool isActive() const;
+
+	// blocks until files changed (names relative to the directory) or stop() was called,
+	// bursts of events from a single save are coalesced into one result
+	bool wait(std::vector<std::string> &changed);
+	void stop();
+};
+
+#endif // UTIL_FILEWATCHER_HPP
\ No newline at end of file
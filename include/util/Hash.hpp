@@ -0,0 +1,39 @@
+#ifndef UTIL_HASH_HPP
+#define UTIL_HASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+class Hash
+{
+public:
+	// 32 bit FNV-1a, constexpr so names can be hashed at compile time
+	static constexpr uint32_t fnv1a(const char *data, const size_t &length)
+	{
+		uint32_t hash = 0x811c9dc5u;
+		for (size_t i = 0; i < length; i++)
+		{
+			hash ^= (unsigned char)data[i];
+			hash *= 0x01000193u;
+		}
+		return hash;
+	}
+
+	static constexpr uint32_t fnv1a(const char *data)
+	{
+		size_t length = 0;
+		while (data[length] != '\0')
+		{
+			length++;
+		}
+		return fnv1a(data, length);
+	}
+};
+
+// "ourTexture"_hash is folded to a constant by the compiler
+constexpr uint32_t operator""_hash(const char *data, size_t length)
+{
+	return Hash::fnv1a(data, length);
+}
+
+#endif // UTIL_HASH_HPP
\ No newline at end of file
@@ -0,0 +1,60 @@
+#ifndef UTIL_JSON_HPP
+#define UTIL_JSON_HPP
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+enum JSON_TYPES
+{
+	JSON_NULL = 0,
+	JSON_BOOL,
+	JSON_NUMBER,
+	JSON_STRING,
+	JSON_ARRAY,
+	JSON_OBJECT
+};
+
+// Small DOM for the JSON in asset files (glTF). Objects keep their members in file order and are
+// searched linearly, they only ever hold a handful. Lookups that miss return a shared null value,
+// so optional fields read as value["a"]["b"].number(fallback) without checks in between.
+class JsonValue
+{
+private:
+	JSON_TYPES m_type;
+	bool m_bool;
+	double m_number;
+	std::string m_string;
+	std::vector<JsonValue> m_items;
+	std::vector<std::pair<std::string, JsonValue>> m_members;
+
+	friend class JsonParser;
+
+public:
+	JsonValue();
+
+	// false and the reason in error when the text is not valid JSON
+	static bool parse(const char *text, const size_t &length, JsonValue &value, std::string *error = NULL);
+
+	JSON_TYPES type() const;
+	bool isNull() const;
+	bool isNumber() const;
+	bool isString() const;
+	bool isArray() const;
+	bool isObject() const;
+
+	bool boolean(const bool &fallback = false) const;
+	double number(const double &fallback = 0.0) const;
+	int integer(const int &fallback = 0) const;
+	const std::string &string() const;
+
+	// items of an array, members of an object
+	size_t size() const;
+	const JsonValue &operator[](const size_t &index) const;
+	const JsonValue &operator[](const char *key) const;
+	bool has(const char *key) const;
+	const std::vector<std::pair<std::string, JsonValue>> &members() const;
+};
+
+#endif // UTIL_JSON_HPP
\ No newline at end of file
@@ -0,0 +1,35 @@
+#ifndef UTIL_MAPPEDFILE_HPP
+#define UTIL_MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file (mmap, or a file mapping on Windows). Pages are only
+// read from disk when touched, so handing pointers into the mapping straight to GL avoids any
+// intermediate copy on our side.
+class MappedFile
+{
+private:
+	const unsigned char *m_data;
+	size_t m_size;
+#ifdef _WIN32
+	void *m_file;
+	void *m_mapping;
+#endif
+
+public:
+	MappedFile();
+	~MappedFile();
+
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	bool open(const std::string &path);
+	void close();
+
+	bool isOpen() const;
+	const unsigned char *data() const;
+	size_t size() const;
+};
+
+#endif // UTIL_MAPPEDFILE_HPP
\ No newline at end of file
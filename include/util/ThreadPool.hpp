@@ -0,0 +1,73 @@
+#ifndef UTIL_THREADPOOL_HPP
+#define UTIL_THREADPOOL_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+class ThreadPool
+{
+private:
+	std::vector<std::thread> m_workers;
+	std::queue<std::function<void()>> m_tasks;
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	bool m_stopping;
+
+	void work();
+	// runs one queued task on the calling thread, false if there was none
+	bool runOne();
+
+public:
+	explicit ThreadPool(unsigned int threads);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool &) = delete;
+	ThreadPool &operator=(const ThreadPool &) = delete;
+
+	// process wide pool sized to the number of hardware threads
+	static ThreadPool &shared();
+
+	unsigned int size() const;
+
+	template <typename F>
+	auto submit(F &&task) -> std::future<decltype(task())>
+	{
+		using Result = decltype(task());
+		auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+		std::future<Result> result = packaged->get_future();
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_tasks.emplace([packaged]()
+							{ (*packaged)(); });
+		}
+		m_condition.notify_one();
+		return result;
+	}
+
+	// blocks until task is ready, running queued tasks on this thread in the meantime, so pool tasks
+	// can wait on tasks they submitted without starving the workers
+	template <typename T>
+	void wait(std::future<T> &task)
+	{
+		while (task.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			if (!runOne())
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	// runs body(i) for every i in [begin, end) split into chunks across the pool and waits for all of them,
+	// the caller helps with queued work while it waits, so this also works from inside a pool task
+	void parallelFor(const int &begin, const int &end, const std::function<void(int)> &body);
+};
+
+#endif // UTIL_THREADPOOL_HPP
\ No newline at end of file
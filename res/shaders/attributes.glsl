@@ -0,0 +1,7 @@
+// vertex attribute locations shared by every mesh VAO
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aColor;
+layout (location = 2) in vec2 aTexCoord;
+layout (location = 3) in float aLayer;
+// baked meshes (bake mesh) also carry normals
+layout (location = 4) in vec3 aNormal;
\ No newline at end of file
@@ -0,0 +1,6 @@
+// per frame data shared by every program, mirrored by FrameData in main.cpp
+layout (std140) uniform Frame
+{
+	mat4 transform;
+	float time;
+};
\ No newline at end of file
@@ -0,0 +1,34 @@
+#version 330 core
+#ifdef VT_FEEDBACK
+out uvec4 FragColor;
+#else
+out vec4 FragColor;
+#endif
+
+in vec3 ourColor;
+#ifdef HAS_TEXTURE
+in vec2 TexCoord;
+
+#ifdef HAS_TEXTURE_ARRAY
+flat in float Layer;
+uniform sampler2DArray ourTexture;
+#else
+uniform sampler2D ourTexture;
+#endif
+#endif
+#include "virtual_texture.glsl"
+
+void main()
+{
+#if defined(VT_FEEDBACK)
+	FragColor = virtualFeedback(TexCoord);
+#elif defined(HAS_VIRTUAL_TEXTURE)
+	FragColor = sampleVirtual(TexCoord) * vec4(ourColor, 1.0f);
+#elif defined(HAS_TEXTURE_ARRAY)
+	FragColor = texture(ourTexture, vec3(TexCoord, Layer)) * vec4(ourColor, 1.0f);
+#elif defined(HAS_TEXTURE)
+	FragColor = texture(ourTexture, TexCoord) * vec4(ourColor, 1.0f);
+#else
+	FragColor = vec4(ourColor, 1.0);
+#endif
+}
\ No newline at end of file
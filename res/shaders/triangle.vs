@@ -0,0 +1,23 @@
+#version 330 core
+#include "attributes.glsl"
+#include "frame.glsl"
+
+out vec3 ourColor;
+#ifdef HAS_TEXTURE
+out vec2 TexCoord;
+#endif
+#ifdef HAS_TEXTURE_ARRAY
+flat out float Layer;
+#endif
+
+void main()
+{
+	gl_Position = transform * vec4(aPos, 1.0);
+	ourColor = aColor;
+#ifdef HAS_TEXTURE
+	TexCoord = aTexCoord;
+#endif
+#ifdef HAS_TEXTURE_ARRAY
+	Layer = aLayer;
+#endif
+}
\ No newline at end of file
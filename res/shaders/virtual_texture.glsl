@@ -0,0 +1,66 @@
+// virtual texture lookups, see VirtualTexture.hpp. ourTexture is the physical page cache.
+#ifdef HAS_VIRTUAL_TEXTURE
+uniform usampler2D vtPageTable;
+// level 0 width and height, page size and border in texels
+uniform vec4 vtInfo;
+// cache width and height in texels, coarsest level, mip bias
+uniform vec4 vtCacheInfo;
+
+float vtLevel(vec2 uv)
+{
+	vec2 texel = uv * vtInfo.xy;
+	vec2 dx = dFdx(texel);
+	vec2 dy = dFdy(texel);
+	float lod = 0.5 * log2(max(max(dot(dx, dx), dot(dy, dy)), 1e-8)) + vtCacheInfo.w;
+	return clamp(lod, 0.0, vtCacheInfo.z);
+}
+
+// same halving as the mip generator
+vec2 vtLevelSize(int level)
+{
+	return max(vec2(1.0), floor(vtInfo.xy / exp2(float(level))));
+}
+
+ivec2 vtPage(vec2 uv, int level)
+{
+	vec2 pages = vtLevelSize(level) / vtInfo.z;
+	return clamp(ivec2(uv * pages), ivec2(0), ivec2(ceil(pages)) - 1);
+}
+
+vec4 vtSampleLevel(vec2 uv, int level)
+{
+	ivec2 page = vtPage(uv, level);
+	uvec4 entry = texelFetch(vtPageTable, page, level);
+	int resident = int(entry.b);
+
+	// position inside the resident page, the halving can push it under a texel into the border
+	vec2 inPage = uv * vtLevelSize(resident) / vtInfo.z - vec2(page >> (resident - level));
+	float limit = vtInfo.w / vtInfo.z;
+	inPage = clamp(inPage, vec2(-limit), vec2(1.0 + limit));
+
+	vec2 texel = vec2(entry.rg) * (vtInfo.z + 2.0 * vtInfo.w) + vtInfo.w + inPage * vtInfo.z;
+	return textureLod(ourTexture, texel / vtCacheInfo.xy, 0.0);
+}
+
+// blends the two nearest levels, the cache itself has no mips
+vec4 sampleVirtual(vec2 uv)
+{
+	uv = clamp(uv, 0.0, 1.0);
+	float lod = vtLevel(uv);
+	int level = int(lod);
+	vec4 fine = vtSampleLevel(uv, level);
+	if (level >= int(vtCacheInfo.z))
+	{
+		return fine;
+	}
+	return mix(fine, vtSampleLevel(uv, level + 1), fract(lod));
+}
+
+// page and level this pixel needs, alpha 1 marks it as covered
+uvec4 virtualFeedback(vec2 uv)
+{
+	uv = clamp(uv, 0.0, 1.0);
+	int level = int(vtLevel(uv));
+	return uvec4(uvec2(vtPage(uv, level)), uint(level), 1u);
+}
+#endif
\ No newline at end of file
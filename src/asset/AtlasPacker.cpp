@@ -0,0 +1,292 @@
+#include "asset/AtlasPacker.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+struct PackRect
+{
+	int x;
+	int y;
+	int width;
+	int height;
+};
+
+static bool contains(const PackRect &outer, const PackRect &inner)
+{
+	return inner.x >= outer.x && inner.y >= outer.y && inner.x + inner.width <= outer.x + outer.width && inner.y + inner.height <= outer.y + outer.height;
+}
+
+static bool intersects(const PackRect &a, const PackRect &b)
+{
+	return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+// free space of one page as a set of maximal, possibly overlapping rectangles
+class MaxRectsBin
+{
+private:
+	vector<PackRect> m_free;
+
+	void split(const PackRect &freeRect, const PackRect &used)
+	{
+		if (used.x > freeRect.x)
+		{
+			m_free.push_back({freeRect.x, freeRect.y, used.x - freeRect.x, freeRect.height});
+		}
+		if (used.x + used.width < freeRect.x + freeRect.width)
+		{
+			m_free.push_back({used.x + used.width, freeRect.y, freeRect.x + freeRect.width - used.x - used.width, freeRect.height});
+		}
+		if (used.y > freeRect.y)
+		{
+			m_free.push_back({freeRect.x, freeRect.y, freeRect.width, used.y - freeRect.y});
+		}
+		if (used.y + used.height < freeRect.y + freeRect.height)
+		{
+			m_free.push_back({freeRect.x, used.y + used.height, freeRect.width, freeRect.y + freeRect.height - used.y - used.height});
+		}
+	}
+
+	void prune()
+	{
+		for (size_t i = 0; i < m_free.size(); i++)
+		{
+			for (size_t j = i + 1; j < m_free.size();)
+			{
+				if (contains(m_free[j], m_free[i]))
+				{
+					m_free.erase(m_free.begin() + i);
+					i--;
+					break;
+				}
+				if (contains(m_free[i], m_free[j]))
+				{
+					m_free.erase(m_free.begin() + j);
+					continue;
+				}
+				j++;
+			}
+		}
+	}
+
+public:
+	explicit MaxRectsBin(const int &size) : m_free{{0, 0, size, size}} {}
+
+	bool insert(const int &width, const int &height, PackRect &placed)
+	{
+		int bestShort = INT_MAX, bestLong = INT_MAX;
+		for (const PackRect &freeRect : m_free)
+		{
+			if (freeRect.width < width || freeRect.height < height)
+			{
+				continue;
+			}
+			int leftoverX = freeRect.width - width, leftoverY = freeRect.height - height;
+			int shortSide = min(leftoverX, leftoverY), longSide = max(leftoverX, leftoverY);
+			if (shortSide < bestShort || (shortSide == bestShort && longSide < bestLong))
+			{
+				bestShort = shortSide;
+				bestLong = longSide;
+				placed = {freeRect.x, freeRect.y, width, height};
+			}
+		}
+		if (bestShort == INT_MAX)
+		{
+			return false;
+		}
+
+		size_t count = m_free.size();
+		for (size_t i = 0; i < count;)
+		{
+			if (intersects(m_free[i], placed))
+			{
+				// split appends to m_free, so it gets a copy
+				PackRect freeRect = m_free[i];
+				split(freeRect, placed);
+				m_free.erase(m_free.begin() + i);
+				count--;
+				continue;
+			}
+			i++;
+		}
+		prune();
+		return true;
+	}
+};
+
+void AtlasEntry::remap(float &u, float &v) const
+{
+	u = u0 + u * (u1 - u0);
+	v = v0 + v * (v1 - v0);
+}
+
+float AtlasPage::occupancy() const
+{
+	return (float)usedTexels / ((size_t)width * height);
+}
+
+static void computeUVs(AtlasEntry &entry, const int &pageWidth, const int &pageHeight)
+{
+	entry.u0 = (float)entry.x / pageWidth;
+	entry.v0 = (float)entry.y / pageHeight;
+	entry.u1 = (float)(entry.x + entry.width) / pageWidth;
+	entry.v1 = (float)(entry.y + entry.height) / pageHeight;
+}
+
+// copies the image into its padded rectangle, the border clamps to the edge texels
+static void blit(AtlasPage &page, const AtlasImage &image, const PackRect &rect, const int &gutter)
+{
+	for (int y = 0; y < rect.height; y++)
+	{
+		int sy = min(max(y - gutter, 0), image.height - 1);
+		unsigned char *row = page.pixels.data() + ((size_t)(rect.y + y) * page.width + rect.x) * 4;
+		for (int x = 0; x < rect.width; x++)
+		{
+			int sx = min(max(x - gutter, 0), image.width - 1);
+			memcpy(row + x * 4, image.pixels.data() + ((size_t)sy * image.width + sx) * 4, 4);
+		}
+	}
+}
+
+bool AtlasPacker::pack(const std::vector<AtlasImage> &images, const AtlasOptions &options, std::vector<AtlasPage> &pages, std::vector<AtlasEntry> &entries)
+{
+	const int alignment = 1 << options.mipLevels;
+	auto alignUp = [alignment](const int &v)
+	{ return (v + alignment - 1) / alignment * alignment; };
+
+	// largest first packs tighter
+	vector<size_t> order(images.size());
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		order[i] = i;
+	}
+	sort(order.begin(), order.end(), [&](size_t a, size_t b)
+		 {
+		int sideA = max(images[a].width, images[a].height), sideB = max(images[b].width, images[b].height);
+		return sideA != sideB ? sideA > sideB : images[a].width * images[a].height > images[b].width * images[b].height; });
+
+	vector<MaxRectsBin> bins;
+	pages.clear();
+	entries.assign(images.size(), AtlasEntry());
+	for (size_t index : order)
+	{
+		const AtlasImage &image = images[index];
+		int width = alignUp(image.width + options.gutter * 2), height = alignUp(image.height + options.gutter * 2);
+		if (width > options.pageSize || height > options.pageSize)
+		{
+			cout << "ERROR::ATLAS_PACKER::IMAGE_TOO_LARGE " << image.name << " " << image.width << "x" << image.height << endl;
+			return false;
+		}
+
+		PackRect rect;
+		size_t page = 0;
+		while (page < bins.size() && !bins[page].insert(width, height, rect))
+		{
+			page++;
+		}
+		if (page == bins.size())
+		{
+			bins.emplace_back(options.pageSize);
+			pages.push_back({options.pageSize, options.pageSize, vector<unsigned char>((size_t)options.pageSize * options.pageSize * 4, 0), 0});
+			bins.back().insert(width, height, rect);
+		}
+
+		blit(pages[page], image, rect, options.gutter);
+		pages[page].usedTexels += (size_t)image.width * image.height;
+
+		AtlasEntry &entry = entries[index];
+		entry.name = image.name;
+		entry.page = (int)page;
+		entry.x = rect.x + options.gutter;
+		entry.y = rect.y + options.gutter;
+		entry.width = image.width;
+		entry.height = image.height;
+		computeUVs(entry, options.pageSize, options.pageSize);
+	}
+	return true;
+}
+
+void AtlasPacker::remapUVs(float *vertices, const int &vertexCount, const int &stride, const int &uvOffset, const AtlasEntry &entry)
+{
+	for (int i = 0; i < vertexCount; i++)
+	{
+		float *uv = vertices + (size_t)i * stride + uvOffset;
+		entry.remap(uv[0], uv[1]);
+	}
+}
+
+bool AtlasPacker::writeManifest(const std::string &path, const std::vector<std::string> &pageFiles, const std::vector<AtlasPage> &pages, const std::vector<AtlasEntry> &entries)
+{
+	ofstream file(path, ios::trunc);
+	if (!file)
+	{
+		cout << "ERROR::ATLAS_PACKER::CANNOT_WRITE " << path << endl;
+		return false;
+	}
+
+	file << "# page <file> <width> <height>" << endl
+		 << "# image <name> <page> <x> <y> <width> <height>" << endl;
+	for (size_t i = 0; i < pages.size(); i++)
+	{
+		file << "page " << pageFiles[i] << " " << pages[i].width << " " << pages[i].height << endl;
+	}
+	for (const AtlasEntry &entry : entries)
+	{
+		file << "image " << entry.name << " " << entry.page << " " << entry.x << " " << entry.y << " " << entry.width << " " << entry.height << endl;
+	}
+	return (bool)file;
+}
+
+bool AtlasPacker::readManifest(const std::string &path, std::vector<std::string> &pageFiles, std::vector<AtlasEntry> &entries)
+{
+	ifstream file(path);
+	if (!file)
+	{
+		return false;
+	}
+
+	vector<pair<int, int>> pageSizes;
+	pageFiles.clear();
+	entries.clear();
+	string line;
+	while (getline(file, line))
+	{
+		istringstream stream(line);
+		string kind;
+		if (!(stream >> kind) || kind[0] == '#')
+		{
+			continue;
+		}
+
+		if (kind == "page")
+		{
+			string pageFile;
+			int width, height;
+			if (!(stream >> pageFile >> width >> height))
+			{
+				cout << "ERROR::ATLAS_PACKER::BAD_MANIFEST_LINE " << path << ": " << line << endl;
+				return false;
+			}
+			pageFiles.push_back(pageFile);
+			pageSizes.push_back({width, height});
+		}
+		else if (kind == "image")
+		{
+			AtlasEntry entry;
+			if (!(stream >> entry.name >> entry.page >> entry.x >> entry.y >> entry.width >> entry.height) || entry.page < 0 || entry.page >= (int)pageSizes.size())
+			{
+				cout << "ERROR::ATLAS_PACKER::BAD_MANIFEST_LINE " << path << ": " << line << endl;
+				return false;
+			}
+			computeUVs(entry, pageSizes[entry.page].first, pageSizes[entry.page].second);
+			entries.push_back(entry);
+		}
+	}
+	return true;
+}
\ No newline at end of file
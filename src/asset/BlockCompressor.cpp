@@ -0,0 +1,503 @@
+#include "asset/BlockCompressor.hpp"
+#include "util/ThreadPool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+struct Color565
+{
+	uint16_t packed;
+	float rgb[3];
+};
+
+static int clampByte(const float &v)
+{
+	return v < 0.f ? 0 : v > 255.f ? 255 : (int)(v + 0.5f);
+}
+
+static Color565 quantize565(const float rgb[3])
+{
+	int r = (clampByte(rgb[0]) * 31 + 127) / 255;
+	int g = (clampByte(rgb[1]) * 63 + 127) / 255;
+	int b = (clampByte(rgb[2]) * 31 + 127) / 255;
+
+	Color565 color;
+	color.packed = (uint16_t)((r << 11) | (g << 5) | b);
+	color.rgb[0] = (float)((r << 3) | (r >> 2));
+	color.rgb[1] = (float)((g << 2) | (g >> 4));
+	color.rgb[2] = (float)((b << 3) | (b >> 2));
+	return color;
+}
+
+static void expand565(const uint16_t &packed, unsigned char rgb[3])
+{
+	int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+	rgb[0] = (unsigned char)((r << 3) | (r >> 2));
+	rgb[1] = (unsigned char)((g << 2) | (g >> 4));
+	rgb[2] = (unsigned char)((b << 3) | (b >> 2));
+}
+
+// block pixels split into channel planes
+struct BlockPlanes
+{
+	alignas(16) float r[16];
+	alignas(16) float g[16];
+	alignas(16) float b[16];
+};
+
+// nearest palette entry for every pixel, returns the summed squared error
+static float assignIndices(const BlockPlanes &pixels, const float palette[4][3], int indices[16])
+{
+#ifdef __SSE2__
+	__m128 total = _mm_setzero_ps();
+	for (int i = 0; i < 16; i += 4)
+	{
+		__m128 r = _mm_load_ps(pixels.r + i), g = _mm_load_ps(pixels.g + i), b = _mm_load_ps(pixels.b + i);
+		__m128 best = _mm_set1_ps(1e30f);
+		__m128i bestIndex = _mm_setzero_si128();
+		for (int p = 0; p < 4; p++)
+		{
+			__m128 dr = _mm_sub_ps(r, _mm_set1_ps(palette[p][0]));
+			__m128 dg = _mm_sub_ps(g, _mm_set1_ps(palette[p][1]));
+			__m128 db = _mm_sub_ps(b, _mm_set1_ps(palette[p][2]));
+			__m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dr, dr), _mm_mul_ps(dg, dg)), _mm_mul_ps(db, db));
+			__m128 closer = _mm_cmplt_ps(d, best);
+			best = _mm_or_ps(_mm_and_ps(closer, d), _mm_andnot_ps(closer, best));
+			__m128i mask = _mm_castps_si128(closer);
+			bestIndex = _mm_or_si128(_mm_and_si128(mask, _mm_set1_epi32(p)), _mm_andnot_si128(mask, bestIndex));
+		}
+		total = _mm_add_ps(total, best);
+		_mm_storeu_si128((__m128i *)(indices + i), bestIndex);
+	}
+	alignas(16) float sums[4];
+	_mm_store_ps(sums, total);
+	return sums[0] + sums[1] + sums[2] + sums[3];
+#else
+	float total = 0.f;
+	for (int i = 0; i < 16; i++)
+	{
+		float best = 1e30f;
+		for (int p = 0; p < 4; p++)
+		{
+			float dr = pixels.r[i] - palette[p][0], dg = pixels.g[i] - palette[p][1], db = pixels.b[i] - palette[p][2];
+			float d = dr * dr + dg * dg + db * db;
+			if (d < best)
+			{
+				best = d;
+				indices[i] = p;
+			}
+		}
+		total += best;
+	}
+	return total;
+#endif
+}
+
+static void buildPalette(const Color565 &c0, const Color565 &c1, float palette[4][3])
+{
+	for (int c = 0; c < 3; c++)
+	{
+		palette[0][c] = c0.rgb[c];
+		palette[1][c] = c1.rgb[c];
+		palette[2][c] = (2.f * c0.rgb[c] + c1.rgb[c]) / 3.f;
+		palette[3][c] = (c0.rgb[c] + 2.f * c1.rgb[c]) / 3.f;
+	}
+}
+
+// orders the endpoints for four colour mode and evaluates them, returns the error
+static float evaluate(const BlockPlanes &pixels, Color565 c0, Color565 c1, uint16_t &e0, uint16_t &e1, int indices[16])
+{
+	if (c0.packed < c1.packed)
+	{
+		swap(c0, c1);
+	}
+	e0 = c0.packed;
+	e1 = c1.packed;
+	if (c0.packed == c1.packed)
+	{
+		// three colour mode would kick in, a single colour block only needs index 0
+		float palette[4][3];
+		buildPalette(c0, c1, palette);
+		float error = assignIndices(pixels, palette, indices);
+		fill(indices, indices + 16, 0);
+		return error;
+	}
+	float palette[4][3];
+	buildPalette(c0, c1, palette);
+	return assignIndices(pixels, palette, indices);
+}
+
+static void endpointsBoundingBox(const BlockPlanes &pixels, float lo[3], float hi[3])
+{
+	const float *planes[3] = {pixels.r, pixels.g, pixels.b};
+	for (int c = 0; c < 3; c++)
+	{
+		lo[c] = *min_element(planes[c], planes[c] + 16);
+		hi[c] = *max_element(planes[c], planes[c] + 16);
+		// inset the box by 1/16 of its size, the extremes are rarely hit exactly
+		float inset = (hi[c] - lo[c]) / 16.f;
+		lo[c] += inset;
+		hi[c] -= inset;
+	}
+}
+
+static void endpointsPrincipalAxis(const BlockPlanes &pixels, float lo[3], float hi[3])
+{
+	const float *planes[3] = {pixels.r, pixels.g, pixels.b};
+	float mean[3] = {0.f, 0.f, 0.f};
+	for (int c = 0; c < 3; c++)
+	{
+		for (int i = 0; i < 16; i++)
+		{
+			mean[c] += planes[c][i];
+		}
+		mean[c] /= 16.f;
+	}
+
+	float cov[6] = {0.f, 0.f, 0.f, 0.f, 0.f, 0.f};
+	for (int i = 0; i < 16; i++)
+	{
+		float d[3] = {planes[0][i] - mean[0], planes[1][i] - mean[1], planes[2][i] - mean[2]};
+		cov[0] += d[0] * d[0];
+		cov[1] += d[0] * d[1];
+		cov[2] += d[0] * d[2];
+		cov[3] += d[1] * d[1];
+		cov[4] += d[1] * d[2];
+		cov[5] += d[2] * d[2];
+	}
+
+	// power iteration for the dominant eigenvector
+	float axis[3] = {1.f, 1.f, 1.f};
+	for (int iteration = 0; iteration < 8; iteration++)
+	{
+		float next[3] = {
+			cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2],
+			cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2],
+			cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2]};
+		float length = sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+		if (length < 1e-6f)
+		{
+			break;
+		}
+		for (int c = 0; c < 3; c++)
+		{
+			axis[c] = next[c] / length;
+		}
+	}
+
+	float minT = 1e30f, maxT = -1e30f;
+	for (int i = 0; i < 16; i++)
+	{
+		float t = (planes[0][i] - mean[0]) * axis[0] + (planes[1][i] - mean[1]) * axis[1] + (planes[2][i] - mean[2]) * axis[2];
+		minT = min(minT, t);
+		maxT = max(maxT, t);
+	}
+	for (int c = 0; c < 3; c++)
+	{
+		lo[c] = mean[c] + axis[c] * minT;
+		hi[c] = mean[c] + axis[c] * maxT;
+	}
+}
+
+// least squares endpoints for a fixed index assignment
+static bool refitEndpoints(const BlockPlanes &pixels, const int indices[16], float e0[3], float e1[3])
+{
+	static const float WEIGHTS[4] = {1.f, 0.f, 2.f / 3.f, 1.f / 3.f};
+	const float *planes[3] = {pixels.r, pixels.g, pixels.b};
+
+	float a = 0.f, b = 0.f, c = 0.f, x[3] = {0.f, 0.f, 0.f}, y[3] = {0.f, 0.f, 0.f};
+	for (int i = 0; i < 16; i++)
+	{
+		float w = WEIGHTS[indices[i]], v = 1.f - w;
+		a += w * w;
+		b += w * v;
+		c += v * v;
+		for (int ch = 0; ch < 3; ch++)
+		{
+			x[ch] += w * planes[ch][i];
+			y[ch] += v * planes[ch][i];
+		}
+	}
+
+	float det = a * c - b * b;
+	if (fabs(det) < 1e-6f)
+	{
+		return false;
+	}
+	for (int ch = 0; ch < 3; ch++)
+	{
+		e0[ch] = (c * x[ch] - b * y[ch]) / det;
+		e1[ch] = (a * y[ch] - b * x[ch]) / det;
+	}
+	return true;
+}
+
+static void writeBC1(const uint16_t &e0, const uint16_t &e1, const int indices[16], unsigned char out[8])
+{
+	uint32_t bits = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		bits |= (uint32_t)indices[i] << (i * 2);
+	}
+	out[0] = (unsigned char)(e0 & 0xFF);
+	out[1] = (unsigned char)(e0 >> 8);
+	out[2] = (unsigned char)(e1 & 0xFF);
+	out[3] = (unsigned char)(e1 >> 8);
+	memcpy(out + 4, &bits, 4);
+}
+
+void BlockCompressor::encodeBC1Block(const unsigned char rgba[64], unsigned char out[8], const BC_QUALITY &quality)
+{
+	BlockPlanes pixels;
+	for (int i = 0; i < 16; i++)
+	{
+		pixels.r[i] = rgba[i * 4];
+		pixels.g[i] = rgba[i * 4 + 1];
+		pixels.b[i] = rgba[i * 4 + 2];
+	}
+
+	float lo[3], hi[3];
+	if (quality == BC_FAST)
+	{
+		endpointsBoundingBox(pixels, lo, hi);
+	}
+	else
+	{
+		endpointsPrincipalAxis(pixels, lo, hi);
+	}
+
+	uint16_t e0, e1;
+	int indices[16];
+	float error = evaluate(pixels, quantize565(hi), quantize565(lo), e0, e1, indices);
+
+	if (quality == BC_NORMAL)
+	{
+		for (int iteration = 0; iteration < 2 && error > 0.f; iteration++)
+		{
+			float f0[3], f1[3];
+			if (!refitEndpoints(pixels, indices, f0, f1))
+			{
+				break;
+			}
+			uint16_t r0, r1;
+			int refined[16];
+			float refinedError = evaluate(pixels, quantize565(f0), quantize565(f1), r0, r1, refined);
+			if (refinedError >= error)
+			{
+				break;
+			}
+			error = refinedError;
+			e0 = r0;
+			e1 = r1;
+			memcpy(indices, refined, sizeof(indices));
+		}
+	}
+
+	writeBC1(e0, e1, indices, out);
+}
+
+void BlockCompressor::encodeBC3Block(const unsigned char rgba[64], unsigned char out[16], const BC_QUALITY &quality)
+{
+	int lo = 255, hi = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		lo = min(lo, (int)rgba[i * 4 + 3]);
+		hi = max(hi, (int)rgba[i * 4 + 3]);
+	}
+
+	// eight value mode: a0 > a1, six interpolated steps between them
+	uint64_t bits = 0;
+	if (hi != lo)
+	{
+		float palette[8];
+		palette[0] = (float)hi;
+		palette[1] = (float)lo;
+		for (int k = 1; k < 7; k++)
+		{
+			palette[k + 1] = ((7 - k) * hi + k * lo) / 7.f;
+		}
+		for (int i = 0; i < 16; i++)
+		{
+			float a = rgba[i * 4 + 3];
+			int best = 0;
+			float bestError = 1e30f;
+			for (int p = 0; p < 8; p++)
+			{
+				float d = fabs(a - palette[p]);
+				if (d < bestError)
+				{
+					bestError = d;
+					best = p;
+				}
+			}
+			bits |= (uint64_t)best << (i * 3);
+		}
+	}
+
+	out[0] = (unsigned char)hi;
+	out[1] = (unsigned char)lo;
+	for (int i = 0; i < 6; i++)
+	{
+		out[2 + i] = (unsigned char)(bits >> (i * 8));
+	}
+	encodeBC1Block(rgba, out + 8, quality);
+}
+
+void BlockCompressor::decodeBC1Block(const unsigned char block[8], unsigned char rgba[64])
+{
+	uint16_t e0 = (uint16_t)(block[0] | (block[1] << 8));
+	uint16_t e1 = (uint16_t)(block[2] | (block[3] << 8));
+	unsigned char colors[4][4];
+	expand565(e0, colors[0]);
+	expand565(e1, colors[1]);
+	for (int c = 0; c < 3; c++)
+	{
+		if (e0 > e1)
+		{
+			colors[2][c] = (unsigned char)((2 * colors[0][c] + colors[1][c] + 1) / 3);
+			colors[3][c] = (unsigned char)((colors[0][c] + 2 * colors[1][c] + 1) / 3);
+		}
+		else
+		{
+			colors[2][c] = (unsigned char)((colors[0][c] + colors[1][c]) / 2);
+			colors[3][c] = 0;
+		}
+	}
+	colors[0][3] = colors[1][3] = colors[2][3] = 255;
+	colors[3][3] = e0 > e1 ? 255 : 0;
+
+	uint32_t bits;
+	memcpy(&bits, block + 4, 4);
+	for (int i = 0; i < 16; i++)
+	{
+		memcpy(rgba + i * 4, colors[(bits >> (i * 2)) & 3], 4);
+	}
+}
+
+void BlockCompressor::decodeBC3Block(const unsigned char block[16], unsigned char rgba[64])
+{
+	decodeBC1Block(block + 8, rgba);
+
+	int a0 = block[0], a1 = block[1];
+	int palette[8] = {a0, a1};
+	for (int k = 1; k < 7; k++)
+	{
+		palette[k + 1] = a0 > a1 ? ((7 - k) * a0 + k * a1 + 3) / 7 : 0;
+	}
+	if (a0 <= a1)
+	{
+		for (int k = 1; k < 5; k++)
+		{
+			palette[k + 1] = ((5 - k) * a0 + k * a1 + 2) / 5;
+		}
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+
+	uint64_t bits = 0;
+	for (int i = 0; i < 6; i++)
+	{
+		bits |= (uint64_t)block[2 + i] << (i * 8);
+	}
+	for (int i = 0; i < 16; i++)
+	{
+		rgba[i * 4 + 3] = (unsigned char)palette[(bits >> (i * 3)) & 7];
+	}
+}
+
+TextureLevel BlockCompressor::compress(const TextureLevel &level, const int &channels, const uint32_t &format, const BC_QUALITY &quality, const bool &parallel)
+{
+	const int blockBytes = format == TEX_FMT_BC1 ? 8 : 16;
+	const uint32_t blocksX = (level.width + 3) / 4, blocksY = (level.height + 3) / 4;
+
+	TextureLevel result;
+	result.width = level.width;
+	result.height = level.height;
+	result.data.resize((size_t)blocksX * blocksY * blockBytes);
+
+	auto encodeRow = [&](int by)
+	{
+		unsigned char rgba[64];
+		for (uint32_t bx = 0; bx < blocksX; bx++)
+		{
+			// edge blocks of levels that are not a multiple of 4 repeat the last row/column
+			for (int y = 0; y < 4; y++)
+			{
+				uint32_t sy = min((uint32_t)by * 4 + y, level.height - 1);
+				for (int x = 0; x < 4; x++)
+				{
+					uint32_t sx = min(bx * 4 + x, level.width - 1);
+					const unsigned char *src = level.data.data() + ((size_t)sy * level.width + sx) * channels;
+					unsigned char *dst = rgba + (y * 4 + x) * 4;
+					dst[0] = src[0];
+					dst[1] = src[1];
+					dst[2] = src[2];
+					dst[3] = channels == 4 ? src[3] : 255;
+				}
+			}
+
+			unsigned char *out = result.data.data() + ((size_t)by * blocksX + bx) * blockBytes;
+			if (format == TEX_FMT_BC1)
+			{
+				encodeBC1Block(rgba, out, quality);
+			}
+			else
+			{
+				encodeBC3Block(rgba, out, quality);
+			}
+		}
+	};
+
+	if (parallel)
+	{
+		ThreadPool::shared().parallelFor(0, (int)blocksY, encodeRow);
+	}
+	else
+	{
+		for (uint32_t by = 0; by < blocksY; by++)
+		{
+			encodeRow((int)by);
+		}
+	}
+	return result;
+}
+
+vector<unsigned char> BlockCompressor::decompress(const TextureLevel &level, const uint32_t &format)
+{
+	const int blockBytes = format == TEX_FMT_BC1 ? 8 : 16;
+	const uint32_t blocksX = (level.width + 3) / 4, blocksY = (level.height + 3) / 4;
+	vector<unsigned char> pixels((size_t)level.width * level.height * 4);
+
+	unsigned char rgba[64];
+	for (uint32_t by = 0; by < blocksY; by++)
+	{
+		for (uint32_t bx = 0; bx < blocksX; bx++)
+		{
+			const unsigned char *block = level.data.data() + ((size_t)by * blocksX + bx) * blockBytes;
+			if (format == TEX_FMT_BC1)
+			{
+				decodeBC1Block(block, rgba);
+			}
+			else
+			{
+				decodeBC3Block(block, rgba);
+			}
+
+			for (uint32_t y = 0; y < 4 && by * 4 + y < level.height; y++)
+			{
+				for (uint32_t x = 0; x < 4 && bx * 4 + x < level.width; x++)
+				{
+					memcpy(pixels.data() + ((size_t)(by * 4 + y) * level.width + bx * 4 + x) * 4, rgba + (y * 4 + x) * 4, 4);
+				}
+			}
+		}
+	}
+	return pixels;
+}
\ No newline at end of file
@@ -0,0 +1,808 @@
+#include "asset/GltfFile.hpp"
+#include "asset/JpegDecoder.hpp"
+#include "asset/MipGenerator.hpp"
+#include "util/Json.hpp"
+#include "util/ThreadPool.hpp"
+
+#include <stb/stb_image.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <future>
+#include <iostream>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+static const uint32_t GLB_MAGIC = 0x46546C67;
+static const uint32_t GLB_JSON = 0x4E4F534A;
+static const uint32_t GLB_BIN = 0x004E4942;
+static const int GLTF_TRIANGLES = 4;
+// buffer views are faulted in by the pool in chunks of this size
+static const size_t PREFAULT_CHUNK = 4 << 20;
+
+static int componentsOf(const string &type)
+{
+	if (type == "SCALAR")
+	{
+		return 1;
+	}
+	if (type == "VEC2")
+	{
+		return 2;
+	}
+	if (type == "VEC3")
+	{
+		return 3;
+	}
+	if (type == "VEC4")
+	{
+		return 4;
+	}
+	// matrices are not used by anything we import
+	return 0;
+}
+
+static uint32_t locationOf(const string &semantic)
+{
+	if (semantic == "POSITION")
+	{
+		return GltfFile::POSITION_LOCATION;
+	}
+	if (semantic == "COLOR_0")
+	{
+		return GltfFile::COLOR_LOCATION;
+	}
+	if (semantic == "TEXCOORD_0")
+	{
+		return GltfFile::TEXCOORD_LOCATION;
+	}
+	if (semantic == "NORMAL")
+	{
+		return GltfFile::NORMAL_LOCATION;
+	}
+	return ~0u;
+}
+
+static bool decodeBase64(const string &text, const size_t &start, vector<unsigned char> &out)
+{
+	static const string ALPHABET = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	out.clear();
+	out.reserve((text.size() - start) / 4 * 3);
+	uint32_t bits = 0;
+	int count = 0;
+	for (size_t i = start; i < text.size() && text[i] != '='; i++)
+	{
+		size_t value = ALPHABET.find(text[i]);
+		if (value == string::npos)
+		{
+			return false;
+		}
+		bits = bits << 6 | (uint32_t)value;
+		count += 6;
+		if (count >= 8)
+		{
+			count -= 8;
+			out.push_back((unsigned char)(bits >> count));
+		}
+	}
+	return true;
+}
+
+// data: URIs decode into out, anything else is a file next to the document and gets mapped
+static bool resolveUri(const GltfDocument &document, const string &uri, shared_ptr<MappedFile> &file, vector<unsigned char> &out)
+{
+	if (uri.compare(0, 5, "data:") == 0)
+	{
+		size_t comma = uri.find(";base64,");
+		return comma != string::npos && decodeBase64(uri, comma + 8, out);
+	}
+
+	// URIs are percent encoded
+	string path = document.directory;
+	for (size_t i = 0; i < uri.size(); i++)
+	{
+		if (uri[i] == '%' && i + 2 < uri.size())
+		{
+			path += (char)strtol(uri.substr(i + 1, 2).c_str(), NULL, 16);
+			i += 2;
+		}
+		else
+		{
+			path += uri[i];
+		}
+	}
+	file = make_shared<MappedFile>();
+	return file->open(path);
+}
+
+// a byte offset, length or count: absent reads as 0, anything but a whole non-negative number a double
+// holds exactly is rejected instead of being cast
+static bool readSize(const JsonValue &value, size_t &out)
+{
+	out = 0;
+	if (value.isNull())
+	{
+		return true;
+	}
+	double number = value.number(-1.0);
+	if (!value.isNumber() || number < 0.0 || number > 9007199254740992.0 || floor(number) != number)
+	{
+		return false;
+	}
+	out = (size_t)number;
+	return true;
+}
+
+// whether count items of itemSize bytes, stride apart, fit in length bytes from offset
+static bool rangeFits(const size_t &length, const size_t &offset, const size_t &count, const size_t &itemSize, const size_t &stride)
+{
+	if (count == 0)
+	{
+		return offset <= length;
+	}
+	return offset <= length && itemSize <= length - offset && count - 1 <= (length - offset - itemSize) / stride;
+}
+
+static bool accessorFits(const GltfDocument &document, const GltfAccessor &accessor)
+{
+	size_t element = (size_t)GltfFile::componentSize(accessor.componentType) * accessor.components;
+	// indices are 32 bit, so no stream may hold more elements than they can address
+	if (element == 0 || accessor.count > UINT32_MAX)
+	{
+		return false;
+	}
+	if (accessor.bufferView >= 0)
+	{
+		if (accessor.bufferView >= (int)document.bufferViews.size())
+		{
+			return false;
+		}
+		const GltfBufferView &view = document.bufferViews[accessor.bufferView];
+		size_t stride = view.stride ? view.stride : element;
+		if (!rangeFits(view.length, accessor.offset, accessor.count, element, stride))
+		{
+			return false;
+		}
+	}
+	if (accessor.sparseCount > 0)
+	{
+		int indexSize = GltfFile::componentSize(accessor.sparseIndexType);
+		bool unsignedIndex = accessor.sparseIndexType == GLTF_UNSIGNED_BYTE || accessor.sparseIndexType == GLTF_UNSIGNED_SHORT ||
+							 accessor.sparseIndexType == GLTF_UNSIGNED_INT;
+		if (accessor.sparseCount > accessor.count || !unsignedIndex ||
+			accessor.sparseIndexView < 0 || accessor.sparseIndexView >= (int)document.bufferViews.size() ||
+			accessor.sparseValueView < 0 || accessor.sparseValueView >= (int)document.bufferViews.size() ||
+			!rangeFits(document.bufferViews[accessor.sparseIndexView].length, accessor.sparseIndexOffset, accessor.sparseCount, indexSize, indexSize) ||
+			!rangeFits(document.bufferViews[accessor.sparseValueView].length, accessor.sparseValueOffset, accessor.sparseCount, element, element))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static uint32_t readIndex(const unsigned char *data, const uint32_t &componentType, const size_t &i)
+{
+	if (componentType == GLTF_UNSIGNED_BYTE)
+	{
+		return data[i];
+	}
+	if (componentType == GLTF_UNSIGNED_SHORT)
+	{
+		uint16_t value;
+		memcpy(&value, data + i * 2, 2);
+		return value;
+	}
+	uint32_t value;
+	memcpy(&value, data + i * 4, 4);
+	return value;
+}
+
+static void widenIndices(const unsigned char *source, uint16_t *target, const size_t &count)
+{
+	size_t i = 0;
+#ifdef __SSE2__
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 16 <= count; i += 16)
+	{
+		__m128i bytes = _mm_loadu_si128((const __m128i *)(source + i));
+		_mm_storeu_si128((__m128i *)(target + i), _mm_unpacklo_epi8(bytes, zero));
+		_mm_storeu_si128((__m128i *)(target + i + 8), _mm_unpackhi_epi8(bytes, zero));
+	}
+#endif
+	for (; i < count; i++)
+	{
+		target[i] = source[i];
+	}
+}
+
+// the accessor's elements tightly packed, with any sparse values applied
+static void densify(const GltfDocument &document, const GltfAccessor &accessor, vector<unsigned char> &out)
+{
+	size_t element = (size_t)GltfFile::componentSize(accessor.componentType) * accessor.components;
+	out.assign(accessor.count * element, 0);
+	if (accessor.bufferView >= 0)
+	{
+		const unsigned char *source = GltfFile::viewData(document, accessor.bufferView) + accessor.offset;
+		size_t stride = document.bufferViews[accessor.bufferView].stride;
+		if (stride == 0 || stride == element)
+		{
+			memcpy(out.data(), source, out.size());
+		}
+		else
+		{
+			for (size_t i = 0; i < accessor.count; i++)
+			{
+				memcpy(&out[i * element], source + i * stride, element);
+			}
+		}
+	}
+	if (accessor.sparseCount > 0)
+	{
+		const unsigned char *indices = GltfFile::viewData(document, accessor.sparseIndexView) + accessor.sparseIndexOffset;
+		const unsigned char *values = GltfFile::viewData(document, accessor.sparseValueView) + accessor.sparseValueOffset;
+		for (size_t i = 0; i < accessor.sparseCount; i++)
+		{
+			uint32_t target = readIndex(indices, accessor.sparseIndexType, i);
+			if (target < accessor.count)
+			{
+				memcpy(&out[target * element], values + i * element, element);
+			}
+		}
+	}
+}
+
+static void makeStream(const GltfDocument &document, const int &index, const uint32_t &location, GltfStream &stream)
+{
+	const GltfAccessor &accessor = document.accessors[index];
+	size_t element = (size_t)GltfFile::componentSize(accessor.componentType) * accessor.components;
+	stream.location = location;
+	stream.componentType = accessor.componentType;
+	stream.components = accessor.components;
+	stream.normalized = accessor.normalized;
+	if (accessor.bufferView >= 0 && accessor.sparseCount == 0)
+	{
+		size_t stride = document.bufferViews[accessor.bufferView].stride;
+		stream.stride = stride ? stride : element;
+		stream.offset = accessor.offset;
+		stream.bufferView = accessor.bufferView;
+		return;
+	}
+	stream.stride = element;
+	stream.offset = 0;
+	stream.bufferView = -1;
+	densify(document, accessor, stream.converted);
+}
+
+static void preparePrimitive(const GltfDocument &document, const GltfPrimitive &primitive, GltfPreparedPrimitive &prepared)
+{
+	prepared.material = primitive.material;
+	prepared.valid = true;
+	size_t vertexCount = 0, attributeCount = SIZE_MAX;
+	for (const auto &attribute : primitive.attributes)
+	{
+		prepared.attributes.emplace_back();
+		makeStream(document, attribute.second, attribute.first, prepared.attributes.back());
+		if (attribute.first == GltfFile::POSITION_LOCATION)
+		{
+			vertexCount = document.accessors[attribute.second].count;
+		}
+		attributeCount = std::min(attributeCount, document.accessors[attribute.second].count);
+	}
+
+	GltfStream &indices = prepared.indices;
+	indices.location = 0;
+	indices.components = 1;
+	indices.normalized = false;
+	if (primitive.indices >= 0)
+	{
+		const GltfAccessor &accessor = document.accessors[primitive.indices];
+		prepared.indexCount = accessor.count;
+		makeStream(document, primitive.indices, 0, indices);
+		if (accessor.componentType == GLTF_UNSIGNED_BYTE)
+		{
+			// byte indices are emulated by some drivers, 16 bit ones never are
+			vector<unsigned char> bytes;
+			if (indices.bufferView >= 0)
+			{
+				const unsigned char *source = GltfFile::viewData(document, indices.bufferView) + indices.offset;
+				bytes.assign(source, source + accessor.count);
+			}
+			else
+			{
+				bytes.swap(indices.converted);
+			}
+			indices.converted.resize(accessor.count * 2);
+			widenIndices(bytes.data(), (uint16_t *)indices.converted.data(), accessor.count);
+			indices.componentType = GLTF_UNSIGNED_SHORT;
+			indices.stride = 2;
+			indices.offset = 0;
+			indices.bufferView = -1;
+		}
+
+		// GL is not asked for robust access, an index past the shortest attribute would read past its buffer
+		const unsigned char *data = indices.bufferView >= 0 ? GltfFile::viewData(document, indices.bufferView) + indices.offset : indices.converted.data();
+		for (size_t i = 0; i < accessor.count && prepared.valid; i++)
+		{
+			uint32_t index = readIndex(data + i * indices.stride, indices.componentType, 0);
+			prepared.valid = index < attributeCount;
+		}
+		return;
+	}
+
+	// non-indexed, drawn through the same indexed path as everything else
+	prepared.valid = vertexCount <= attributeCount;
+	prepared.indexCount = vertexCount;
+	indices.bufferView = -1;
+	indices.offset = 0;
+	if (vertexCount <= 0x10000)
+	{
+		indices.componentType = GLTF_UNSIGNED_SHORT;
+		indices.stride = 2;
+		indices.converted.resize(vertexCount * 2);
+		uint16_t *target = (uint16_t *)indices.converted.data();
+		for (size_t i = 0; i < vertexCount; i++)
+		{
+			target[i] = (uint16_t)i;
+		}
+	}
+	else
+	{
+		indices.componentType = GLTF_UNSIGNED_INT;
+		indices.stride = 4;
+		indices.converted.resize(vertexCount * 4);
+		uint32_t *target = (uint32_t *)indices.converted.data();
+		for (size_t i = 0; i < vertexCount; i++)
+		{
+			target[i] = (uint32_t)i;
+		}
+	}
+}
+
+static void prepareImage(const GltfDocument &document, const GltfImage &image, const bool &parallel, GltfPreparedImage &prepared)
+{
+	prepared.channels = 0;
+	shared_ptr<MappedFile> file;
+	vector<unsigned char> embedded;
+	const unsigned char *data;
+	size_t size;
+	if (image.bufferView >= 0)
+	{
+		data = GltfFile::viewData(document, image.bufferView);
+		size = document.bufferViews[image.bufferView].length;
+	}
+	else if (resolveUri(document, image.uri, file, embedded))
+	{
+		data = file ? file->data() : embedded.data();
+		size = file ? file->size() : embedded.size();
+	}
+	else
+	{
+		cout << "ERROR::GLTF::IMAGE_NOT_FOUND " << image.uri << endl;
+		return;
+	}
+
+	int width, height, channels;
+	unsigned char *pixels = JpegDecoder::decode(data, size, &width, &height, &channels, 0, parallel);
+	if (!pixels)
+	{
+		pixels = stbi_load_from_memory(data, (int)size, &width, &height, &channels, 0);
+	}
+	if (!pixels)
+	{
+		cout << "ERROR::GLTF::IMAGE_NOT_DECODED " << (image.uri.empty() ? "<buffer view>" : image.uri) << endl;
+		return;
+	}
+
+	// images already go in parallel, the levels of each are built serially
+	MipOptions options;
+	options.parallel = false;
+	MipGenerator::generate(pixels, width, height, channels, options, prepared.levels);
+	stbi_image_free(pixels);
+	prepared.channels = channels;
+}
+
+int GltfFile::componentSize(const uint32_t &componentType)
+{
+	switch (componentType)
+	{
+	case GLTF_BYTE:
+	case GLTF_UNSIGNED_BYTE:
+		return 1;
+	case GLTF_SHORT:
+	case GLTF_UNSIGNED_SHORT:
+		return 2;
+	case GLTF_UNSIGNED_INT:
+	case GLTF_FLOAT:
+		return 4;
+	default:
+		return 0;
+	}
+}
+
+bool GltfFile::open(const std::string &path, GltfDocument &document)
+{
+	document = GltfDocument();
+	size_t slash = path.find_last_of("/\\");
+	document.directory = slash == string::npos ? "" : path.substr(0, slash + 1);
+
+	auto file = make_shared<MappedFile>();
+	if (!file->open(path))
+	{
+		cout << "ERROR::GLTF::FILE_NOT_READ " << path << endl;
+		return false;
+	}
+	document.files.push_back(file);
+
+	// a .glb is a JSON chunk followed by an optional BIN chunk that buffer 0 refers to
+	const char *json = (const char *)file->data();
+	size_t jsonLength = file->size();
+	const unsigned char *bin = NULL;
+	size_t binLength = 0;
+	// magic, version, length, then the JSON chunk's length and type
+	uint32_t words[5] = {};
+	if (file->size() >= sizeof(words))
+	{
+		memcpy(words, file->data(), sizeof(words));
+	}
+	if (words[0] == GLB_MAGIC)
+	{
+		if (words[1] != 2 || words[2] > file->size() || words[4] != GLB_JSON || 20 + (size_t)words[3] > words[2])
+		{
+			cout << "ERROR::GLTF::INVALID_GLB " << path << endl;
+			return false;
+		}
+		json = (const char *)file->data() + 20;
+		jsonLength = words[3];
+		size_t binChunk = 20 + ((jsonLength + 3) & ~(size_t)3);
+		uint32_t chunk[2] = {};
+		if (binChunk + 8 <= words[2])
+		{
+			memcpy(chunk, file->data() + binChunk, 8);
+		}
+		if (chunk[1] == GLB_BIN && binChunk + 8 + chunk[0] <= words[2])
+		{
+			bin = file->data() + binChunk + 8;
+			binLength = chunk[0];
+		}
+	}
+
+	JsonValue root;
+	string error;
+	if (!JsonValue::parse(json, jsonLength, root, &error))
+	{
+		cout << "ERROR::GLTF::INVALID_JSON " << path << ": " << error << endl;
+		return false;
+	}
+	if (root["asset"]["version"].string().compare(0, 1, "2") != 0)
+	{
+		cout << "ERROR::GLTF::UNSUPPORTED_VERSION " << path << endl;
+		return false;
+	}
+
+	const JsonValue &buffers = root["buffers"];
+	for (size_t i = 0; i < buffers.size(); i++)
+	{
+		const JsonValue &buffer = buffers[i];
+		size_t length;
+		bool lengthValid = readSize(buffer["byteLength"], length);
+		if (!buffer.has("uri"))
+		{
+			if (i != 0 || !bin || !lengthValid || length > binLength)
+			{
+				cout << "ERROR::GLTF::MISSING_BUFFER " << path << endl;
+				return false;
+			}
+			document.bufferData.push_back(bin);
+			document.bufferSize.push_back(length);
+			continue;
+		}
+
+		shared_ptr<MappedFile> bufferFile;
+		vector<unsigned char> embedded;
+		if (!lengthValid || !resolveUri(document, buffer["uri"].string(), bufferFile, embedded) ||
+			(bufferFile ? bufferFile->size() : embedded.size()) < length)
+		{
+			cout << "ERROR::GLTF::MISSING_BUFFER " << buffer["uri"].string() << endl;
+			return false;
+		}
+		if (bufferFile)
+		{
+			document.bufferData.push_back(bufferFile->data());
+			document.files.push_back(bufferFile);
+		}
+		else
+		{
+			// vector storage stays put when the outer vector grows
+			document.embedded.push_back(move(embedded));
+			document.bufferData.push_back(document.embedded.back().data());
+		}
+		document.bufferSize.push_back(length);
+	}
+
+	const JsonValue &views = root["bufferViews"];
+	for (size_t i = 0; i < views.size(); i++)
+	{
+		GltfBufferView view;
+		view.buffer = views[i]["buffer"].integer(-1);
+		bool valid = readSize(views[i]["byteOffset"], view.offset) && readSize(views[i]["byteLength"], view.length) &&
+					 readSize(views[i]["byteStride"], view.stride);
+		if (!valid || view.buffer < 0 || view.buffer >= (int)document.bufferData.size() || view.stride > 252 ||
+			!rangeFits(document.bufferSize[view.buffer], view.offset, 1, view.length, 1))
+		{
+			cout << "ERROR::GLTF::INVALID_BUFFER_VIEW " << i << endl;
+			return false;
+		}
+		document.bufferViews.push_back(view);
+	}
+
+	const JsonValue &accessors = root["accessors"];
+	for (size_t i = 0; i < accessors.size(); i++)
+	{
+		const JsonValue &value = accessors[i];
+		GltfAccessor accessor = {};
+		accessor.bufferView = value["bufferView"].integer(-1);
+		bool sizesValid = readSize(value["byteOffset"], accessor.offset);
+		accessor.componentType = (uint32_t)value["componentType"].integer();
+		accessor.normalized = value["normalized"].boolean();
+		sizesValid = readSize(value["count"], accessor.count) && sizesValid;
+		accessor.components = componentsOf(value["type"].string());
+		accessor.hasBounds = value["min"].size() >= 3 && value["max"].size() >= 3;
+		for (int c = 0; c < 3 && accessor.hasBounds; c++)
+		{
+			accessor.min[c] = (float)value["min"][c].number();
+			accessor.max[c] = (float)value["max"][c].number();
+		}
+		const JsonValue &sparse = value["sparse"];
+		if (sparse.isObject())
+		{
+			sizesValid = readSize(sparse["count"], accessor.sparseCount) && sizesValid;
+			accessor.sparseIndexView = sparse["indices"]["bufferView"].integer(-1);
+			sizesValid = readSize(sparse["indices"]["byteOffset"], accessor.sparseIndexOffset) && sizesValid;
+			accessor.sparseIndexType = (uint32_t)sparse["indices"]["componentType"].integer();
+			accessor.sparseValueView = sparse["values"]["bufferView"].integer(-1);
+			sizesValid = readSize(sparse["values"]["byteOffset"], accessor.sparseValueOffset) && sizesValid;
+		}
+		// matrix accessors fail here too, they are only valid where we do not read them
+		if (!sizesValid || !accessorFits(document, accessor))
+		{
+			accessor.components = 0;
+		}
+		document.accessors.push_back(accessor);
+	}
+
+	// textures are only an indirection from materials to images, samplers are not imported
+	vector<int> textureSource;
+	const JsonValue &textures = root["textures"];
+	for (size_t i = 0; i < textures.size(); i++)
+	{
+		textureSource.push_back(textures[i]["source"].integer(-1));
+	}
+
+	const JsonValue &images = root["images"];
+	for (size_t i = 0; i < images.size(); i++)
+	{
+		GltfImage image;
+		image.uri = images[i]["uri"].string();
+		image.bufferView = images[i]["bufferView"].integer(-1);
+		if (image.bufferView >= (int)document.bufferViews.size() || (image.bufferView < 0 && image.uri.empty()))
+		{
+			cout << "ERROR::GLTF::INVALID_IMAGE " << i << endl;
+			return false;
+		}
+		document.images.push_back(image);
+	}
+
+	const JsonValue &materials = root["materials"];
+	for (size_t i = 0; i < materials.size(); i++)
+	{
+		const JsonValue &pbr = materials[i]["pbrMetallicRoughness"];
+		GltfMaterial material;
+		for (int c = 0; c < 4; c++)
+		{
+			material.baseColor[c] = (float)pbr["baseColorFactor"][c].number(1.0);
+		}
+		int texture = pbr["baseColorTexture"]["index"].integer(-1);
+		material.baseColorImage = texture >= 0 && texture < (int)textureSource.size() && textureSource[texture] < (int)document.images.size() ? textureSource[texture] : -1;
+		document.materials.push_back(material);
+	}
+
+	const JsonValue &meshes = root["meshes"];
+	for (size_t i = 0; i < meshes.size(); i++)
+	{
+		GltfMesh mesh;
+		mesh.name = meshes[i]["name"].string();
+		const JsonValue &primitives = meshes[i]["primitives"];
+		for (size_t p = 0; p < primitives.size(); p++)
+		{
+			const JsonValue &value = primitives[p];
+			GltfPrimitive primitive;
+			primitive.indices = value["indices"].integer(-1);
+			primitive.material = value["material"].integer(-1);
+			primitive.mode = value["mode"].integer(GLTF_TRIANGLES);
+			bool valid = primitive.indices < (int)document.accessors.size() && primitive.material < (int)document.materials.size() &&
+						 (primitive.indices < 0 || (document.accessors[primitive.indices].components == 1 && document.accessors[primitive.indices].componentType != GLTF_FLOAT));
+			for (const auto &attribute : value["attributes"].members())
+			{
+				uint32_t location = locationOf(attribute.first);
+				int accessor = attribute.second.integer(-1);
+				if (location == ~0u)
+				{
+					continue;
+				}
+				if (accessor < 0 || accessor >= (int)document.accessors.size() || document.accessors[accessor].components == 0)
+				{
+					valid = false;
+					break;
+				}
+				primitive.attributes.emplace_back(location, accessor);
+			}
+			bool hasPosition = any_of(primitive.attributes.begin(), primitive.attributes.end(), [](const pair<uint32_t, int> &attribute)
+									  { return attribute.first == POSITION_LOCATION; });
+			if (!valid || !hasPosition)
+			{
+				cout << "ERROR::GLTF::INVALID_PRIMITIVE mesh " << i << " primitive " << p << endl;
+				return false;
+			}
+			mesh.primitives.push_back(primitive);
+		}
+		document.meshes.push_back(mesh);
+	}
+	return true;
+}
+
+const unsigned char *GltfFile::viewData(const GltfDocument &document, const int &bufferView)
+{
+	const GltfBufferView &view = document.bufferViews[bufferView];
+	return document.bufferData[view.buffer] + view.offset;
+}
+
+bool GltfFile::prepare(const GltfDocument &document, GltfPrepared &prepared, const bool &parallel)
+{
+	prepared = GltfPrepared();
+	prepared.viewUsed.assign(document.bufferViews.size(), 0);
+
+	vector<const GltfPrimitive *> primitives;
+	for (const GltfMesh &mesh : document.meshes)
+	{
+		for (const GltfPrimitive &primitive : mesh.primitives)
+		{
+			if (primitive.mode == GLTF_TRIANGLES)
+			{
+				primitives.push_back(&primitive);
+			}
+			else
+			{
+				prepared.skipped++;
+			}
+		}
+	}
+	prepared.primitives.resize(primitives.size());
+	prepared.images.resize(document.images.size());
+
+	// images are the slow part, they start first and primitives are prepared while they decode
+	ThreadPool &pool = ThreadPool::shared();
+	vector<future<void>> images;
+	for (size_t i = 0; i < document.images.size(); i++)
+	{
+		if (parallel)
+		{
+			images.push_back(pool.submit([&document, &prepared, i]()
+										 { prepareImage(document, document.images[i], true, prepared.images[i]); }));
+		}
+		else
+		{
+			prepareImage(document, document.images[i], false, prepared.images[i]);
+		}
+	}
+
+	auto preparePrimitiveAt = [&](int i)
+	{ preparePrimitive(document, *primitives[i], prepared.primitives[i]); };
+	if (parallel)
+	{
+		pool.parallelFor(0, (int)primitives.size(), preparePrimitiveAt);
+	}
+	else
+	{
+		for (int i = 0; i < (int)primitives.size(); i++)
+		{
+			preparePrimitiveAt(i);
+		}
+	}
+
+	for (size_t i = 0; i < primitives.size(); i++)
+	{
+		if (!prepared.primitives[i].valid)
+		{
+			cout << "ERROR::GLTF::INDEX_OUT_OF_RANGE primitive " << i << endl;
+			for (future<void> &image : images)
+			{
+				pool.wait(image);
+			}
+			return false;
+		}
+	}
+
+	float min[3] = {INFINITY, INFINITY, INFINITY}, max[3] = {-INFINITY, -INFINITY, -INFINITY};
+	for (size_t i = 0; i < primitives.size(); i++)
+	{
+		for (const GltfStream &stream : prepared.primitives[i].attributes)
+		{
+			if (stream.bufferView >= 0)
+			{
+				prepared.viewUsed[stream.bufferView] = 1;
+			}
+			prepared.convertedBytes += stream.converted.size();
+		}
+		const GltfStream &indices = prepared.primitives[i].indices;
+		if (indices.bufferView >= 0)
+		{
+			prepared.viewUsed[indices.bufferView] = 1;
+		}
+		prepared.convertedBytes += indices.converted.size();
+
+		// position accessors must carry min/max, so bounds never touch vertex data
+		for (const auto &attribute : primitives[i]->attributes)
+		{
+			const GltfAccessor &accessor = document.accessors[attribute.second];
+			if (attribute.first == POSITION_LOCATION && accessor.hasBounds)
+			{
+				for (int c = 0; c < 3; c++)
+				{
+					min[c] = std::min(min[c], accessor.min[c]);
+					max[c] = std::max(max[c], accessor.max[c]);
+				}
+			}
+		}
+	}
+	if (min[0] <= max[0])
+	{
+		float radius2 = 0.f;
+		for (int c = 0; c < 3; c++)
+		{
+			prepared.bounds.min[c] = min[c];
+			prepared.bounds.max[c] = max[c];
+			prepared.bounds.center[c] = (min[c] + max[c]) * 0.5f;
+			radius2 += (max[c] - min[c]) * (max[c] - min[c]) * 0.25f;
+		}
+		prepared.bounds.radius = sqrt(radius2);
+	}
+
+	// the render thread copies used views straight out of the mappings, touching their pages here
+	// spreads the page faults (the actual disk reads on a cold cache) across the pool
+	vector<pair<const unsigned char *, size_t>> chunks;
+	for (size_t i = 0; i < document.bufferViews.size(); i++)
+	{
+		if (!prepared.viewUsed[i])
+		{
+			continue;
+		}
+		size_t length = document.bufferViews[i].length;
+		prepared.viewBytes += length;
+		for (size_t offset = 0; offset < length; offset += PREFAULT_CHUNK)
+		{
+			chunks.emplace_back(viewData(document, (int)i) + offset, std::min(PREFAULT_CHUNK, length - offset));
+		}
+	}
+	if (parallel)
+	{
+		pool.parallelFor(0, (int)chunks.size(), [&chunks](int i)
+						 {
+							 volatile unsigned char sink = 0;
+							 for (size_t offset = 0; offset < chunks[i].second; offset += 4096)
+							 {
+								 sink = sink + chunks[i].first[offset];
+							 } });
+	}
+
+	for (future<void> &image : images)
+	{
+		pool.wait(image);
+	}
+	return true;
+}
\ No newline at end of file
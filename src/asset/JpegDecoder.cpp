@@ -0,0 +1,976 @@
+#include "asset/JpegDecoder.hpp"
+#include "util/MappedFile.hpp"
+#include "util/ThreadPool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+static const int DEZIGZAG[64 + 16] = {
+	0, 1, 8, 16, 9, 2, 3, 10, 17, 24, 32, 25, 18, 11, 4, 5,
+	12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6, 7, 14, 21, 28,
+	35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+	58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63,
+	// runs past the end land here instead of out of bounds
+	63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63};
+
+static const int FAST_BITS = 9;
+// MCU rows entropy decoded before their reconstruction is queued
+static const int BAND_ROWS = 4;
+static const int COLOR_ROWS_PER_TASK = 32;
+
+struct Huffman
+{
+	uint8_t fastLength[1 << FAST_BITS];
+	uint8_t fastSymbol[1 << FAST_BITS];
+	// AC codes whose magnitude bits also fit in the lookahead: value << 8 | run << 4 | total length
+	int32_t fastAc[1 << FAST_BITS];
+	int maxCode[18];
+	int valueOffset[17];
+	uint8_t values[256];
+	bool defined;
+};
+
+struct Component
+{
+	int id;
+	int h;
+	int v;
+	int quant;
+	int dcTable;
+	int acTable;
+	// reconstructed samples, padded to whole MCUs
+	int stride;
+	int rows;
+	vector<uint8_t> plane;
+};
+
+struct JpegImage
+{
+	int width;
+	int height;
+	int hMax;
+	int vMax;
+	int mcusX;
+	int mcusY;
+	int blocksPerMcu;
+	int restartInterval;
+	bool adobeRgb;
+	vector<Component> components;
+	// dequantisation with the AAN scale factors and the final 1/8 folded in, natural order
+	float quant[4][64];
+	bool quantDefined[4];
+	Huffman dc[4];
+	Huffman ac[4];
+	const uint8_t *scan;
+	const uint8_t *end;
+};
+
+class BitReader
+{
+private:
+	const uint8_t *m_position;
+	const uint8_t *m_end;
+	uint64_t m_bits;
+	int m_count;
+	bool m_marker;
+
+public:
+	BitReader(const uint8_t *begin, const uint8_t *end) : m_position(begin), m_end(end), m_bits(0), m_count(0), m_marker(false) {}
+
+	// tops the buffer up to at least 57 bits, zeros are shifted in once a marker or the end is reached
+	inline void fill()
+	{
+		while (m_count <= 56)
+		{
+			uint32_t byte = 0;
+			if (!m_marker && m_position < m_end)
+			{
+				byte = *m_position++;
+				if (byte == 0xFF)
+				{
+					uint32_t next = m_position < m_end ? *m_position : 0xD9;
+					if (next == 0x00)
+					{
+						m_position++;
+					}
+					else
+					{
+						m_marker = true;
+						m_position--;
+						byte = 0;
+					}
+				}
+			}
+			m_bits |= (uint64_t)byte << (56 - m_count);
+			m_count += 8;
+		}
+	}
+
+	inline uint32_t peek(const int &n) const
+	{
+		return (uint32_t)(m_bits >> (64 - n));
+	}
+
+	inline void consume(const int &n)
+	{
+		m_bits <<= n;
+		m_count -= n;
+	}
+
+	inline uint32_t peekFast()
+	{
+		fill();
+		return peek(FAST_BITS);
+	}
+
+	inline int receiveExtend(const int &n)
+	{
+		if (n == 0)
+		{
+			return 0;
+		}
+		fill();
+		int value = (int)peek(n);
+		consume(n);
+		return value < (1 << (n - 1)) ? value - (1 << n) + 1 : value;
+	}
+
+	int decode(const Huffman &table)
+	{
+		fill();
+		uint32_t look = peek(FAST_BITS);
+		int length = table.fastLength[look];
+		if (length)
+		{
+			consume(length);
+			return table.fastSymbol[look];
+		}
+		for (length = FAST_BITS + 1; length <= 16; length++)
+		{
+			int code = (int)peek(length);
+			if (code <= table.maxCode[length])
+			{
+				consume(length);
+				return table.values[(table.valueOffset[length] + code) & 0xFF];
+			}
+		}
+		return -1;
+	}
+};
+
+// false when the counts do not form a prefix code, more codes of a length than it has room for
+static bool buildHuffman(Huffman &table, const uint8_t counts[16], const uint8_t *symbols)
+{
+	table.defined = false;
+	memset(table.fastLength, 0, sizeof(table.fastLength));
+	int code = 0, k = 0;
+	for (int length = 1; length <= 16; length++)
+	{
+		// values[valueOffset + code] is the symbol of a code of this length
+		table.valueOffset[length] = k - code;
+		for (int i = 0; i < counts[length - 1]; i++, code++, k++)
+		{
+			if (code >= (1 << length))
+			{
+				return false;
+			}
+			if (length <= FAST_BITS)
+			{
+				int first = code << (FAST_BITS - length), count = 1 << (FAST_BITS - length);
+				for (int j = 0; j < count; j++)
+				{
+					table.fastLength[first + j] = (uint8_t)length;
+					table.fastSymbol[first + j] = symbols[k];
+				}
+			}
+		}
+		table.maxCode[length] = counts[length - 1] ? code - 1 : -1;
+		code <<= 1;
+	}
+	table.maxCode[17] = INT32_MAX;
+	memcpy(table.values, symbols, k);
+	table.defined = true;
+
+	for (int i = 0; i < (1 << FAST_BITS); i++)
+	{
+		table.fastAc[i] = 0;
+		int length = table.fastLength[i], run = table.fastSymbol[i] >> 4, bits = table.fastSymbol[i] & 15;
+		if (length == 0 || bits == 0 || length + bits > FAST_BITS)
+		{
+			continue;
+		}
+		int value = (i >> (FAST_BITS - length - bits)) & ((1 << bits) - 1);
+		value = value < (1 << (bits - 1)) ? value - (1 << bits) + 1 : value;
+		table.fastAc[i] = value * 256 + run * 16 + length + bits;
+	}
+	return true;
+}
+
+// ---- IDCT ----
+
+// AAN scale factors, cos(k * pi / 16) * sqrt(2) with k = 0 giving 1
+static float aanScale(const int &k)
+{
+	return k == 0 ? 1.f : (float)(cos(k * M_PI / 16.0) * sqrt(2.0));
+}
+
+#ifdef __SSE2__
+struct Row8
+{
+	__m128 lo;
+	__m128 hi;
+};
+static inline Row8 operator+(const Row8 &a, const Row8 &b) { return {_mm_add_ps(a.lo, b.lo), _mm_add_ps(a.hi, b.hi)}; }
+static inline Row8 operator-(const Row8 &a, const Row8 &b) { return {_mm_sub_ps(a.lo, b.lo), _mm_sub_ps(a.hi, b.hi)}; }
+static inline Row8 operator*(const Row8 &a, const float &s)
+{
+	__m128 v = _mm_set1_ps(s);
+	return {_mm_mul_ps(a.lo, v), _mm_mul_ps(a.hi, v)};
+}
+
+static inline void transpose(Row8 r[8])
+{
+	__m128 a0 = r[0].lo, a1 = r[1].lo, a2 = r[2].lo, a3 = r[3].lo;
+	__m128 b0 = r[0].hi, b1 = r[1].hi, b2 = r[2].hi, b3 = r[3].hi;
+	__m128 c0 = r[4].lo, c1 = r[5].lo, c2 = r[6].lo, c3 = r[7].lo;
+	__m128 d0 = r[4].hi, d1 = r[5].hi, d2 = r[6].hi, d3 = r[7].hi;
+	_MM_TRANSPOSE4_PS(a0, a1, a2, a3);
+	_MM_TRANSPOSE4_PS(b0, b1, b2, b3);
+	_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+	_MM_TRANSPOSE4_PS(d0, d1, d2, d3);
+	r[0] = {a0, c0};
+	r[1] = {a1, c1};
+	r[2] = {a2, c2};
+	r[3] = {a3, c3};
+	r[4] = {b0, d0};
+	r[5] = {b1, d1};
+	r[6] = {b2, d2};
+	r[7] = {b3, d3};
+}
+#else
+struct Row8
+{
+	float v[8];
+};
+static inline Row8 operator+(const Row8 &a, const Row8 &b)
+{
+	Row8 r;
+	for (int i = 0; i < 8; i++)
+	{
+		r.v[i] = a.v[i] + b.v[i];
+	}
+	return r;
+}
+static inline Row8 operator-(const Row8 &a, const Row8 &b)
+{
+	Row8 r;
+	for (int i = 0; i < 8; i++)
+	{
+		r.v[i] = a.v[i] - b.v[i];
+	}
+	return r;
+}
+static inline Row8 operator*(const Row8 &a, const float &s)
+{
+	Row8 r;
+	for (int i = 0; i < 8; i++)
+	{
+		r.v[i] = a.v[i] * s;
+	}
+	return r;
+}
+
+static inline void transpose(Row8 r[8])
+{
+	for (int y = 0; y < 8; y++)
+	{
+		for (int x = y + 1; x < 8; x++)
+		{
+			swap(r[y].v[x], r[x].v[y]);
+		}
+	}
+}
+#endif
+
+// one dimensional AAN IDCT (the float variant from the IJG library) applied to 8 lanes at once
+static inline void idct8(Row8 r[8])
+{
+	Row8 tmp10 = r[0] + r[4], tmp11 = r[0] - r[4];
+	Row8 tmp13 = r[2] + r[6], tmp12 = (r[2] - r[6]) * 1.414213562f - tmp13;
+	Row8 tmp0 = tmp10 + tmp13, tmp3 = tmp10 - tmp13;
+	Row8 tmp1 = tmp11 + tmp12, tmp2 = tmp11 - tmp12;
+
+	Row8 z13 = r[5] + r[3], z10 = r[5] - r[3];
+	Row8 z11 = r[1] + r[7], z12 = r[1] - r[7];
+	Row8 tmp7 = z11 + z13;
+	Row8 tmp11b = (z11 - z13) * 1.414213562f;
+	Row8 z5 = (z10 + z12) * 1.847759065f;
+	Row8 tmp10b = z12 * 1.082392200f - z5;
+	Row8 tmp12b = z10 * -2.613125930f + z5;
+	Row8 tmp6 = tmp12b - tmp7;
+	Row8 tmp5 = tmp11b - tmp6;
+	Row8 tmp4 = tmp10b + tmp5;
+
+	r[0] = tmp0 + tmp7;
+	r[7] = tmp0 - tmp7;
+	r[1] = tmp1 + tmp6;
+	r[6] = tmp1 - tmp6;
+	r[2] = tmp2 + tmp5;
+	r[5] = tmp2 - tmp5;
+	r[4] = tmp3 + tmp4;
+	r[3] = tmp3 - tmp4;
+}
+
+// dequantises, transforms and level shifts one block into an 8x8 area of a plane
+static void idctBlock(const int16_t coefficients[64], const float quant[64], uint8_t *out, const int &stride)
+{
+	Row8 rows[8];
+#ifdef __SSE2__
+	for (int y = 0; y < 8; y++)
+	{
+		__m128i c = _mm_loadu_si128((const __m128i *)(coefficients + y * 8));
+		// sign extend the eight 16 bit coefficients to 32 bit
+		__m128i sign = _mm_srai_epi16(c, 15);
+		rows[y].lo = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(c, sign)), _mm_loadu_ps(quant + y * 8));
+		rows[y].hi = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(c, sign)), _mm_loadu_ps(quant + y * 8 + 4));
+	}
+#else
+	for (int i = 0; i < 64; i++)
+	{
+		rows[i / 8].v[i % 8] = coefficients[i] * quant[i];
+	}
+#endif
+
+	// columns, then rows
+	idct8(rows);
+	transpose(rows);
+	idct8(rows);
+	transpose(rows);
+
+#ifdef __SSE2__
+	const __m128 bias = _mm_set1_ps(128.f);
+	for (int y = 0; y < 8; y++)
+	{
+		__m128i lo = _mm_cvtps_epi32(_mm_add_ps(rows[y].lo, bias));
+		__m128i hi = _mm_cvtps_epi32(_mm_add_ps(rows[y].hi, bias));
+		__m128i packed = _mm_packs_epi32(lo, hi);
+		_mm_storel_epi64((__m128i *)(out + (size_t)y * stride), _mm_packus_epi16(packed, packed));
+	}
+#else
+	for (int y = 0; y < 8; y++)
+	{
+		for (int x = 0; x < 8; x++)
+		{
+			int value = (int)lrintf(rows[y].v[x] + 128.f);
+			out[(size_t)y * stride + x] = (uint8_t)min(max(value, 0), 255);
+		}
+	}
+#endif
+}
+
+// ---- parsing ----
+
+static inline int read16(const uint8_t *p)
+{
+	return (p[0] << 8) | p[1];
+}
+
+static bool parseHeaders(const uint8_t *data, const size_t &size, JpegImage &image)
+{
+	if (!JpegDecoder::isJpeg(data, size))
+	{
+		return false;
+	}
+
+	image.restartInterval = 0;
+	image.adobeRgb = false;
+	image.width = image.height = 0;
+	memset(image.quantDefined, 0, sizeof(image.quantDefined));
+	for (int i = 0; i < 4; i++)
+	{
+		image.dc[i].defined = image.ac[i].defined = false;
+	}
+
+	const uint8_t *p = data + 2, *end = data + size;
+	while (p + 4 <= end)
+	{
+		if (p[0] != 0xFF)
+		{
+			return false;
+		}
+		int marker = p[1];
+		if (marker == 0xFF)
+		{
+			// fill byte
+			p++;
+			continue;
+		}
+		int length = read16(p + 2);
+		const uint8_t *segment = p + 4, *segmentEnd = p + 2 + length;
+		if (length < 2 || segmentEnd > end)
+		{
+			return false;
+		}
+
+		switch (marker)
+		{
+		case 0xC0:
+		case 0xC1:
+		{
+			if (length < 8 || segment[0] != 8)
+			{
+				return false;
+			}
+			image.height = read16(segment + 1);
+			image.width = read16(segment + 3);
+			int count = segment[5];
+			if (image.width == 0 || image.height == 0 || (count != 1 && count != 3) || length < 8 + count * 3)
+			{
+				return false;
+			}
+			image.components.resize(count);
+			for (int i = 0; i < count; i++)
+			{
+				Component &component = image.components[i];
+				component.id = segment[6 + i * 3];
+				component.h = segment[7 + i * 3] >> 4;
+				component.v = segment[7 + i * 3] & 15;
+				component.quant = segment[8 + i * 3];
+				if (component.h < 1 || component.h > 4 || component.v < 1 || component.v > 4 || component.quant > 3)
+				{
+					return false;
+				}
+			}
+			break;
+		}
+		case 0xC4:
+		{
+			const uint8_t *q = segment;
+			while (q + 17 <= segmentEnd)
+			{
+				int tableClass = q[0] >> 4, index = q[0] & 15, total = 0;
+				for (int i = 0; i < 16; i++)
+				{
+					total += q[1 + i];
+				}
+				if (tableClass > 1 || index > 3 || total > 256 || q + 17 + total > segmentEnd)
+				{
+					return false;
+				}
+				if (!buildHuffman(tableClass == 0 ? image.dc[index] : image.ac[index], q + 1, q + 17))
+				{
+					return false;
+				}
+				q += 17 + total;
+			}
+			break;
+		}
+		case 0xDB:
+		{
+			const uint8_t *q = segment;
+			while (q < segmentEnd)
+			{
+				int precision = q[0] >> 4, index = q[0] & 15;
+				if (index > 3 || q + 1 + 64 * (precision + 1) > segmentEnd)
+				{
+					return false;
+				}
+				for (int i = 0; i < 64; i++)
+				{
+					int value = precision ? read16(q + 1 + i * 2) : q[1 + i];
+					int natural = DEZIGZAG[i];
+					image.quant[index][natural] = value * aanScale(natural / 8) * aanScale(natural % 8) / 8.f;
+				}
+				image.quantDefined[index] = true;
+				q += 1 + 64 * (precision + 1);
+			}
+			break;
+		}
+		case 0xDD:
+			if (length < 4)
+			{
+				return false;
+			}
+			image.restartInterval = read16(segment);
+			break;
+		case 0xEE:
+			// Adobe, transform 0 means the three channels are RGB rather than YCbCr
+			if (length >= 14 && memcmp(segment, "Adobe", 5) == 0)
+			{
+				image.adobeRgb = segment[11] == 0;
+			}
+			break;
+		case 0xDA:
+		{
+			if (length < 3)
+			{
+				return false;
+			}
+			int count = segment[0];
+			if (image.components.empty() || count != (int)image.components.size() || length < 6 + count * 2)
+			{
+				// non-interleaved multi scan files are left to stb_image
+				return false;
+			}
+			for (int i = 0; i < count; i++)
+			{
+				Component &component = image.components[i];
+				if (segment[1 + i * 2] != component.id)
+				{
+					return false;
+				}
+				component.dcTable = segment[2 + i * 2] >> 4;
+				component.acTable = segment[2 + i * 2] & 15;
+				if (component.dcTable > 3 || component.acTable > 3 || !image.dc[component.dcTable].defined || !image.ac[component.acTable].defined ||
+					!image.quantDefined[component.quant])
+				{
+					return false;
+				}
+			}
+			// spectral selection and approximation must describe a full sequential scan
+			if (segment[1 + count * 2] != 0 || segment[2 + count * 2] != 63 || segment[3 + count * 2] != 0)
+			{
+				return false;
+			}
+			image.scan = segmentEnd;
+			image.end = end;
+			return true;
+		}
+		default:
+			// progressive, lossless, hierarchical and arithmetic coded frames
+			if ((marker >= 0xC2 && marker <= 0xC3) || (marker >= 0xC5 && marker <= 0xCF && marker != 0xC8 && marker != 0xCC))
+			{
+				return false;
+			}
+			break;
+		}
+		p = segmentEnd;
+	}
+	return false;
+}
+
+static void setupGeometry(JpegImage &image)
+{
+	if (image.components.size() == 1)
+	{
+		// a single component scan is never interleaved, its blocks cover the image directly
+		image.components[0].h = image.components[0].v = 1;
+	}
+
+	image.hMax = image.vMax = 1;
+	image.blocksPerMcu = 0;
+	for (const Component &component : image.components)
+	{
+		image.hMax = max(image.hMax, component.h);
+		image.vMax = max(image.vMax, component.v);
+		image.blocksPerMcu += component.h * component.v;
+	}
+	image.mcusX = (image.width + image.hMax * 8 - 1) / (image.hMax * 8);
+	image.mcusY = (image.height + image.vMax * 8 - 1) / (image.vMax * 8);
+
+	for (Component &component : image.components)
+	{
+		component.stride = image.mcusX * component.h * 8;
+		component.rows = image.mcusY * component.v * 8;
+		component.plane.resize((size_t)component.stride * component.rows);
+	}
+}
+
+// ---- entropy decoding and reconstruction ----
+
+static bool decodeMcu(const JpegImage &image, BitReader &reader, int predictors[3], int16_t *blocks)
+{
+	memset(blocks, 0, sizeof(int16_t) * 64 * image.blocksPerMcu);
+	for (size_t c = 0; c < image.components.size(); c++)
+	{
+		const Component &component = image.components[c];
+		const Huffman &dc = image.dc[component.dcTable], &ac = image.ac[component.acTable];
+		for (int b = 0; b < component.h * component.v; b++, blocks += 64)
+		{
+			int size = reader.decode(dc);
+			if (size < 0 || size > 11)
+			{
+				return false;
+			}
+			predictors[c] += reader.receiveExtend(size);
+			blocks[0] = (int16_t)predictors[c];
+
+			for (int k = 1; k < 64;)
+			{
+				int fast = ac.fastAc[reader.peekFast()];
+				if (fast)
+				{
+					reader.consume(fast & 15);
+					k += (fast >> 4) & 15;
+					if (k > 63)
+					{
+						return false;
+					}
+					blocks[DEZIGZAG[k++]] = (int16_t)(fast >> 8);
+					continue;
+				}
+
+				int symbol = reader.decode(ac);
+				if (symbol < 0)
+				{
+					return false;
+				}
+				int run = symbol >> 4, bits = symbol & 15;
+				if (bits == 0)
+				{
+					if (run != 15)
+					{
+						// end of block
+						break;
+					}
+					k += 16;
+					continue;
+				}
+				k += run;
+				if (k > 63)
+				{
+					return false;
+				}
+				blocks[DEZIGZAG[k++]] = (int16_t)reader.receiveExtend(bits);
+			}
+		}
+	}
+	return true;
+}
+
+static void reconstructMcu(JpegImage &image, const int &mcu, const int16_t *blocks)
+{
+	int mcuX = mcu % image.mcusX, mcuY = mcu / image.mcusX;
+	for (Component &component : image.components)
+	{
+		const float *quant = image.quant[component.quant];
+		for (int by = 0; by < component.v; by++)
+		{
+			for (int bx = 0; bx < component.h; bx++, blocks += 64)
+			{
+				size_t x = (size_t)(mcuX * component.h + bx) * 8, y = (size_t)(mcuY * component.v + by) * 8;
+				idctBlock(blocks, quant, component.plane.data() + y * component.stride + x, component.stride);
+			}
+		}
+	}
+}
+
+static void runTasks(const int &count, const bool &parallel, const function<void(int)> &body)
+{
+	if (parallel && count > 1)
+	{
+		ThreadPool::shared().parallelFor(0, count, body);
+		return;
+	}
+	for (int i = 0; i < count; i++)
+	{
+		body(i);
+	}
+}
+
+// every restart interval starts with reset predictors on a byte boundary, so they decode independently
+static bool decodeRestartIntervals(JpegImage &image, const bool &parallel)
+{
+	const int totalMcus = image.mcusX * image.mcusY;
+	const int intervals = (totalMcus + image.restartInterval - 1) / image.restartInterval;
+
+	vector<const uint8_t *> starts = {image.scan};
+	const uint8_t *p = image.scan;
+	while (p + 1 < image.end && (int)starts.size() < intervals)
+	{
+		if (p[0] == 0xFF && p[1] != 0x00 && p[1] != 0xFF)
+		{
+			if (p[1] < 0xD0 || p[1] > 0xD7)
+			{
+				break;
+			}
+			starts.push_back(p + 2);
+			p += 2;
+			continue;
+		}
+		p++;
+	}
+	if ((int)starts.size() != intervals)
+	{
+		return false;
+	}
+
+	vector<char> ok(intervals, 1);
+	runTasks(intervals, parallel, [&](int interval)
+			 {
+		BitReader reader(starts[interval], image.end);
+		int predictors[3] = {0, 0, 0};
+		vector<int16_t> blocks(64 * image.blocksPerMcu);
+		int first = interval * image.restartInterval, last = min(first + image.restartInterval, totalMcus);
+		for (int mcu = first; mcu < last; mcu++)
+		{
+			if (!decodeMcu(image, reader, predictors, blocks.data()))
+			{
+				ok[interval] = 0;
+				return;
+			}
+			reconstructMcu(image, mcu, blocks.data());
+		} });
+	return find(ok.begin(), ok.end(), 0) == ok.end();
+}
+
+// entropy decoding is inherently serial here, reconstruction of each finished band runs on the pool
+static bool decodeSequential(JpegImage &image, const bool &parallel)
+{
+	ThreadPool &pool = ThreadPool::shared();
+	const size_t bandMcus = (size_t)image.mcusX * BAND_ROWS;
+	const size_t maxInFlight = parallel ? pool.size() * 2 : 0;
+
+	BitReader reader(image.scan, image.end);
+	int predictors[3] = {0, 0, 0};
+	vector<future<void>> inFlight;
+	bool ok = true;
+	for (int firstRow = 0; firstRow < image.mcusY && ok; firstRow += BAND_ROWS)
+	{
+		int rows = min(BAND_ROWS, image.mcusY - firstRow);
+		int firstMcu = firstRow * image.mcusX, count = rows * image.mcusX;
+		shared_ptr<vector<int16_t>> band = make_shared<vector<int16_t>>((size_t)64 * image.blocksPerMcu * min(bandMcus, (size_t)count));
+		for (int i = 0; i < count && ok; i++)
+		{
+			ok = decodeMcu(image, reader, predictors, band->data() + (size_t)64 * image.blocksPerMcu * i);
+		}
+
+		auto reconstruct = [&image, band, firstMcu, count]()
+		{
+			for (int i = 0; i < count; i++)
+			{
+				reconstructMcu(image, firstMcu + i, band->data() + (size_t)64 * image.blocksPerMcu * i);
+			}
+		};
+		if (!parallel)
+		{
+			reconstruct();
+			continue;
+		}
+		if (inFlight.size() >= maxInFlight)
+		{
+			pool.wait(inFlight.front());
+			inFlight.erase(inFlight.begin());
+		}
+		inFlight.push_back(pool.submit(reconstruct));
+	}
+	for (future<void> &task : inFlight)
+	{
+		pool.wait(task);
+	}
+	return ok;
+}
+
+// ---- colour conversion ----
+
+// one row of a component at full resolution. 2x subsampled directions use the triangle filter
+// libjpeg calls fancy upsampling (3/4 nearest sample, 1/4 the next one out), other ratios replicate
+static const uint8_t *sampleRow(const Component &component, const JpegImage &image, const int &y, vector<uint8_t> &scratch, const int &width)
+{
+	const int xRatio = image.hMax / component.h, yRatio = image.vMax / component.v;
+	if (xRatio == 1 && yRatio == 1)
+	{
+		return component.plane.data() + (size_t)y * component.stride;
+	}
+
+	scratch.resize(width);
+	const bool fancy = xRatio <= 2 && yRatio <= 2 && image.hMax % component.h == 0 && image.vMax % component.v == 0;
+	if (!fancy)
+	{
+		const uint8_t *row = component.plane.data() + (size_t)(y * component.v / image.vMax) * component.stride;
+		for (int x = 0; x < width; x++)
+		{
+			scratch[x] = row[x * component.h / image.hMax];
+		}
+		return scratch.data();
+	}
+
+	// samples that hold image data, the rest of the plane is MCU padding
+	const int samplesX = (image.width + xRatio - 1) / xRatio, samplesY = (image.height + yRatio - 1) / yRatio;
+	const int nearY = y / yRatio;
+	const int farY = yRatio == 1 ? nearY : min(max(y % 2 ? nearY + 1 : nearY - 1, 0), samplesY - 1);
+	const uint8_t *near = component.plane.data() + (size_t)nearY * component.stride;
+	const uint8_t *far = component.plane.data() + (size_t)farY * component.stride;
+
+	// vertical pass scaled by 4, then horizontal pass scaled by 4 again
+	auto column = [&](const int &i)
+	{ return 3 * near[i] + far[i]; };
+	if (xRatio == 1)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			scratch[x] = (uint8_t)((column(x) + 2) >> 2);
+		}
+		return scratch.data();
+	}
+	for (int x = 0; x < width; x++)
+	{
+		int i = x / 2, j = min(max(x % 2 ? i + 1 : i - 1, 0), samplesX - 1);
+		scratch[x] = (uint8_t)((3 * column(i) + column(j) + 8) >> 4);
+	}
+	return scratch.data();
+}
+
+static void ycbcrToRgbRow(const uint8_t *yRow, const uint8_t *cbRow, const uint8_t *crRow, uint8_t *out, const int &width, const int &channels)
+{
+	int x = 0;
+#ifdef __SSE2__
+	// 14 bit fixed point coefficients, the inputs are pre-shifted by 2 so mulhi yields the product >> 14
+	const __m128i zero = _mm_setzero_si128(), center = _mm_set1_epi16(128);
+	const __m128i crR = _mm_set1_epi16(22970), cbG = _mm_set1_epi16(5638), crG = _mm_set1_epi16(11700), cbB = _mm_set1_epi16(29032);
+	alignas(16) uint8_t r[16], g[16], b[16];
+	for (; x + 8 <= width; x += 8)
+	{
+		__m128i Y = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(yRow + x)), zero);
+		__m128i cb = _mm_slli_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(cbRow + x)), zero), center), 2);
+		__m128i cr = _mm_slli_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(crRow + x)), zero), center), 2);
+
+		__m128i R = _mm_add_epi16(Y, _mm_mulhi_epi16(cr, crR));
+		__m128i G = _mm_sub_epi16(_mm_sub_epi16(Y, _mm_mulhi_epi16(cb, cbG)), _mm_mulhi_epi16(cr, crG));
+		__m128i B = _mm_add_epi16(Y, _mm_mulhi_epi16(cb, cbB));
+		_mm_storel_epi64((__m128i *)r, _mm_packus_epi16(R, R));
+		_mm_storel_epi64((__m128i *)g, _mm_packus_epi16(G, G));
+		_mm_storel_epi64((__m128i *)b, _mm_packus_epi16(B, B));
+
+		uint8_t *dst = out + (size_t)x * channels;
+		for (int i = 0; i < 8; i++, dst += channels)
+		{
+			dst[0] = r[i];
+			dst[1] = g[i];
+			dst[2] = b[i];
+			if (channels == 4)
+			{
+				dst[3] = 255;
+			}
+		}
+	}
+#endif
+	for (; x < width; x++)
+	{
+		int Y = yRow[x], cb = cbRow[x] - 128, cr = crRow[x] - 128;
+		int R = Y + ((cr * 22970) >> 14), G = Y - ((cb * 5638 + cr * 11700) >> 14), B = Y + ((cb * 29032) >> 14);
+		uint8_t *dst = out + (size_t)x * channels;
+		dst[0] = (uint8_t)min(max(R, 0), 255);
+		dst[1] = (uint8_t)min(max(G, 0), 255);
+		dst[2] = (uint8_t)min(max(B, 0), 255);
+		if (channels == 4)
+		{
+			dst[3] = 255;
+		}
+	}
+}
+
+static void convertRows(const JpegImage &image, uint8_t *out, const int &channels, const int &firstRow, const int &lastRow)
+{
+	const int width = image.width;
+	vector<uint8_t> scratch[3];
+	for (int y = firstRow; y < lastRow; y++)
+	{
+		uint8_t *dst = out + (size_t)y * width * channels;
+		const uint8_t *rows[3];
+		for (size_t c = 0; c < image.components.size(); c++)
+		{
+			rows[c] = sampleRow(image.components[c], image, y, scratch[c], width);
+		}
+
+		if (image.components.size() == 1 || channels <= 2)
+		{
+			// grey output takes luma as is
+			for (int x = 0; x < width; x++)
+			{
+				dst[x * channels] = rows[0][x];
+				if (channels == 2)
+				{
+					dst[x * channels + 1] = 255;
+				}
+				else if (channels >= 3)
+				{
+					dst[x * channels + 1] = dst[x * channels + 2] = rows[0][x];
+					if (channels == 4)
+					{
+						dst[x * channels + 3] = 255;
+					}
+				}
+			}
+			continue;
+		}
+
+		if (image.adobeRgb)
+		{
+			for (int x = 0; x < width; x++)
+			{
+				for (int c = 0; c < 3; c++)
+				{
+					dst[x * channels + c] = rows[c][x];
+				}
+				if (channels == 4)
+				{
+					dst[x * channels + 3] = 255;
+				}
+			}
+			continue;
+		}
+		ycbcrToRgbRow(rows[0], rows[1], rows[2], dst, width, channels);
+	}
+}
+
+// ---- public interface ----
+
+bool JpegDecoder::isJpeg(const unsigned char *data, const size_t &size)
+{
+	return size >= 4 && data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF;
+}
+
+unsigned char *JpegDecoder::decode(const unsigned char *data, const size_t &size, int *width, int *height, int *channels, const int &desiredChannels, const bool &parallel)
+{
+	unique_ptr<JpegImage> image(new JpegImage());
+	if (desiredChannels < 0 || desiredChannels > 4 || !parseHeaders(data, size, *image))
+	{
+		return NULL;
+	}
+	setupGeometry(*image);
+
+	bool ok = image->restartInterval > 0 ? decodeRestartIntervals(*image, parallel) : decodeSequential(*image, parallel);
+	if (!ok)
+	{
+		return NULL;
+	}
+
+	int outChannels = desiredChannels ? desiredChannels : (int)image->components.size();
+	unsigned char *pixels = (unsigned char *)malloc((size_t)image->width * image->height * outChannels);
+	if (!pixels)
+	{
+		return NULL;
+	}
+
+	const int tasks = (image->height + COLOR_ROWS_PER_TASK - 1) / COLOR_ROWS_PER_TASK;
+	runTasks(tasks, parallel, [&](int task)
+			 { convertRows(*image, pixels, outChannels, task * COLOR_ROWS_PER_TASK, min(image->height, (task + 1) * COLOR_ROWS_PER_TASK)); });
+
+	*width = image->width;
+	*height = image->height;
+	*channels = (int)image->components.size();
+	return pixels;
+}
+
+unsigned char *JpegDecoder::load(const char *path, int *width, int *height, int *channels, const int &desiredChannels, const bool &parallel)
+{
+	MappedFile file;
+	if (!file.open(path) || !isJpeg(file.data(), file.size()))
+	{
+		return NULL;
+	}
+	return decode(file.data(), file.size(), width, height, channels, desiredChannels, parallel);
+}
\ No newline at end of file
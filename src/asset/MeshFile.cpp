@@ -0,0 +1,298 @@
+#include "asset/MeshFile.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+
+static const char MAGIC[4] = {'L', 'M', 'S', 'H'};
+
+static uint64_t alignUp(const uint64_t &value, const uint64_t &alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+static float halfToFloat(const uint16_t &half)
+{
+	uint32_t sign = (uint32_t)(half & 0x8000) << 16, exponent = (half >> 10) & 0x1F, mantissa = half & 0x3FF;
+	uint32_t bits;
+	if (exponent == 0x1F)
+	{
+		bits = sign | 0x7F800000 | mantissa << 13;
+	}
+	else if (exponent != 0)
+	{
+		bits = sign | (exponent + 112) << 23 | mantissa << 13;
+	}
+	else
+	{
+		// zero or subnormal, exact in float
+		float value = ldexp((float)mantissa, -24);
+		return sign ? -value : value;
+	}
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+int MeshFile::componentSize(const uint32_t &type)
+{
+	switch (type)
+	{
+	case MESH_FLOAT32:
+		return 4;
+	case MESH_FLOAT16:
+	case MESH_INT16:
+	case MESH_UINT16:
+		return 2;
+	case MESH_INT8:
+	case MESH_UINT8:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+void MeshFile::readAttribute(const unsigned char *vertices, const uint32_t &stride, const MeshAttribute &attribute, const size_t &vertex, float out[4])
+{
+	const unsigned char *source = vertices + vertex * stride + attribute.offset;
+	for (uint32_t c = 0; c < 4; c++)
+	{
+		// the same defaults as an attribute GL fills up
+		out[c] = c == 3 ? 1.f : 0.f;
+	}
+	for (uint32_t c = 0; c < attribute.components && c < 4; c++)
+	{
+		const unsigned char *component = source + c * componentSize(attribute.type);
+		switch (attribute.type)
+		{
+		case MESH_FLOAT32:
+			memcpy(&out[c], component, 4);
+			break;
+		case MESH_FLOAT16:
+		{
+			uint16_t half;
+			memcpy(&half, component, 2);
+			out[c] = halfToFloat(half);
+			break;
+		}
+		case MESH_INT8:
+			out[c] = attribute.normalized ? max(-1.f, *(const int8_t *)component / 127.f) : *(const int8_t *)component;
+			break;
+		case MESH_UINT8:
+			out[c] = attribute.normalized ? *component / 255.f : *component;
+			break;
+		case MESH_INT16:
+		{
+			int16_t value;
+			memcpy(&value, component, 2);
+			out[c] = attribute.normalized ? max(-1.f, value / 32767.f) : value;
+			break;
+		}
+		case MESH_UINT16:
+		{
+			uint16_t value;
+			memcpy(&value, component, 2);
+			out[c] = attribute.normalized ? value / 65535.f : value;
+			break;
+		}
+		}
+	}
+}
+
+MeshBounds MeshFile::computeBounds(const MeshData &mesh)
+{
+	MeshBounds bounds = {};
+	auto position = find_if(mesh.attributes.begin(), mesh.attributes.end(), [](const MeshAttribute &attribute)
+							{ return attribute.location == POSITION_LOCATION; });
+	size_t vertexCount = mesh.stride ? mesh.vertices.size() / mesh.stride : 0;
+	if (position == mesh.attributes.end() || vertexCount == 0)
+	{
+		return bounds;
+	}
+
+	for (int c = 0; c < 3; c++)
+	{
+		bounds.min[c] = INFINITY;
+		bounds.max[c] = -INFINITY;
+	}
+	float p[4];
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		readAttribute(mesh.vertices.data(), mesh.stride, *position, v, p);
+		for (int c = 0; c < 3; c++)
+		{
+			p[c] = p[c] * mesh.dequantizeScale[c] + mesh.dequantizeOffset[c];
+			bounds.min[c] = min(bounds.min[c], p[c]);
+			bounds.max[c] = max(bounds.max[c], p[c]);
+		}
+	}
+
+	// centred on the box, a second pass finds the radius that actually encloses every vertex
+	float radius2 = 0.f;
+	for (int c = 0; c < 3; c++)
+	{
+		bounds.center[c] = (bounds.min[c] + bounds.max[c]) * 0.5f;
+	}
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		readAttribute(mesh.vertices.data(), mesh.stride, *position, v, p);
+		for (int c = 0; c < 3; c++)
+		{
+			p[c] = p[c] * mesh.dequantizeScale[c] + mesh.dequantizeOffset[c];
+		}
+		float dx = p[0] - bounds.center[0], dy = p[1] - bounds.center[1], dz = p[2] - bounds.center[2];
+		radius2 = max(radius2, dx * dx + dy * dy + dz * dz);
+	}
+	bounds.radius = sqrt(radius2);
+	return bounds;
+}
+
+bool MeshFile::write(const std::string &path, const MeshData &mesh)
+{
+	if (mesh.attributes.empty() || mesh.attributes.size() > MAX_ATTRIBUTES || mesh.lods.size() > MAX_LODS || mesh.stride == 0 ||
+		mesh.vertices.size() % mesh.stride != 0)
+	{
+		return false;
+	}
+
+	MeshFileHeader header = {};
+	memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = VERSION;
+	header.attributeCount = (uint32_t)mesh.attributes.size();
+	header.stride = mesh.stride;
+	header.vertexCount = (uint32_t)(mesh.vertices.size() / mesh.stride);
+	header.indexCount = (uint32_t)mesh.indices.size();
+	header.indexSize = header.vertexCount <= 0x10000 ? 2 : 4;
+	header.lodCount = (uint32_t)mesh.lods.size();
+	header.vertexOffset = alignUp(sizeof(header) + sizeof(MeshAttribute) * mesh.attributes.size() + sizeof(MeshLod) * mesh.lods.size(), DATA_ALIGNMENT);
+	header.indexOffset = alignUp(header.vertexOffset + mesh.vertices.size(), DATA_ALIGNMENT);
+	header.bounds = computeBounds(mesh);
+	memcpy(header.dequantizeScale, mesh.dequantizeScale, sizeof(header.dequantizeScale));
+	memcpy(header.dequantizeOffset, mesh.dequantizeOffset, sizeof(header.dequantizeOffset));
+
+	ofstream file(path, ios::binary | ios::trunc);
+	if (!file)
+	{
+		cout << "ERROR::MESH_FILE::CANNOT_WRITE " << path << endl;
+		return false;
+	}
+
+	static const char zeros[DATA_ALIGNMENT] = {};
+	file.write((const char *)&header, sizeof(header));
+	file.write((const char *)mesh.attributes.data(), sizeof(MeshAttribute) * mesh.attributes.size());
+	file.write((const char *)mesh.lods.data(), sizeof(MeshLod) * mesh.lods.size());
+	file.write(zeros, header.vertexOffset - (uint64_t)file.tellp());
+	file.write((const char *)mesh.vertices.data(), mesh.vertices.size());
+	file.write(zeros, header.indexOffset - (uint64_t)file.tellp());
+	if (header.indexSize == 2)
+	{
+		vector<uint16_t> narrow(mesh.indices.begin(), mesh.indices.end());
+		file.write((const char *)narrow.data(), narrow.size() * sizeof(uint16_t));
+	}
+	else
+	{
+		file.write((const char *)mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t));
+	}
+	return (bool)file;
+}
+
+bool MeshFile::parse(const unsigned char *data, const size_t &size, MeshFileView &view)
+{
+	if (size < sizeof(MeshFileHeader))
+	{
+		return false;
+	}
+
+	memcpy(&view.header, data, sizeof(MeshFileHeader));
+	const MeshFileHeader &header = view.header;
+	if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION || header.attributeCount == 0 ||
+		header.attributeCount > MAX_ATTRIBUTES || header.lodCount > MAX_LODS || header.stride == 0 || (header.indexSize != 2 && header.indexSize != 4))
+	{
+		return false;
+	}
+
+	// every range is checked by subtraction from the file size, hostile counts and offsets cannot wrap
+	size_t tableEnd = sizeof(MeshFileHeader) + sizeof(MeshAttribute) * header.attributeCount + sizeof(MeshLod) * header.lodCount;
+	if (size < tableEnd || header.vertexCount > size / header.stride || header.indexCount > size / header.indexSize)
+	{
+		return false;
+	}
+	view.vertexBytes = (size_t)header.vertexCount * header.stride;
+	view.indexBytes = (size_t)header.indexCount * header.indexSize;
+	if (header.vertexOffset < tableEnd || header.vertexOffset > size || view.vertexBytes > size - header.vertexOffset ||
+		header.indexOffset < header.vertexOffset + view.vertexBytes || header.indexOffset > size || view.indexBytes > size - header.indexOffset)
+	{
+		return false;
+	}
+
+	view.attributes.resize(header.attributeCount);
+	memcpy(view.attributes.data(), data + sizeof(MeshFileHeader), sizeof(MeshAttribute) * header.attributeCount);
+	for (const MeshAttribute &attribute : view.attributes)
+	{
+		if (componentSize(attribute.type) == 0 || attribute.components == 0 || attribute.components > 4 ||
+			attribute.offset > header.stride || attribute.components * componentSize(attribute.type) > header.stride - attribute.offset)
+		{
+			return false;
+		}
+	}
+	view.lods.resize(header.lodCount);
+	memcpy(view.lods.data(), data + sizeof(MeshFileHeader) + sizeof(MeshAttribute) * header.attributeCount, sizeof(MeshLod) * header.lodCount);
+	for (const MeshLod &lod : view.lods)
+	{
+		if ((uint64_t)lod.indexOffset + lod.indexCount > header.indexCount)
+		{
+			return false;
+		}
+	}
+
+	view.vertices = data + header.vertexOffset;
+	view.indices = data + header.indexOffset;
+	// GL is not asked for robust access, an index past the vertex buffer would be read by the draw
+	for (size_t i = 0; i < header.indexCount; i++)
+	{
+		uint32_t index;
+		if (header.indexSize == 2)
+		{
+			uint16_t narrow;
+			memcpy(&narrow, view.indices + i * 2, 2);
+			index = narrow;
+		}
+		else
+		{
+			memcpy(&index, view.indices + i * 4, 4);
+		}
+		if (index >= header.vertexCount)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void MeshFile::read(const MeshFileView &view, MeshData &mesh)
+{
+	mesh.attributes = view.attributes;
+	mesh.lods = view.lods;
+	mesh.stride = view.header.stride;
+	mesh.vertices.assign(view.vertices, view.vertices + view.vertexBytes);
+	mesh.indices.resize(view.header.indexCount);
+	for (size_t i = 0; i < mesh.indices.size(); i++)
+	{
+		if (view.header.indexSize == 2)
+		{
+			uint16_t index;
+			memcpy(&index, view.indices + i * 2, 2);
+			mesh.indices[i] = index;
+		}
+		else
+		{
+			memcpy(&mesh.indices[i], view.indices + i * 4, 4);
+		}
+	}
+	memcpy(mesh.dequantizeScale, view.header.dequantizeScale, sizeof(mesh.dequantizeScale));
+	memcpy(mesh.dequantizeOffset, view.header.dequantizeOffset, sizeof(mesh.dequantizeOffset));
+}
\ No newline at end of file
@@ -0,0 +1,316 @@
+#include "asset/MeshOptimizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+// triangles around every vertex, as offsets into one flat list
+struct Adjacency
+{
+	vector<uint32_t> offsets;
+	vector<uint32_t> triangles;
+};
+
+static void buildAdjacency(const vector<uint32_t> &indices, const size_t &vertexCount, Adjacency &adjacency)
+{
+	adjacency.offsets.assign(vertexCount + 1, 0);
+	for (uint32_t index : indices)
+	{
+		adjacency.offsets[index + 1]++;
+	}
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		adjacency.offsets[v + 1] += adjacency.offsets[v];
+	}
+	adjacency.triangles.resize(indices.size());
+	vector<uint32_t> fill(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+		adjacency.triangles[fill[indices[i]]++] = (uint32_t)(i / 3);
+	}
+}
+
+// FIFO post-transform cache: a vertex stays cached until cacheSize other vertices were loaded after it
+class CacheSimulator
+{
+private:
+	std::vector<size_t> m_loaded;
+	size_t m_time;
+	size_t m_size;
+
+public:
+	CacheSimulator(const size_t &vertexCount, const int &cacheSize) : m_loaded(vertexCount, 0), m_time(cacheSize + 1), m_size(cacheSize) {}
+
+	// misses of one triangle
+	int triangle(const uint32_t *indices)
+	{
+		int misses = 0;
+		for (int c = 0; c < 3; c++)
+		{
+			if (m_time - m_loaded[indices[c]] > m_size)
+			{
+				m_loaded[indices[c]] = m_time++;
+				misses++;
+			}
+		}
+		return misses;
+	}
+
+	void flush()
+	{
+		m_time += m_size + 1;
+	}
+};
+
+VertexCacheStats MeshOptimizer::analyzeVertexCache(const std::vector<uint32_t> &indices, const size_t &vertexCount, const int &cacheSize)
+{
+	VertexCacheStats stats = {0.f, 0.f};
+	if (indices.empty() || vertexCount == 0)
+	{
+		return stats;
+	}
+	CacheSimulator cache(vertexCount, cacheSize);
+	size_t misses = 0;
+	for (size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		misses += cache.triangle(&indices[i]);
+	}
+	stats.acmr = (float)misses / (indices.size() / 3);
+	stats.atvr = (float)misses / vertexCount;
+	return stats;
+}
+
+void MeshOptimizer::optimizeVertexCache(std::vector<uint32_t> &indices, const size_t &vertexCount, const int &cacheSize, std::vector<uint32_t> *clusterStarts)
+{
+	size_t triangleCount = indices.size() / 3;
+	if (clusterStarts)
+	{
+		clusterStarts->assign(1, 0);
+	}
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	Adjacency adjacency;
+	buildAdjacency(indices, vertexCount, adjacency);
+	vector<uint32_t> live(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		live[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+	}
+	// time each vertex last entered the cache
+	vector<int64_t> cached(vertexCount, 0);
+	vector<char> emitted(triangleCount, 0);
+	vector<uint32_t> deadEnds;
+	vector<uint32_t> candidates;
+	vector<uint32_t> result;
+	result.reserve(indices.size());
+
+	int64_t time = cacheSize + 1;
+	size_t cursor = 0;
+	int64_t fan = 0;
+	while (fan >= 0)
+	{
+		candidates.clear();
+		for (uint32_t a = adjacency.offsets[fan]; a < adjacency.offsets[fan + 1]; a++)
+		{
+			uint32_t triangle = adjacency.triangles[a];
+			if (emitted[triangle])
+			{
+				continue;
+			}
+			for (int c = 0; c < 3; c++)
+			{
+				uint32_t v = indices[triangle * 3 + c];
+				result.push_back(v);
+				deadEnds.push_back(v);
+				candidates.push_back(v);
+				live[v]--;
+				if (time - cached[v] > cacheSize)
+				{
+					cached[v] = time++;
+				}
+			}
+			emitted[triangle] = 1;
+		}
+
+		// the next fan is the candidate that will still be cached after its remaining triangles
+		// are emitted, oldest first, so it is used before it would drop out
+		int64_t next = -1, best = -1;
+		for (uint32_t v : candidates)
+		{
+			if (live[v] == 0)
+			{
+				continue;
+			}
+			int64_t priority = 0;
+			if (time - cached[v] + 2 * (int64_t)live[v] <= cacheSize)
+			{
+				priority = time - cached[v];
+			}
+			if (priority > best)
+			{
+				best = priority;
+				next = v;
+			}
+		}
+		if (next >= 0)
+		{
+			fan = next;
+			continue;
+		}
+
+		// dead end: a recently used vertex with work left, otherwise the next one in input order
+		fan = -1;
+		while (!deadEnds.empty() && fan < 0)
+		{
+			uint32_t v = deadEnds.back();
+			deadEnds.pop_back();
+			if (live[v] > 0)
+			{
+				fan = v;
+			}
+		}
+		while (fan < 0 && cursor < vertexCount)
+		{
+			if (live[cursor] > 0)
+			{
+				fan = (int64_t)cursor;
+			}
+			cursor++;
+		}
+		// nothing of the current neighbourhood is left in the cache, a cluster boundary
+		if (fan >= 0 && clusterStarts && result.size() / 3 > clusterStarts->back())
+		{
+			clusterStarts->push_back((uint32_t)(result.size() / 3));
+		}
+	}
+	indices.swap(result);
+}
+
+void MeshOptimizer::optimizeOverdraw(const MeshData &mesh, std::vector<uint32_t> &indices, const std::vector<uint32_t> &clusterStarts,
+									 const int &cacheSize, const float &threshold)
+{
+	size_t triangleCount = indices.size() / 3;
+	size_t vertexCount = mesh.stride ? mesh.vertices.size() / mesh.stride : 0;
+	auto position = find_if(mesh.attributes.begin(), mesh.attributes.end(), [](const MeshAttribute &attribute)
+							{ return attribute.location == MeshFile::POSITION_LOCATION; });
+	if (triangleCount == 0 || position == mesh.attributes.end())
+	{
+		return;
+	}
+
+	// clusters may be cut further wherever the cache has warmed up enough that a restart costs little
+	float meshAcmr = analyzeVertexCache(indices, vertexCount, cacheSize).acmr;
+	vector<uint32_t> starts;
+	CacheSimulator cache(vertexCount, cacheSize);
+	for (size_t c = 0; c < clusterStarts.size(); c++)
+	{
+		size_t begin = clusterStarts[c], end = c + 1 < clusterStarts.size() ? clusterStarts[c + 1] : triangleCount;
+		starts.push_back((uint32_t)begin);
+		size_t clusterBegin = begin, misses = 0;
+		// every cluster starts cold, as it will once the clusters are moved around
+		cache.flush();
+		for (size_t t = begin; t < end; t++)
+		{
+			misses += cache.triangle(&indices[t * 3]);
+			if (t + 1 < end && (float)misses / (t + 1 - clusterBegin) <= meshAcmr * threshold)
+			{
+				starts.push_back((uint32_t)(t + 1));
+				clusterBegin = t + 1;
+				misses = 0;
+				cache.flush();
+			}
+		}
+	}
+
+	vector<float> positions(vertexCount * 3);
+	float value[4], center[3] = {0.f, 0.f, 0.f};
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		MeshFile::readAttribute(mesh.vertices.data(), mesh.stride, *position, v, value);
+		for (int c = 0; c < 3; c++)
+		{
+			positions[v * 3 + c] = value[c] * mesh.dequantizeScale[c] + mesh.dequantizeOffset[c];
+			center[c] += positions[v * 3 + c] / vertexCount;
+		}
+	}
+
+	// how far a cluster sits out from the centre along its own facing, outer ones are drawn first
+	vector<pair<float, uint32_t>> order;
+	for (size_t c = 0; c < starts.size(); c++)
+	{
+		size_t begin = starts[c], end = c + 1 < starts.size() ? starts[c + 1] : triangleCount;
+		float centroid[3] = {0.f, 0.f, 0.f}, normal[3] = {0.f, 0.f, 0.f}, area = 0.f;
+		for (size_t t = begin; t < end; t++)
+		{
+			const float *a = &positions[indices[t * 3] * 3], *b = &positions[indices[t * 3 + 1] * 3], *d = &positions[indices[t * 3 + 2] * 3];
+			float e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]}, e2[3] = {d[0] - a[0], d[1] - a[1], d[2] - a[2]};
+			float n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+			float weight = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+			for (int k = 0; k < 3; k++)
+			{
+				centroid[k] += (a[k] + b[k] + d[k]) / 3.f * weight;
+				normal[k] += n[k];
+			}
+			area += weight;
+		}
+		float length = sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		float key = 0.f;
+		if (area > 0.f && length > 0.f)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				key += (centroid[k] / area - center[k]) * normal[k] / length;
+			}
+		}
+		order.emplace_back(-key, (uint32_t)c);
+	}
+	stable_sort(order.begin(), order.end(), [](const pair<float, uint32_t> &a, const pair<float, uint32_t> &b)
+				{ return a.first < b.first; });
+
+	vector<uint32_t> result;
+	result.reserve(indices.size());
+	for (const auto &cluster : order)
+	{
+		size_t begin = starts[cluster.second], end = cluster.second + 1 < starts.size() ? starts[cluster.second + 1] : triangleCount;
+		result.insert(result.end(), indices.begin() + begin * 3, indices.begin() + end * 3);
+	}
+	indices.swap(result);
+}
+
+void MeshOptimizer::optimizeVertexFetch(MeshData &mesh)
+{
+	size_t vertexCount = mesh.stride ? mesh.vertices.size() / mesh.stride : 0;
+	vector<uint32_t> remap(vertexCount, ~0u);
+	vector<unsigned char> vertices;
+	vertices.reserve(mesh.vertices.size());
+	uint32_t next = 0;
+	for (uint32_t &index : mesh.indices)
+	{
+		if (remap[index] == ~0u)
+		{
+			remap[index] = next++;
+			vertices.insert(vertices.end(), mesh.vertices.begin() + (size_t)index * mesh.stride, mesh.vertices.begin() + ((size_t)index + 1) * mesh.stride);
+		}
+		index = remap[index];
+	}
+	mesh.vertices.swap(vertices);
+}
+
+void MeshOptimizer::optimize(MeshData &mesh, const OptimizeOptions &options)
+{
+	size_t vertexCount = mesh.stride ? mesh.vertices.size() / mesh.stride : 0;
+	vector<uint32_t> clusterStarts;
+	optimizeVertexCache(mesh.indices, vertexCount, options.cacheSize, &clusterStarts);
+	if (options.overdraw)
+	{
+		optimizeOverdraw(mesh, mesh.indices, clusterStarts, options.cacheSize, options.overdrawThreshold);
+	}
+	if (options.fetch)
+	{
+		optimizeVertexFetch(mesh);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,248 @@
+#include "asset/MeshQuantizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+static const uint32_t COLOR_LOCATION = 1;
+static const uint32_t TEXCOORD_LOCATION = 2;
+static const uint32_t NORMAL_LOCATION = 4;
+
+// round to nearest even, overflow to infinity, underflow through the subnormals
+static uint16_t floatToHalf(const float &value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	uint32_t sign = (bits >> 16) & 0x8000, exponent = (bits >> 23) & 0xFF, mantissa = bits & 0x7FFFFF;
+	if (exponent == 0xFF)
+	{
+		return (uint16_t)(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+	}
+	int halfExponent = (int)exponent - 127 + 15;
+	if (halfExponent >= 0x1F)
+	{
+		return (uint16_t)(sign | 0x7C00);
+	}
+	if (halfExponent <= 0)
+	{
+		if (halfExponent < -10)
+		{
+			return (uint16_t)sign;
+		}
+		mantissa |= 0x800000;
+		int shift = 14 - halfExponent;
+		uint32_t half = mantissa >> shift, rest = mantissa & ((1u << shift) - 1), halfway = 1u << (shift - 1);
+		if (rest > halfway || (rest == halfway && (half & 1)))
+		{
+			half++;
+		}
+		return (uint16_t)(sign | half);
+	}
+	uint32_t half = sign | (uint32_t)halfExponent << 10 | mantissa >> 13, rest = mantissa & 0x1FFF;
+	// a carry out of the mantissa correctly bumps the exponent
+	if (rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+	{
+		half++;
+	}
+	return (uint16_t)half;
+}
+
+template <typename T>
+static void store(unsigned char *target, const T &value)
+{
+	memcpy(target, &value, sizeof(T));
+}
+
+static void encode(const float value[4], const MeshAttribute &attribute, unsigned char *target)
+{
+	for (uint32_t c = 0; c < attribute.components; c++)
+	{
+		float v = value[c];
+		switch (attribute.type)
+		{
+		case MESH_FLOAT32:
+			store(target + c * 4, v);
+			break;
+		case MESH_FLOAT16:
+			store(target + c * 2, floatToHalf(v));
+			break;
+		case MESH_UINT8:
+			target[c] = (unsigned char)lround(attribute.normalized ? min(max(v, 0.f), 1.f) * 255.f : min(max(v, 0.f), 255.f));
+			break;
+		case MESH_INT8:
+			target[c] = (unsigned char)(int8_t)lround(attribute.normalized ? min(max(v, -1.f), 1.f) * 127.f : min(max(v, -128.f), 127.f));
+			break;
+		case MESH_UINT16:
+			store(target + c * 2, (uint16_t)lround(attribute.normalized ? min(max(v, 0.f), 1.f) * 65535.f : min(max(v, 0.f), 65535.f)));
+			break;
+		case MESH_INT16:
+			store(target + c * 2, (int16_t)lround(attribute.normalized ? min(max(v, -1.f), 1.f) * 32767.f : min(max(v, -32768.f), 32767.f)));
+			break;
+		}
+	}
+}
+
+// the attribute in its own units, positions moved back into mesh space
+static void decode(const MeshData &mesh, const MeshAttribute &attribute, const size_t &vertex, float value[4])
+{
+	MeshFile::readAttribute(mesh.vertices.data(), mesh.stride, attribute, vertex, value);
+	if (attribute.location == MeshFile::POSITION_LOCATION)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			value[c] = value[c] * mesh.dequantizeScale[c] + mesh.dequantizeOffset[c];
+		}
+	}
+}
+
+bool MeshQuantizer::parseFormat(const std::string &name, QuantizeOptions &options)
+{
+	options = QuantizeOptions();
+	if (name == "float")
+	{
+		options.position = QUANTIZE_POSITION_FLOAT;
+		options.colors = options.texcoords = options.normals = false;
+		return true;
+	}
+	if (name == "half")
+	{
+		options.position = QUANTIZE_POSITION_HALF;
+		return true;
+	}
+	return name == "int16";
+}
+
+void MeshQuantizer::quantize(const MeshData &source, const QuantizeOptions &options, MeshData &quantized)
+{
+	size_t vertexCount = source.stride ? source.vertices.size() / source.stride : 0;
+	quantized = MeshData();
+	quantized.indices = source.indices;
+	quantized.lods = source.lods;
+
+	// texcoords only fit unorm16 when every one is inside [0, 1]
+	bool texcoordsInRange = true;
+	for (const MeshAttribute &attribute : source.attributes)
+	{
+		if (attribute.location != TEXCOORD_LOCATION)
+		{
+			continue;
+		}
+		float value[4];
+		for (size_t v = 0; v < vertexCount && texcoordsInRange; v++)
+		{
+			decode(source, attribute, v, value);
+			for (uint32_t c = 0; c < attribute.components; c++)
+			{
+				texcoordsInRange &= value[c] >= 0.f && value[c] <= 1.f;
+			}
+		}
+	}
+
+	uint32_t offset = 0;
+	for (const MeshAttribute &attribute : source.attributes)
+	{
+		MeshAttribute target = attribute;
+		if (attribute.location == MeshFile::POSITION_LOCATION && options.position != QUANTIZE_POSITION_FLOAT)
+		{
+			target.type = options.position == QUANTIZE_POSITION_HALF ? MESH_FLOAT16 : MESH_INT16;
+			target.normalized = 0;
+		}
+		else if (attribute.location == COLOR_LOCATION && options.colors)
+		{
+			target.type = MESH_UINT8;
+			target.normalized = 1;
+		}
+		else if (attribute.location == TEXCOORD_LOCATION && options.texcoords)
+		{
+			target.type = texcoordsInRange ? MESH_UINT16 : MESH_FLOAT16;
+			target.normalized = texcoordsInRange ? 1 : 0;
+		}
+		else if (attribute.location == NORMAL_LOCATION && options.normals)
+		{
+			// the signed normalization rule changed in GL 4.2, the two differ by less than 2e-5 here
+			// and normals are renormalized anyway
+			target.type = MESH_INT16;
+			target.normalized = 1;
+		}
+		target.offset = offset;
+		offset += (target.components * MeshFile::componentSize(target.type) + 3) & ~3u;
+		quantized.attributes.push_back(target);
+	}
+	quantized.stride = offset;
+	quantized.vertices.assign(vertexCount * quantized.stride, 0);
+
+	// positions are mapped onto [-1, 1] around the bounds centre, per axis
+	MeshBounds bounds = MeshFile::computeBounds(source);
+	float extent[3];
+	for (int c = 0; c < 3; c++)
+	{
+		extent[c] = (bounds.max[c] - bounds.min[c]) * 0.5f;
+		if (!(extent[c] > 0.f))
+		{
+			// flat along this axis, every position quantizes to the centre
+			extent[c] = 1.f;
+		}
+	}
+	if (options.position != QUANTIZE_POSITION_FLOAT)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			quantized.dequantizeOffset[c] = bounds.center[c];
+			quantized.dequantizeScale[c] = options.position == QUANTIZE_POSITION_HALF ? extent[c] : extent[c] / 32767.f;
+		}
+	}
+
+	float value[4];
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		for (size_t a = 0; a < source.attributes.size(); a++)
+		{
+			const MeshAttribute &attribute = quantized.attributes[a];
+			decode(source, source.attributes[a], v, value);
+			if (attribute.location == MeshFile::POSITION_LOCATION)
+			{
+				for (int c = 0; c < 3; c++)
+				{
+					value[c] = (value[c] - quantized.dequantizeOffset[c]) / quantized.dequantizeScale[c];
+				}
+			}
+			encode(value, attribute, &quantized.vertices[v * quantized.stride + attribute.offset]);
+		}
+	}
+}
+
+void MeshQuantizer::measure(const MeshData &original, const MeshData &quantized, std::vector<QuantizeError> &errors)
+{
+	errors.clear();
+	size_t vertexCount = original.stride ? original.vertices.size() / original.stride : 0;
+	for (const MeshAttribute &before : original.attributes)
+	{
+		auto after = find_if(quantized.attributes.begin(), quantized.attributes.end(), [&before](const MeshAttribute &attribute)
+							 { return attribute.location == before.location; });
+		if (after == quantized.attributes.end())
+		{
+			continue;
+		}
+
+		QuantizeError error = {before.location, before.components * MeshFile::componentSize(before.type),
+							   after->components * MeshFile::componentSize(after->type), 0.f, 0.f};
+		double sum = 0.0;
+		float a[4], b[4];
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			decode(original, before, v, a);
+			decode(quantized, *after, v, b);
+			float distance2 = 0.f;
+			for (uint32_t c = 0; c < before.components; c++)
+			{
+				distance2 += (a[c] - b[c]) * (a[c] - b[c]);
+			}
+			error.maxError = max(error.maxError, sqrt(distance2));
+			sum += distance2;
+		}
+		error.rmsError = vertexCount ? (float)sqrt(sum / vertexCount) : 0.f;
+		errors.push_back(error);
+	}
+}
\ No newline at end of file
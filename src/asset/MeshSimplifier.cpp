@@ -0,0 +1,468 @@
+#include "asset/MeshSimplifier.hpp"
+#include "asset/MeshOptimizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+using namespace std;
+
+enum VERTEX_KINDS
+{
+	// closed surface all around, collapses onto any neighbour
+	VERTEX_MANIFOLD = 0,
+	// on an open edge of the mesh, collapses along it
+	VERTEX_BORDER = 1,
+	// one of two vertices sharing a position across an attribute seam, both collapse along the seam
+	VERTEX_SEAM = 2,
+	VERTEX_LOCKED = 3
+};
+
+// open edges keep their shape this much more strongly than the surface around them
+static const double BORDER_WEIGHT = 10.0;
+static const int MAX_PASSES = 100;
+
+// the planes around a vertex: squared distance = p^T A p + 2 b.p + c, summed weighted by area
+struct Quadric
+{
+	double a00, a01, a02, a11, a12, a22;
+	double b0, b1, b2;
+	double c;
+	double weight;
+};
+
+struct Collapse
+{
+	uint32_t from;
+	uint32_t to;
+	// the seam twins collapsing with them, ~0u for none
+	uint32_t twinFrom;
+	uint32_t twinTo;
+	double cost;
+};
+
+struct PositionHash
+{
+	size_t operator()(const array<uint32_t, 3> &p) const
+	{
+		return (size_t)p[0] * 73856093u ^ (size_t)p[1] * 19349663u ^ (size_t)p[2] * 83492791u;
+	}
+};
+
+// the triangles around every vertex of a triangle list, as offsets into one flat list. An edge is
+// open when no triangle runs it the other way.
+class VertexTriangles
+{
+private:
+	const vector<uint32_t> &m_indices;
+	vector<uint32_t> m_offsets;
+	vector<uint32_t> m_triangles;
+
+	bool has(const uint32_t &a, const uint32_t &b) const
+	{
+		for (uint32_t o = m_offsets[a]; o < m_offsets[a + 1]; o++)
+		{
+			const uint32_t *corners = &m_indices[m_triangles[o] * 3];
+			if ((corners[0] == a && corners[1] == b) || (corners[1] == a && corners[2] == b) || (corners[2] == a && corners[0] == b))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+public:
+	VertexTriangles(const vector<uint32_t> &indices, const size_t &vertexCount) : m_indices(indices), m_offsets(vertexCount + 1, 0)
+	{
+		for (uint32_t index : indices)
+		{
+			m_offsets[index + 1]++;
+		}
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			m_offsets[v + 1] += m_offsets[v];
+		}
+		m_triangles.resize(indices.size());
+		vector<uint32_t> fill(m_offsets.begin(), m_offsets.end() - 1);
+		for (size_t i = 0; i < indices.size(); i++)
+		{
+			m_triangles[fill[indices[i]]++] = (uint32_t)(i / 3);
+		}
+	}
+
+	uint32_t begin(const uint32_t &v) const
+	{
+		return m_offsets[v];
+	}
+
+	uint32_t end(const uint32_t &v) const
+	{
+		return m_offsets[v + 1];
+	}
+
+	uint32_t triangle(const uint32_t &o) const
+	{
+		return m_triangles[o];
+	}
+
+	bool open(const uint32_t &a, const uint32_t &b) const
+	{
+		return has(a, b) && !has(b, a);
+	}
+
+	// open in either direction
+	bool border(const uint32_t &a, const uint32_t &b) const
+	{
+		return open(a, b) || open(b, a);
+	}
+};
+
+static void addPlane(Quadric &q, const double n[3], const double &d, const double &weight)
+{
+	q.a00 += weight * n[0] * n[0];
+	q.a01 += weight * n[0] * n[1];
+	q.a02 += weight * n[0] * n[2];
+	q.a11 += weight * n[1] * n[1];
+	q.a12 += weight * n[1] * n[2];
+	q.a22 += weight * n[2] * n[2];
+	q.b0 += weight * n[0] * d;
+	q.b1 += weight * n[1] * d;
+	q.b2 += weight * n[2] * d;
+	q.c += weight * d * d;
+	q.weight += weight;
+}
+
+static void addQuadric(Quadric &q, const Quadric &other)
+{
+	q.a00 += other.a00;
+	q.a01 += other.a01;
+	q.a02 += other.a02;
+	q.a11 += other.a11;
+	q.a12 += other.a12;
+	q.a22 += other.a22;
+	q.b0 += other.b0;
+	q.b1 += other.b1;
+	q.b2 += other.b2;
+	q.c += other.c;
+	q.weight += other.weight;
+}
+
+// mean squared distance of p to the planes
+static double evaluate(const Quadric &q, const float p[3])
+{
+	double x = p[0], y = p[1], z = p[2];
+	double error = q.a00 * x * x + q.a11 * y * y + q.a22 * z * z + 2.0 * (q.a01 * x * y + q.a02 * x * z + q.a12 * y * z) +
+				   2.0 * (q.b0 * x + q.b1 * y + q.b2 * z) + q.c;
+	return q.weight > 0.0 ? fabs(error) / q.weight : 0.0;
+}
+
+static void cross(const double a[3], const double b[3], double out[3])
+{
+	out[0] = a[1] * b[2] - a[2] * b[1];
+	out[1] = a[2] * b[0] - a[0] * b[2];
+	out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+static void triangleNormal(const float *p0, const float *p1, const float *p2, double out[3])
+{
+	double e1[3] = {(double)p1[0] - p0[0], (double)p1[1] - p0[1], (double)p1[2] - p0[2]};
+	double e2[3] = {(double)p2[0] - p0[0], (double)p2[1] - p0[1], (double)p2[2] - p0[2]};
+	cross(e1, e2, out);
+}
+
+// whether the vertex may collapse onto the other end of one of its edges, and which seam twins have to follow it
+static bool collapseAllowed(const vector<unsigned char> &kinds, const vector<uint32_t> &ring, const VertexTriangles &edges, const uint32_t &from,
+							const uint32_t &to, uint32_t &twinFrom, uint32_t &twinTo)
+{
+	twinFrom = twinTo = ~0u;
+	switch (kinds[from])
+	{
+	case VERTEX_MANIFOLD:
+		return true;
+	case VERTEX_BORDER:
+		return edges.border(from, to);
+	case VERTEX_SEAM:
+		if (!edges.border(from, to) || kinds[to] == VERTEX_MANIFOLD || kinds[to] == VERTEX_BORDER)
+		{
+			return false;
+		}
+		// the twin has to move along the other side of the same seam edge
+		twinFrom = ring[from];
+		for (uint32_t twin = ring[to]; twin != to; twin = ring[twin])
+		{
+			if (edges.border(twinFrom, twin))
+			{
+				twinTo = twin;
+				return true;
+			}
+		}
+		return false;
+	default:
+		return false;
+	}
+}
+
+float MeshSimplifier::simplify(const MeshData &mesh, const std::vector<uint32_t> &indices, const size_t &targetIndexCount, const float &maxError,
+							   std::vector<uint32_t> &result)
+{
+	result = indices;
+	size_t vertexCount = mesh.stride ? mesh.vertices.size() / mesh.stride : 0;
+	auto position = find_if(mesh.attributes.begin(), mesh.attributes.end(), [](const MeshAttribute &attribute)
+							{ return attribute.location == MeshFile::POSITION_LOCATION; });
+	if (position == mesh.attributes.end() || result.size() <= targetIndexCount)
+	{
+		return 0.f;
+	}
+
+	// vertices sharing a position are linked into a ring and welded to the first of them
+	vector<float> positions(vertexCount * 3);
+	vector<uint32_t> weld(vertexCount), ring(vertexCount);
+	unordered_map<array<uint32_t, 3>, uint32_t, PositionHash> welded;
+	welded.reserve(vertexCount);
+	float value[4];
+	for (uint32_t v = 0; v < vertexCount; v++)
+	{
+		MeshFile::readAttribute(mesh.vertices.data(), mesh.stride, *position, v, value);
+		array<uint32_t, 3> key;
+		for (int c = 0; c < 3; c++)
+		{
+			// + 0 folds -0 into 0
+			positions[v * 3 + c] = value[c] * mesh.dequantizeScale[c] + mesh.dequantizeOffset[c] + 0.f;
+			memcpy(&key[c], &positions[v * 3 + c], sizeof(float));
+		}
+		auto inserted = welded.emplace(key, v);
+		uint32_t first = inserted.first->second;
+		weld[v] = first;
+		ring[v] = inserted.second ? v : ring[first];
+		ring[first] = v;
+	}
+
+	// classify by the open edges around each vertex and its twins
+	vector<unsigned char> kinds(vertexCount, VERTEX_LOCKED);
+	vector<Quadric> quadrics(vertexCount, Quadric());
+	{
+		VertexTriangles edges(result, vertexCount);
+		vector<uint32_t> openOut(vertexCount, 0), openIn(vertexCount, 0), outTarget(vertexCount), inSource(vertexCount);
+		for (size_t i = 0; i < result.size(); i += 3)
+		{
+			const uint32_t *corners = &result[i];
+			double n[3];
+			triangleNormal(&positions[corners[0] * 3], &positions[corners[1] * 3], &positions[corners[2] * 3], n);
+			double length = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+			if (length > 0.0)
+			{
+				for (int c = 0; c < 3; c++)
+				{
+					n[c] /= length;
+				}
+				const float *p0 = &positions[corners[0] * 3];
+				double d = -(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]);
+				for (int k = 0; k < 3; k++)
+				{
+					addPlane(quadrics[weld[corners[k]]], n, d, length * 0.5);
+				}
+			}
+
+			for (int k = 0; k < 3; k++)
+			{
+				uint32_t a = corners[k], b = corners[(k + 1) % 3];
+				if (!edges.open(a, b))
+				{
+					continue;
+				}
+				openOut[a]++;
+				outTarget[a] = b;
+				openIn[b]++;
+				inSource[b] = a;
+
+				// a plane through the edge, perpendicular to the triangle, holds the border in place
+				const float *pa = &positions[a * 3], *pb = &positions[b * 3];
+				double edge[3] = {(double)pb[0] - pa[0], (double)pb[1] - pa[1], (double)pb[2] - pa[2]}, m[3];
+				cross(edge, n, m);
+				double edgeLength = sqrt(m[0] * m[0] + m[1] * m[1] + m[2] * m[2]);
+				if (length == 0.0 || edgeLength == 0.0)
+				{
+					continue;
+				}
+				for (int c = 0; c < 3; c++)
+				{
+					m[c] /= edgeLength;
+				}
+				double dm = -(m[0] * pa[0] + m[1] * pa[1] + m[2] * pa[2]);
+				double weight = (edge[0] * edge[0] + edge[1] * edge[1] + edge[2] * edge[2]) * BORDER_WEIGHT;
+				addPlane(quadrics[weld[a]], m, dm, weight);
+				addPlane(quadrics[weld[b]], m, dm, weight);
+			}
+		}
+
+		for (uint32_t v = 0; v < vertexCount; v++)
+		{
+			uint32_t twin = ring[v];
+			if (twin == v)
+			{
+				kinds[v] = openOut[v] == 0 && openIn[v] == 0 ? VERTEX_MANIFOLD : openOut[v] == 1 && openIn[v] == 1 ? VERTEX_BORDER : VERTEX_LOCKED;
+			}
+			else if (ring[twin] == v && openOut[v] == 1 && openIn[v] == 1 && openOut[twin] == 1 && openIn[twin] == 1 &&
+					 weld[outTarget[v]] == weld[inSource[twin]] && weld[inSource[v]] == weld[outTarget[twin]])
+			{
+				// exactly two sides whose open edges run along each other
+				kinds[v] = VERTEX_SEAM;
+			}
+		}
+	}
+
+	vector<uint32_t> collapse(vertexCount);
+	vector<unsigned char> touched(vertexCount);
+	vector<Collapse> candidates;
+	double maxCost = (double)maxError * maxError, reached = 0.0;
+	for (int pass = 0; pass < MAX_PASSES && result.size() > targetIndexCount; pass++)
+	{
+		VertexTriangles edges(result, vertexCount);
+
+		candidates.clear();
+		for (size_t i = 0; i < result.size(); i++)
+		{
+			uint32_t a = result[i], b = result[i % 3 == 2 ? i - 2 : i + 1];
+			for (int direction = 0; direction < 2; direction++, swap(a, b))
+			{
+				Collapse candidate = {a, b, ~0u, ~0u, 0.0};
+				if (weld[a] == weld[b] || !collapseAllowed(kinds, ring, edges, a, b, candidate.twinFrom, candidate.twinTo))
+				{
+					continue;
+				}
+				Quadric q = quadrics[weld[a]];
+				addQuadric(q, quadrics[weld[b]]);
+				candidate.cost = evaluate(q, &positions[b * 3]);
+				if (candidate.cost <= maxCost)
+				{
+					candidates.push_back(candidate);
+				}
+			}
+		}
+		sort(candidates.begin(), candidates.end(), [](const Collapse &a, const Collapse &b)
+			 { return a.cost < b.cost; });
+
+		// counts the triangles the collapse removes, false if any remaining one would flip over
+		auto keepsOrientation = [&](const uint32_t &from, const uint32_t &to, size_t &removed)
+		{
+			const float *target = &positions[to * 3];
+			for (uint32_t o = edges.begin(from); o < edges.end(from); o++)
+			{
+				const uint32_t *corners = &result[edges.triangle(o) * 3];
+				int k = corners[0] == from ? 0 : corners[1] == from ? 1 : 2;
+				uint32_t next = corners[(k + 1) % 3], last = corners[(k + 2) % 3];
+				if (weld[next] == weld[to] || weld[last] == weld[to])
+				{
+					removed++;
+					continue;
+				}
+				double before[3], after[3];
+				triangleNormal(&positions[from * 3], &positions[next * 3], &positions[last * 3], before);
+				triangleNormal(target, &positions[next * 3], &positions[last * 3], after);
+				if (before[0] * after[0] + before[1] * after[1] + before[2] * after[2] <= 0.0)
+				{
+					return false;
+				}
+			}
+			return true;
+		};
+		// the neighbourhood of a collapse stays put for the rest of the pass, so the flip test above holds
+		auto lockAround = [&](const uint32_t &from)
+		{
+			for (uint32_t o = edges.begin(from); o < edges.end(from); o++)
+			{
+				const uint32_t *corners = &result[edges.triangle(o) * 3];
+				for (int k = 0; k < 3; k++)
+				{
+					touched[weld[corners[k]]] = 1;
+				}
+			}
+		};
+
+		for (uint32_t v = 0; v < vertexCount; v++)
+		{
+			collapse[v] = v;
+		}
+		touched.assign(vertexCount, 0);
+		size_t goal = (result.size() - targetIndexCount) / 3, removed = 0, collapses = 0;
+		for (const Collapse &candidate : candidates)
+		{
+			if (removed >= goal)
+			{
+				break;
+			}
+			uint32_t from = weld[candidate.from], to = weld[candidate.to];
+			size_t degenerate = 0;
+			if (touched[from] || touched[to] || !keepsOrientation(candidate.from, candidate.to, degenerate) ||
+				(candidate.twinFrom != ~0u && !keepsOrientation(candidate.twinFrom, candidate.twinTo, degenerate)))
+			{
+				continue;
+			}
+			collapse[candidate.from] = candidate.to;
+			lockAround(candidate.from);
+			if (candidate.twinFrom != ~0u)
+			{
+				collapse[candidate.twinFrom] = candidate.twinTo;
+				lockAround(candidate.twinFrom);
+			}
+			addQuadric(quadrics[to], quadrics[from]);
+			removed += degenerate;
+			reached = max(reached, candidate.cost);
+			collapses++;
+		}
+		if (collapses == 0)
+		{
+			break;
+		}
+
+		size_t write = 0;
+		for (size_t i = 0; i < result.size(); i += 3)
+		{
+			uint32_t a = collapse[result[i]], b = collapse[result[i + 1]], c = collapse[result[i + 2]];
+			if (weld[a] != weld[b] && weld[b] != weld[c] && weld[c] != weld[a])
+			{
+				result[write++] = a;
+				result[write++] = b;
+				result[write++] = c;
+			}
+		}
+		result.resize(write);
+	}
+	return (float)sqrt(reached);
+}
+
+void MeshSimplifier::buildLods(MeshData &mesh, const LodOptions &options)
+{
+	mesh.lods.clear();
+	size_t vertexCount = mesh.stride ? mesh.vertices.size() / mesh.stride : 0;
+	if (mesh.indices.empty() || vertexCount == 0)
+	{
+		return;
+	}
+
+	float budget = options.maxError * MeshFile::computeBounds(mesh).radius, error = 0.f;
+	mesh.lods.push_back({0, (uint32_t)mesh.indices.size(), 0.f});
+	vector<uint32_t> level = mesh.indices, next;
+	while ((int)mesh.lods.size() < options.maxLevels && level.size() / 3 > options.minTriangles && error < budget)
+	{
+		size_t target = (size_t)(level.size() / 3 * options.ratio) * 3;
+		float levelError = simplify(mesh, level, target, budget - error, next);
+		// a level that saves less than a tenth is not worth its memory, simplification is stuck on locked vertices
+		if (next.empty() || next.size() * 10 > level.size() * 9)
+		{
+			break;
+		}
+		MeshOptimizer::optimizeVertexCache(next, vertexCount, options.cacheSize);
+		// each level is measured against the one before it, so the distance to the full mesh adds up
+		error += levelError;
+		mesh.lods.push_back({(uint32_t)mesh.indices.size(), (uint32_t)next.size(), error});
+		mesh.indices.insert(mesh.indices.end(), next.begin(), next.end());
+		level.swap(next);
+	}
+	if (mesh.lods.size() == 1)
+	{
+		mesh.lods.clear();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,333 @@
+#include "asset/MipGenerator.hpp"
+#include "util/ThreadPool.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+static const int LINEAR_LUT_SIZE = 16384;
+static const float KAISER_RADIUS = 1.5f;
+static const float KAISER_BETA = 4.f;
+
+struct FloatImage
+{
+	int width;
+	int height;
+	vector<float> data;
+};
+
+// per destination index the source indices (already clamped to the edge) and their weights
+struct AxisFilter
+{
+	int taps;
+	vector<int> indices;
+	vector<float> weights;
+};
+
+static const float *srgbToLinear()
+{
+	static const vector<float> table = []()
+	{
+		vector<float> t(256);
+		for (int i = 0; i < 256; i++)
+		{
+			float c = i / 255.f;
+			t[i] = c <= 0.04045f ? c / 12.92f : pow((c + 0.055f) / 1.055f, 2.4f);
+		}
+		return t;
+	}();
+	return table.data();
+}
+
+static const unsigned char *linearToSrgb()
+{
+	static const vector<unsigned char> table = []()
+	{
+		vector<unsigned char> t(LINEAR_LUT_SIZE);
+		for (int i = 0; i < LINEAR_LUT_SIZE; i++)
+		{
+			float l = i / (float)(LINEAR_LUT_SIZE - 1);
+			float c = l <= 0.0031308f ? l * 12.92f : 1.055f * pow(l, 1.f / 2.4f) - 0.055f;
+			t[i] = (unsigned char)(c * 255.f + 0.5f);
+		}
+		return t;
+	}();
+	return table.data();
+}
+
+static double besselI0(const double &x)
+{
+	double sum = 1.0, term = 1.0;
+	for (int k = 1; k < 20; k++)
+	{
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum += term;
+	}
+	return sum;
+}
+
+static double kaiser(const double &u)
+{
+	double sinc = u == 0.0 ? 1.0 : sin(M_PI * u) / (M_PI * u);
+	double r = u / KAISER_RADIUS;
+	return sinc * besselI0(KAISER_BETA * sqrt(max(0.0, 1.0 - r * r))) / besselI0(KAISER_BETA);
+}
+
+static AxisFilter buildFilter(const int &srcSize, const int &dstSize, const MIP_FILTERS &filter)
+{
+	const double scale = (double)srcSize / dstSize;
+	vector<vector<pair<int, float>>> taps(dstSize);
+	for (int x = 0; x < dstSize; x++)
+	{
+		double weightSum = 0.0;
+		if (filter == MIP_BOX)
+		{
+			// area of every source texel covered by the destination texel
+			double lo = x * scale, hi = (x + 1) * scale;
+			for (int i = (int)floor(lo); i < (int)ceil(hi); i++)
+			{
+				double w = min(hi, i + 1.0) - max(lo, (double)i);
+				taps[x].push_back({i, (float)w});
+				weightSum += w;
+			}
+		}
+		else
+		{
+			// support is KAISER_RADIUS destination texels either side of the centre
+			double center = (x + 0.5) * scale, radius = KAISER_RADIUS * scale;
+			for (int i = (int)floor(center - radius); i < (int)ceil(center + radius); i++)
+			{
+				double w = kaiser((i + 0.5 - center) / scale);
+				taps[x].push_back({i, (float)w});
+				weightSum += w;
+			}
+		}
+		for (pair<int, float> &tap : taps[x])
+		{
+			tap.first = min(max(tap.first, 0), srcSize - 1);
+			tap.second = (float)(tap.second / weightSum);
+		}
+	}
+
+	AxisFilter result;
+	result.taps = 0;
+	for (const vector<pair<int, float>> &t : taps)
+	{
+		result.taps = max(result.taps, (int)t.size());
+	}
+	// padded with zero weights so every destination has the same tap count
+	result.indices.assign((size_t)dstSize * result.taps, 0);
+	result.weights.assign((size_t)dstSize * result.taps, 0.f);
+	for (int x = 0; x < dstSize; x++)
+	{
+		for (size_t k = 0; k < taps[x].size(); k++)
+		{
+			result.indices[(size_t)x * result.taps + k] = taps[x][k].first;
+			result.weights[(size_t)x * result.taps + k] = taps[x][k].second;
+		}
+	}
+	return result;
+}
+
+// out[i] += weight * row[i]
+static void accumulateRow(float *out, const float *row, const float &weight, const int &count)
+{
+	int i = 0;
+#if defined(__AVX__)
+	__m256 w8 = _mm256_set1_ps(weight);
+	for (; i + 8 <= count; i += 8)
+	{
+		_mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(out + i), _mm256_mul_ps(w8, _mm256_loadu_ps(row + i))));
+	}
+#endif
+#if defined(__SSE2__)
+	__m128 w4 = _mm_set1_ps(weight);
+	for (; i + 4 <= count; i += 4)
+	{
+		_mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(w4, _mm_loadu_ps(row + i))));
+	}
+#endif
+	for (; i < count; i++)
+	{
+		out[i] += weight * row[i];
+	}
+}
+
+// horizontal pass over one vertically filtered row, results are clamped to [0, 1]
+static void filterRow(float *out, const float *row, const AxisFilter &filter, const int &dstWidth, const int &channels)
+{
+#if defined(__SSE2__)
+	if (channels == 4)
+	{
+		// a whole RGBA texel per register
+		const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.f);
+		for (int x = 0; x < dstWidth; x++)
+		{
+			const int *indices = filter.indices.data() + (size_t)x * filter.taps;
+			const float *weights = filter.weights.data() + (size_t)x * filter.taps;
+			__m128 sum = zero;
+			for (int k = 0; k < filter.taps; k++)
+			{
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(row + indices[k] * 4)));
+			}
+			_mm_storeu_ps(out + x * 4, _mm_min_ps(_mm_max_ps(sum, zero), one));
+		}
+		return;
+	}
+#endif
+	for (int x = 0; x < dstWidth; x++)
+	{
+		const int *indices = filter.indices.data() + (size_t)x * filter.taps;
+		const float *weights = filter.weights.data() + (size_t)x * filter.taps;
+		for (int c = 0; c < channels; c++)
+		{
+			float sum = 0.f;
+			for (int k = 0; k < filter.taps; k++)
+			{
+				sum += weights[k] * row[indices[k] * channels + c];
+			}
+			out[x * channels + c] = min(max(sum, 0.f), 1.f);
+		}
+	}
+}
+
+static void forRows(const int &rows, const bool &parallel, const function<void(int)> &body)
+{
+	if (parallel && rows > 1)
+	{
+		ThreadPool::shared().parallelFor(0, rows, body);
+		return;
+	}
+	for (int y = 0; y < rows; y++)
+	{
+		body(y);
+	}
+}
+
+static FloatImage downsample(const FloatImage &src, const int &channels, const MipOptions &options)
+{
+	FloatImage dst;
+	dst.width = max(1, src.width / 2);
+	dst.height = max(1, src.height / 2);
+	dst.data.resize((size_t)dst.width * dst.height * channels);
+
+	const AxisFilter horizontal = buildFilter(src.width, dst.width, options.filter);
+	const AxisFilter vertical = buildFilter(src.height, dst.height, options.filter);
+	const int rowFloats = src.width * channels;
+
+	forRows(dst.height, options.parallel, [&](int y)
+			{
+		thread_local vector<float> column;
+		column.assign(rowFloats, 0.f);
+		for (int k = 0; k < vertical.taps; k++)
+		{
+			float weight = vertical.weights[(size_t)y * vertical.taps + k];
+			if (weight != 0.f)
+			{
+				accumulateRow(column.data(), src.data.data() + (size_t)vertical.indices[(size_t)y * vertical.taps + k] * rowFloats, weight, rowFloats);
+			}
+		}
+		filterRow(dst.data.data() + (size_t)y * dst.width * channels, column.data(), horizontal, dst.width, channels); });
+	return dst;
+}
+
+static float coverage(const FloatImage &image, const int &channels, const float &cutoff, const float &scale)
+{
+	size_t covered = 0, count = (size_t)image.width * image.height;
+	for (size_t i = 0; i < count; i++)
+	{
+		covered += image.data[i * channels + channels - 1] * scale >= cutoff;
+	}
+	return (float)covered / count;
+}
+
+// alpha multiplier that brings the level's coverage back to the target
+static float coverageScale(const FloatImage &image, const int &channels, const float &cutoff, const float &target)
+{
+	float lo = 0.f, hi = 4.f;
+	for (int i = 0; i < 12; i++)
+	{
+		float mid = (lo + hi) * 0.5f;
+		if (coverage(image, channels, cutoff, mid) < target)
+		{
+			lo = mid;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+	return (lo + hi) * 0.5f;
+}
+
+static TextureLevel quantize(const FloatImage &image, const int &channels, const MipOptions &options, const float &alphaScale)
+{
+	const unsigned char *encode = linearToSrgb();
+	// only RGB is colour, a lone channel or the alpha channel is data
+	const int colourChannels = options.srgb && channels >= 3 ? 3 : 0;
+	const bool hasAlpha = channels == 2 || channels == 4;
+
+	TextureLevel level;
+	level.width = (uint32_t)image.width;
+	level.height = (uint32_t)image.height;
+	level.data.resize(image.data.size());
+
+	forRows(image.height, options.parallel, [&](int y)
+			{
+		size_t begin = (size_t)y * image.width * channels;
+		for (int x = 0; x < image.width; x++)
+		{
+			for (int c = 0; c < channels; c++)
+			{
+				size_t i = begin + (size_t)x * channels + c;
+				float v = image.data[i];
+				if (c < colourChannels)
+				{
+					level.data[i] = encode[(int)(v * (LINEAR_LUT_SIZE - 1) + 0.5f)];
+					continue;
+				}
+				if (hasAlpha && c == channels - 1)
+				{
+					v = min(v * alphaScale, 1.f);
+				}
+				level.data[i] = (unsigned char)(v * 255.f + 0.5f);
+			}
+		} });
+	return level;
+}
+
+void MipGenerator::generate(const unsigned char *pixels, const int &width, const int &height, const int &channels, const MipOptions &options, std::vector<TextureLevel> &levels)
+{
+	levels.clear();
+	levels.push_back({(uint32_t)width, (uint32_t)height, vector<unsigned char>(pixels, pixels + (size_t)width * height * channels)});
+	if (width <= 1 && height <= 1)
+	{
+		return;
+	}
+
+	const float *decode = srgbToLinear();
+	const int colourChannels = options.srgb && channels >= 3 ? 3 : 0;
+	FloatImage current = {width, height, vector<float>((size_t)width * height * channels)};
+	for (size_t i = 0; i < current.data.size(); i++)
+	{
+		current.data[i] = (int)(i % channels) < colourChannels ? decode[pixels[i]] : pixels[i] / 255.f;
+	}
+
+	const bool preserveCoverage = options.alphaCutoff > 0.f && (channels == 2 || channels == 4);
+	const float targetCoverage = preserveCoverage ? coverage(current, channels, options.alphaCutoff, 1.f) : 0.f;
+
+	while (current.width > 1 || current.height > 1)
+	{
+		current = downsample(current, channels, options);
+		float alphaScale = preserveCoverage ? coverageScale(current, channels, options.alphaCutoff, targetCoverage) : 1.f;
+		levels.push_back(quantize(current, channels, options, alphaScale));
+	}
+}
\ No newline at end of file
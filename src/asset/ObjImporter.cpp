@@ -0,0 +1,197 @@
+#include "asset/ObjImporter.hpp"
+#include "util/MappedFile.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+
+using namespace std;
+
+struct ObjCorner
+{
+	int position, uv, normal;
+
+	bool operator==(const ObjCorner &other) const
+	{
+		return position == other.position && uv == other.uv && normal == other.normal;
+	}
+};
+
+struct ObjCornerHash
+{
+	size_t operator()(const ObjCorner &corner) const
+	{
+		return ((size_t)corner.position * 73856093u) ^ ((size_t)corner.uv * 19349663u) ^ ((size_t)corner.normal * 83492791u);
+	}
+};
+
+static const char *skipSpaces(const char *p, const char *end)
+{
+	while (p < end && (*p == ' ' || *p == '\t'))
+	{
+		p++;
+	}
+	return p;
+}
+
+// 1 based, negative counts back from the last element read so far, 0 when absent
+static int parseIndex(const char *&p, const char *end, const size_t &count)
+{
+	if (p >= end || *p == '/' || *p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')
+	{
+		return 0;
+	}
+	int index = (int)strtol(p, (char **)&p, 10);
+	return index < 0 ? (int)count + index + 1 : index;
+}
+
+bool ObjImporter::load(const std::string &path, MeshData &mesh)
+{
+	MappedFile file;
+	if (!file.open(path))
+	{
+		cout << "ERROR::OBJ_IMPORTER::FILE_NOT_READ " << path << endl;
+		return false;
+	}
+
+	// strtof/strtol stop at the first character that is not part of a number, the mapping has no
+	// terminator so the text is parsed from a copy
+	string text((const char *)file.data(), file.size());
+	file.close();
+	const char *p = text.c_str(), *end = p + text.size();
+
+	vector<float> positions, uvs, normals;
+	vector<ObjCorner> corners;
+	vector<ObjCorner> face;
+	for (; p < end; p++)
+	{
+		p = skipSpaces(p, end);
+		if (p + 1 < end && p[0] == 'v' && (p[1] == ' ' || p[1] == '\t'))
+		{
+			p++;
+			for (int c = 0; c < 3; c++)
+			{
+				positions.push_back(strtof(p, (char **)&p));
+			}
+		}
+		else if (p + 2 < end && p[0] == 'v' && p[1] == 't' && (p[2] == ' ' || p[2] == '\t'))
+		{
+			p += 2;
+			for (int c = 0; c < 2; c++)
+			{
+				uvs.push_back(strtof(p, (char **)&p));
+			}
+		}
+		else if (p + 2 < end && p[0] == 'v' && p[1] == 'n' && (p[2] == ' ' || p[2] == '\t'))
+		{
+			p += 2;
+			for (int c = 0; c < 3; c++)
+			{
+				normals.push_back(strtof(p, (char **)&p));
+			}
+		}
+		else if (p + 1 < end && p[0] == 'f' && (p[1] == ' ' || p[1] == '\t'))
+		{
+			p++;
+			face.clear();
+			while (true)
+			{
+				p = skipSpaces(p, end);
+				if (p >= end || *p == '\r' || *p == '\n')
+				{
+					break;
+				}
+				ObjCorner corner = {parseIndex(p, end, positions.size() / 3), 0, 0};
+				if (p < end && *p == '/')
+				{
+					p++;
+					corner.uv = parseIndex(p, end, uvs.size() / 2);
+					if (p < end && *p == '/')
+					{
+						p++;
+						corner.normal = parseIndex(p, end, normals.size() / 3);
+					}
+				}
+				if (corner.position <= 0 || corner.position > (int)(positions.size() / 3) || corner.uv < 0 ||
+					corner.uv > (int)(uvs.size() / 2) || corner.normal < 0 || corner.normal > (int)(normals.size() / 3))
+				{
+					cout << "ERROR::OBJ_IMPORTER::INVALID_FACE " << path << endl;
+					return false;
+				}
+				face.push_back(corner);
+			}
+			for (size_t i = 2; i < face.size(); i++)
+			{
+				corners.push_back(face[0]);
+				corners.push_back(face[i - 1]);
+				corners.push_back(face[i]);
+			}
+		}
+		// rest of the line (comments, groups, materials, smoothing) is ignored
+		while (p < end && *p != '\n')
+		{
+			p++;
+		}
+	}
+	if (corners.empty())
+	{
+		cout << "ERROR::OBJ_IMPORTER::NO_FACES " << path << endl;
+		return false;
+	}
+
+	bool hasUv = false, hasNormal = false;
+	for (const ObjCorner &corner : corners)
+	{
+		hasUv |= corner.uv != 0;
+		hasNormal |= corner.normal != 0;
+	}
+	mesh.attributes.clear();
+	mesh.attributes.push_back({0, MESH_FLOAT32, 3, 0, 0});
+	mesh.stride = 12;
+	if (hasUv)
+	{
+		mesh.attributes.push_back({2, MESH_FLOAT32, 2, 0, mesh.stride});
+		mesh.stride += 8;
+	}
+	if (hasNormal)
+	{
+		mesh.attributes.push_back({4, MESH_FLOAT32, 3, 0, mesh.stride});
+		mesh.stride += 12;
+	}
+
+	unordered_map<ObjCorner, uint32_t, ObjCornerHash> vertexOf;
+	vertexOf.reserve(corners.size());
+	mesh.vertices.clear();
+	mesh.indices.clear();
+	mesh.indices.reserve(corners.size());
+	float vertex[8];
+	for (const ObjCorner &corner : corners)
+	{
+		auto inserted = vertexOf.emplace(corner, (uint32_t)vertexOf.size());
+		mesh.indices.push_back(inserted.first->second);
+		if (!inserted.second)
+		{
+			continue;
+		}
+
+		int floats = 0;
+		memcpy(vertex, &positions[(corner.position - 1) * 3], 3 * sizeof(float));
+		floats += 3;
+		if (hasUv)
+		{
+			vertex[floats++] = corner.uv ? uvs[(corner.uv - 1) * 2] : 0.f;
+			vertex[floats++] = corner.uv ? uvs[(corner.uv - 1) * 2 + 1] : 0.f;
+		}
+		if (hasNormal)
+		{
+			for (int c = 0; c < 3; c++)
+			{
+				vertex[floats++] = corner.normal ? normals[(corner.normal - 1) * 3 + c] : 0.f;
+			}
+		}
+		const unsigned char *bytes = (const unsigned char *)vertex;
+		mesh.vertices.insert(mesh.vertices.end(), bytes, bytes + floats * sizeof(float));
+	}
+	return true;
+}
\ No newline at end of file
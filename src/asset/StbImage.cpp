@@ -0,0 +1,3 @@
+// the single stb_image implementation, shared by the application and the bake tool
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb/stb_image.h>
\ No newline at end of file
@@ -0,0 +1,60 @@
+#include "asset/TextureBaker.hpp"
+#include "asset/JpegDecoder.hpp"
+
+#include <stb/stb_image.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+
+using namespace std;
+
+string TextureBaker::bakedPathFor(const std::string &sourcePath)
+{
+	return filesystem::path(sourcePath).replace_extension(".ltex").string();
+}
+
+bool TextureBaker::isStale(const std::string &sourcePath, const std::string &bakedPath)
+{
+	error_code ec;
+	auto baked = filesystem::last_write_time(bakedPath, ec);
+	if (ec)
+	{
+		return true;
+	}
+	auto source = filesystem::last_write_time(sourcePath, ec);
+	// a baked file without its source is still usable
+	return !ec && source > baked;
+}
+
+bool TextureBaker::bake(const std::string &sourcePath, const std::string &outputPath, const BakeOptions &options)
+{
+	int width, height, nrChannels;
+	unsigned char *data = JpegDecoder::load(sourcePath.c_str(), &width, &height, &nrChannels, 0);
+	if (!data)
+	{
+		data = stbi_load(sourcePath.c_str(), &width, &height, &nrChannels, 0);
+	}
+	if (!data)
+	{
+		cout << "ERROR::TEXTURE_BAKER::FILE_NOT_READ " << sourcePath << endl;
+		return false;
+	}
+
+	vector<TextureLevel> levels;
+	MipGenerator::generate(data, width, height, nrChannels, options.mips, levels);
+	stbi_image_free(data);
+
+	// format values match the channel count
+	uint32_t format = (uint32_t)nrChannels;
+	if (options.compress && nrChannels >= 3)
+	{
+		format = nrChannels == 4 ? TEX_FMT_BC3 : TEX_FMT_BC1;
+		for (TextureLevel &level : levels)
+		{
+			level = BlockCompressor::compress(level, nrChannels, format, options.quality);
+		}
+	}
+	uint32_t flags = options.mips.srgb && nrChannels >= 3 ? TEX_FLAG_SRGB : 0;
+	return TextureFile::write(outputPath, format, flags, levels);
+}
\ No newline at end of file
@@ -0,0 +1,126 @@
+#include "asset/TextureFile.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+
+static const char MAGIC[4] = {'L', 'T', 'E', 'X'};
+
+static uint64_t alignUp(const uint64_t &value, const uint64_t &alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+int TextureFile::bytesPerPixel(const uint32_t &format)
+{
+	switch (format)
+	{
+	case TEX_FMT_R8:
+		return 1;
+	case TEX_FMT_RG8:
+		return 2;
+	case TEX_FMT_RGB8:
+		return 3;
+	case TEX_FMT_RGBA8:
+		return 4;
+	default:
+		return 0;
+	}
+}
+
+bool TextureFile::isCompressed(const uint32_t &format)
+{
+	return format == TEX_FMT_BC1 || format == TEX_FMT_BC3;
+}
+
+size_t TextureFile::levelSize(const uint32_t &format, const uint32_t &width, const uint32_t &height)
+{
+	if (isCompressed(format))
+	{
+		size_t blocks = (((size_t)width + 3) / 4) * (((size_t)height + 3) / 4);
+		return blocks * (format == TEX_FMT_BC1 ? 8 : 16);
+	}
+	return (size_t)width * height * bytesPerPixel(format);
+}
+
+bool TextureFile::write(const std::string &path, const uint32_t &format, const uint32_t &flags, const std::vector<TextureLevel> &levels)
+{
+	if (levels.empty() || levels.size() > MAX_MIPS)
+	{
+		return false;
+	}
+
+	TextureFileHeader header = {};
+	memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = VERSION;
+	header.format = format;
+	header.width = levels[0].width;
+	header.height = levels[0].height;
+	header.mipCount = (uint32_t)levels.size();
+	header.flags = flags;
+
+	vector<TextureFileMip> mips(levels.size());
+	uint64_t offset = alignUp(sizeof(header) + sizeof(TextureFileMip) * mips.size(), DATA_ALIGNMENT);
+	for (size_t i = 0; i < levels.size(); i++)
+	{
+		mips[i] = {offset, levels[i].data.size(), levels[i].width, levels[i].height};
+		offset = alignUp(offset + levels[i].data.size(), DATA_ALIGNMENT);
+	}
+
+	ofstream file(path, ios::binary | ios::trunc);
+	if (!file)
+	{
+		cout << "ERROR::TEXTURE_FILE::CANNOT_WRITE " << path << endl;
+		return false;
+	}
+
+	file.write((const char *)&header, sizeof(header));
+	file.write((const char *)mips.data(), sizeof(TextureFileMip) * mips.size());
+	for (size_t i = 0; i < levels.size(); i++)
+	{
+		// pad up to the level's offset
+		static const char zeros[DATA_ALIGNMENT] = {};
+		file.write(zeros, mips[i].offset - (uint64_t)file.tellp());
+		file.write((const char *)levels[i].data.data(), levels[i].data.size());
+	}
+	return (bool)file;
+}
+
+bool TextureFile::parse(const unsigned char *data, const size_t &size, TextureFileView &view)
+{
+	if (size < sizeof(TextureFileHeader))
+	{
+		return false;
+	}
+
+	memcpy(&view.header, data, sizeof(TextureFileHeader));
+	const TextureFileHeader &header = view.header;
+	if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION || header.mipCount == 0 || header.mipCount > MAX_MIPS)
+	{
+		return false;
+	}
+
+	size_t tableEnd = sizeof(TextureFileHeader) + sizeof(TextureFileMip) * header.mipCount;
+	if (size < tableEnd)
+	{
+		return false;
+	}
+
+	view.mips.resize(header.mipCount);
+	memcpy(view.mips.data(), data + sizeof(TextureFileHeader), sizeof(TextureFileMip) * header.mipCount);
+	view.data.resize(header.mipCount);
+	for (uint32_t i = 0; i < header.mipCount; i++)
+	{
+		const TextureFileMip &mip = view.mips[i];
+		// subtracted rather than added, a hostile offset would wrap the sum back into range
+		if (mip.offset < tableEnd || mip.offset > size || mip.size > size - mip.offset || mip.width == 0 || mip.height == 0 ||
+			mip.size != levelSize(header.format, mip.width, mip.height))
+		{
+			return false;
+		}
+		view.data[i] = data + mip.offset;
+	}
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include "asset/VirtualTextureFile.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+
+static const char MAGIC[4] = {'L', 'V', 'T', 'X'};
+
+uint32_t VirtualTextureView::paddedSize() const
+{
+	return header.tileSize + 2 * header.border;
+}
+
+const unsigned char *VirtualTextureView::tile(const uint32_t &level, const uint32_t &x, const uint32_t &y) const
+{
+	return tiles + (size_t)(firstPage[level] + y * pagesX[level] + x) * tileBytes;
+}
+
+uint32_t VirtualTextureFile::pageCount(const uint32_t &texels, const uint32_t &tileSize)
+{
+	// in 64 bits, texels near UINT32_MAX would wrap the rounding up
+	return (uint32_t)max<uint64_t>(1, ((uint64_t)texels + tileSize - 1) / tileSize);
+}
+
+// copies one page and its border out of a level, clamping reads to the level's edges
+static void cutTile(const TextureLevel &level, const int &x0, const int &y0, const int &padded, unsigned char *out)
+{
+	const int width = (int)level.width, height = (int)level.height;
+	for (int y = 0; y < padded; y++)
+	{
+		const unsigned char *row = level.data.data() + (size_t)clamp(y0 + y, 0, height - 1) * width * 4;
+		for (int x = 0; x < padded; x++)
+		{
+			memcpy(out + ((size_t)y * padded + x) * 4, row + (size_t)clamp(x0 + x, 0, width - 1) * 4, 4);
+		}
+	}
+}
+
+bool VirtualTextureFile::write(const std::string &path, const std::vector<TextureLevel> &levels, const uint32_t &tileSize, const uint32_t &border)
+{
+	if (levels.empty() || tileSize == 0 || border >= tileSize || tileSize + 2 * border > MAX_PADDED_SIZE)
+	{
+		return false;
+	}
+
+	VirtualTextureHeader header = {};
+	memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = VERSION;
+	header.width = levels[0].width;
+	header.height = levels[0].height;
+	header.tileSize = tileSize;
+	header.border = border;
+	while (header.levels < levels.size() && header.levels < MAX_LEVELS)
+	{
+		const TextureLevel &level = levels[header.levels++];
+		if (pageCount(level.width, tileSize) == 1 && pageCount(level.height, tileSize) == 1)
+		{
+			break;
+		}
+	}
+
+	// parse() expects the chain to end in a single page
+	const TextureLevel &top = levels[header.levels - 1];
+	if (pageCount(top.width, tileSize) != 1 || pageCount(top.height, tileSize) != 1)
+	{
+		cout << "ERROR::VIRTUAL_TEXTURE_FILE::INCOMPLETE_CHAIN " << path << endl;
+		return false;
+	}
+
+	ofstream file(path, ios::binary | ios::trunc);
+	if (!file)
+	{
+		cout << "ERROR::VIRTUAL_TEXTURE_FILE::CANNOT_WRITE " << path << endl;
+		return false;
+	}
+	file.write((const char *)&header, sizeof(header));
+	static const char zeros[DATA_ALIGNMENT] = {};
+	file.write(zeros, DATA_ALIGNMENT - sizeof(header));
+
+	const int padded = (int)(tileSize + 2 * border);
+	vector<unsigned char> tile((size_t)padded * padded * 4);
+	for (uint32_t l = 0; l < header.levels; l++)
+	{
+		const TextureLevel &level = levels[l];
+		uint32_t pagesX = pageCount(level.width, tileSize), pagesY = pageCount(level.height, tileSize);
+		for (uint32_t y = 0; y < pagesY; y++)
+		{
+			for (uint32_t x = 0; x < pagesX; x++)
+			{
+				cutTile(level, (int)(x * tileSize) - (int)border, (int)(y * tileSize) - (int)border, padded, tile.data());
+				file.write((const char *)tile.data(), tile.size());
+			}
+		}
+	}
+	return (bool)file;
+}
+
+bool VirtualTextureFile::parse(const unsigned char *data, const size_t &size, VirtualTextureView &view)
+{
+	if (size < DATA_ALIGNMENT)
+	{
+		return false;
+	}
+
+	memcpy(&view.header, data, sizeof(VirtualTextureHeader));
+	const VirtualTextureHeader &header = view.header;
+	if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION || header.levels == 0 || header.levels > MAX_LEVELS ||
+		header.width == 0 || header.height == 0 || header.tileSize == 0 || header.border >= header.tileSize ||
+		header.tileSize > MAX_PADDED_SIZE || header.tileSize + 2 * header.border > MAX_PADDED_SIZE)
+	{
+		return false;
+	}
+
+	view.pagesX.resize(header.levels);
+	view.pagesY.resize(header.levels);
+	view.firstPage.resize(header.levels);
+	uint64_t pages = 0;
+	for (uint32_t l = 0; l < header.levels; l++)
+	{
+		// the same halving as MipGenerator
+		view.pagesX[l] = pageCount(max(1u, header.width >> l), header.tileSize);
+		view.pagesY[l] = pageCount(max(1u, header.height >> l), header.tileSize);
+		if (view.pagesX[l] > MAX_PAGES_PER_SIDE || view.pagesY[l] > MAX_PAGES_PER_SIDE || pages > UINT32_MAX)
+		{
+			return false;
+		}
+		view.firstPage[l] = (uint32_t)pages;
+		pages += (uint64_t)view.pagesX[l] * view.pagesY[l];
+	}
+	// the coarsest level is the one page every texel falls back to
+	if (view.pagesX[header.levels - 1] != 1 || view.pagesY[header.levels - 1] != 1 || pages > UINT32_MAX)
+	{
+		return false;
+	}
+
+	// the padded size is bounded above, so the tile is never empty and the product cannot wrap
+	view.tileBytes = (size_t)view.paddedSize() * view.paddedSize() * 4;
+	view.tiles = data + DATA_ALIGNMENT;
+	return pages <= (size - DATA_ALIGNMENT) / view.tileBytes;
+}
\ No newline at end of file
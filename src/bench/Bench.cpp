@@ -0,0 +1,306 @@
+#include "bench/Bench.hpp"
+#include "asset/MipGenerator.hpp"
+#include "graphics/GLState.hpp"
+#include "graphics/GLExtensions.hpp"
+#include "graphics/TextureFormat.hpp"
+#include "graphics/MeshLoader.hpp"
+#include "graphics/GltfImporter.hpp"
+#include "util/ThreadPool.hpp"
+
+#include <stb/stb_image.h>
+
+#include <cstring>
+#include <fstream>
+
+using namespace std;
+
+static double nanosPerCall(chrono::steady_clock::time_point start, const long long &calls)
+{
+	chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - start;
+	return elapsed.count() / calls;
+}
+
+void Bench::uniformSetters(Shader &shader, const char *uniformName, const int &updatesPerFrame, const int &frames)
+{
+	const long long calls = (long long)updatesPerFrame * frames;
+	const string name(uniformName);
+	shader.use();
+
+	// before: driver lookup with a string on every call
+	glFinish();
+	auto start = chrono::steady_clock::now();
+	for (long long i = 0; i < calls; i++)
+	{
+		glUniform1i(glGetUniformLocation(shader.programId, name.c_str()), (int)(i & 1));
+	}
+	glFinish();
+	double lookup = nanosPerCall(start, calls);
+
+	// after: cached name table
+	start = chrono::steady_clock::now();
+	for (long long i = 0; i < calls; i++)
+	{
+		shader.setInt(name, (int)(i & 1));
+	}
+	glFinish();
+	double cached = nanosPerCall(start, calls);
+
+	// after: precomputed handle
+	int location = shader.getUniformLocation(name);
+	start = chrono::steady_clock::now();
+	for (long long i = 0; i < calls; i++)
+	{
+		shader.setInt(location, (int)(i & 1));
+	}
+	glFinish();
+	double handle = nanosPerCall(start, calls);
+
+	// deferred parameter block, the common case of rewriting an unchanged value never reaches GL
+	const uint32_t hash = Hash::fnv1a(uniformName);
+	start = chrono::steady_clock::now();
+	for (long long i = 0; i < calls; i++)
+	{
+		shader.params.setInt(hash, 0);
+		if (i % updatesPerFrame == 0)
+		{
+			shader.params.flush();
+		}
+	}
+	glFinish();
+	double unchanged = nanosPerCall(start, calls);
+
+	// deferred parameter block with a value that changes on every write, one upload per frame
+	start = chrono::steady_clock::now();
+	for (long long i = 0; i < calls; i++)
+	{
+		shader.params.setInt(hash, (int)(i & 1));
+		if (i % updatesPerFrame == 0)
+		{
+			shader.params.flush();
+		}
+	}
+	shader.params.flush();
+	glFinish();
+	double changing = nanosPerCall(start, calls);
+
+	cout << "BENCH::UNIFORMS '" << uniformName << "' " << updatesPerFrame << " updates x " << frames << " frames" << endl
+		 << "  glGetUniformLocation per call: " << lookup << " ns/call" << endl
+		 << "  cached name lookup:            " << cached << " ns/call" << endl
+		 << "  precomputed handle:            " << handle << " ns/call" << endl
+		 << "  parameter block, unchanged:    " << unchanged << " ns/call" << endl
+		 << "  parameter block, changing:     " << changing << " ns/call" << endl;
+}
+
+void Bench::mipGeneration(const char *imagePath, const int &repeats)
+{
+	int width, height, nrChannels;
+	unsigned char *data = stbi_load(imagePath, &width, &height, &nrChannels, 3);
+	if (!data)
+	{
+		cout << "ERROR::BENCH::FILE_NOT_READ " << imagePath << endl;
+		return;
+	}
+
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	GLState::bindTexture(0, GL_TEXTURE_2D, texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	// driver path, level 0 is uploaded outside the timed region
+	double gpu = 0.0;
+	for (int i = 0; i < repeats; i++)
+	{
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+		glFinish();
+		auto start = chrono::steady_clock::now();
+		glGenerateMipmap(GL_TEXTURE_2D);
+		glFinish();
+		gpu += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+	}
+
+	const MIP_FILTERS FILTERS[] = {MIP_BOX, MIP_KAISER};
+	double generate[2] = {0.0, 0.0}, upload[2] = {0.0, 0.0};
+	for (int f = 0; f < 2; f++)
+	{
+		MipOptions options;
+		options.filter = FILTERS[f];
+		vector<TextureLevel> levels;
+		for (int i = 0; i < repeats; i++)
+		{
+			auto start = chrono::steady_clock::now();
+			MipGenerator::generate(data, width, height, 3, options, levels);
+			auto generated = chrono::steady_clock::now();
+			for (size_t level = 1; level < levels.size(); level++)
+			{
+				glTexImage2D(GL_TEXTURE_2D, (GLint)level, GL_RGB, levels[level].width, levels[level].height, 0, GL_RGB, GL_UNSIGNED_BYTE, levels[level].data.data());
+			}
+			glFinish();
+			generate[f] += chrono::duration<double, milli>(generated - start).count();
+			upload[f] += chrono::duration<double, milli>(chrono::steady_clock::now() - generated).count();
+		}
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	GLState::deleteTexture(texture);
+	stbi_image_free(data);
+
+	cout << "BENCH::MIPMAPS '" << imagePath << "' " << width << "x" << height << ", " << repeats << " runs" << endl
+		 << "  glGenerateMipmap:        " << gpu / repeats << " ms" << endl
+		 << "  CPU box, generate:       " << generate[0] / repeats << " ms, upload " << upload[0] / repeats << " ms" << endl
+		 << "  CPU kaiser, generate:    " << generate[1] / repeats << " ms, upload " << upload[1] / repeats << " ms" << endl;
+}
+
+void Bench::textureUpload(const char *imagePath, const int &repeats)
+{
+	int width, height, nrChannels;
+	unsigned char *data = stbi_load(imagePath, &width, &height, &nrChannels, 4);
+	if (!data)
+	{
+		cout << "ERROR::BENCH::FILE_NOT_READ " << imagePath << endl;
+		return;
+	}
+
+	// the same image with its first 1 to 4 channels
+	size_t pixels = (size_t)width * height;
+	vector<unsigned char> sources[5];
+	for (int channels = 1; channels <= 4; channels++)
+	{
+		sources[channels].resize(pixels * channels);
+		for (size_t i = 0; i < pixels; i++)
+		{
+			memcpy(&sources[channels][i * channels], data + i * 4, channels);
+		}
+	}
+	stbi_image_free(data);
+
+	struct Case
+	{
+		const char *name;
+		int channels;
+		bool pad;
+		bool srgb;
+	};
+	const Case CASES[] = {
+		{"R8", 1, false, false},
+		{"RG8", 2, false, false},
+		{"RGB8", 3, false, false},
+		{"RGB8 padded to RGBA8", 3, true, false},
+		{"RGBA8", 4, false, false},
+		{"SRGB8_ALPHA8", 4, false, true}};
+
+	cout << "BENCH::TEXTURE_UPLOAD '" << imagePath << "' " << width << "x" << height << ", " << repeats << " runs, "
+		 << (TextureFormat::padRgb() ? "driver prefers padded RGB" : "driver takes RGB as is") << endl;
+
+	vector<unsigned char> padded(pixels * 4);
+	for (const Case &test : CASES)
+	{
+		PixelFormat format = TextureFormat::forChannels(test.pad ? 4 : test.channels, test.srgb);
+		double ms[2] = {0.0, 0.0};
+		for (int immutable = 0; immutable < (GLExtensions::textureStorage ? 2 : 1); immutable++)
+		{
+			for (int i = 0; i < repeats; i++)
+			{
+				unsigned int texture;
+				glGenTextures(1, &texture);
+				GLState::bindTexture(0, GL_TEXTURE_2D, texture);
+				glFinish();
+
+				// padding is part of the cost of that path
+				auto start = chrono::steady_clock::now();
+				const unsigned char *pixelsIn = sources[test.channels].data();
+				if (test.pad)
+				{
+					TextureFormat::padToRgba(pixelsIn, padded.data(), pixels);
+					pixelsIn = padded.data();
+				}
+				glPixelStorei(GL_UNPACK_ALIGNMENT, TextureFormat::unpackAlignment(width, format.channels));
+				if (immutable)
+				{
+					glTexStorage2D(GL_TEXTURE_2D, 1, format.internalFormat, width, height);
+					glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, format.format, GL_UNSIGNED_BYTE, pixelsIn);
+				}
+				else
+				{
+					glTexImage2D(GL_TEXTURE_2D, 0, format.internalFormat, width, height, 0, format.format, GL_UNSIGNED_BYTE, pixelsIn);
+				}
+				glFinish();
+				ms[immutable] += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+				GLState::deleteTexture(texture);
+			}
+		}
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+		// throughput of the decoded image, what the caller actually hands over
+		double megabytes = (double)pixels * test.channels / (1024.0 * 1024.0);
+		cout << "  " << test.name << ": glTexImage2D " << ms[0] / repeats << " ms (" << megabytes * repeats * 1000.0 / ms[0] << " MB/s)";
+		if (GLExtensions::textureStorage)
+		{
+			cout << ", glTexStorage2D " << ms[1] / repeats << " ms (" << megabytes * repeats * 1000.0 / ms[1] << " MB/s)";
+		}
+		cout << endl;
+	}
+}
+
+void Bench::meshLoad(const char *meshPath, const int &repeats)
+{
+	double load = 0.0, read = 0.0;
+	size_t bytes = 0;
+	GLsizei indices = 0;
+	for (int i = 0; i < repeats; i++)
+	{
+		// plain read of the whole file, the floor for any loader
+		auto start = chrono::steady_clock::now();
+		ifstream file(meshPath, ios::binary | ios::ate);
+		vector<char> contents((size_t)file.tellg());
+		file.seekg(0);
+		file.read(contents.data(), contents.size());
+		read += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+		bytes = contents.size();
+
+		start = chrono::steady_clock::now();
+		GpuMesh mesh;
+		if (!MeshLoader::load(meshPath, mesh))
+		{
+			return;
+		}
+		glFinish();
+		load += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+		indices = mesh.indexCount;
+		MeshLoader::destroy(mesh);
+	}
+
+	double megabytes = bytes / (1024.0 * 1024.0);
+	cout << "BENCH::MESH_LOAD '" << meshPath << "' " << indices / 3 << " triangles, " << megabytes << " MB, " << repeats << " runs" << endl
+		 << "  read into memory:        " << read / repeats << " ms (" << megabytes * repeats * 1000.0 / read << " MB/s)" << endl
+		 << "  mapped into GL buffers:  " << load / repeats << " ms (" << megabytes * repeats * 1000.0 / load << " MB/s)" << endl;
+}
+
+void Bench::gltfImport(const char *gltfPath, const int &repeats)
+{
+	GltfImportStats total = {}, stats = {};
+	for (int i = 0; i < repeats; i++)
+	{
+		GltfScene scene;
+		if (!GltfImporter::import(gltfPath, scene, &stats))
+		{
+			return;
+		}
+		// the upload is only done once the driver has consumed it
+		auto start = chrono::steady_clock::now();
+		glFinish();
+		stats.uploadMs += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+		total.openMs += stats.openMs;
+		total.prepareMs += stats.prepareMs;
+		total.uploadMs += stats.uploadMs;
+		GltfImporter::destroy(scene);
+	}
+
+	double ms = (total.openMs + total.prepareMs + total.uploadMs) / repeats;
+	double megabytes = (stats.viewBytes + stats.convertedBytes + stats.textureBytes) / (1024.0 * 1024.0);
+	cout << "BENCH::GLTF_IMPORT '" << gltfPath << "' " << stats.triangles << " triangles, " << stats.images << " images, " << ThreadPool::shared().size()
+		 << " threads, " << repeats << " runs" << endl
+		 << "  parse:   " << total.openMs / repeats << " ms" << endl
+		 << "  prepare: " << total.prepareMs / repeats << " ms (decode, mips, conversions)" << endl
+		 << "  upload:  " << total.uploadMs / repeats << " ms (" << (stats.viewBytes >> 10) << " KB from the mapping, " << (stats.convertedBytes >> 10)
+		 << " KB converted, " << (stats.textureBytes >> 10) << " KB of texels)" << endl
+		 << "  total:   " << ms << " ms, " << megabytes * 1000.0 / ms << " MB/s, " << stats.triangles * 1000.0 / ms / 1e6 << " M triangles/s" << endl;
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include "graphics/GLExtensions.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+PFNGLGETPROGRAMBINARYPROC ext_glGetProgramBinary = NULL;
+PFNGLPROGRAMBINARYPROC ext_glProgramBinary = NULL;
+PFNGLPROGRAMPARAMETERIPROC ext_glProgramParameteri = NULL;
+PFNGLMAXSHADERCOMPILERTHREADSKHRPROC ext_glMaxShaderCompilerThreadsKHR = NULL;
+PFNGLTEXSTORAGE2DPROC ext_glTexStorage2D = NULL;
+PFNGLTEXSTORAGE3DPROC ext_glTexStorage3D = NULL;
+PFNGLGETINTERNALFORMATIVPROC ext_glGetInternalformativ = NULL;
+
+vector<string> GLExtensions::m_extensions;
+int GLExtensions::m_major = 0;
+int GLExtensions::m_minor = 0;
+bool GLExtensions::programBinary = false;
+bool GLExtensions::parallelShaderCompile = false;
+bool GLExtensions::s3tc = false;
+bool GLExtensions::textureStorage = false;
+bool GLExtensions::internalformatQuery = false;
+
+void GLExtensions::load(GLADloadproc loader)
+{
+	glGetIntegerv(GL_MAJOR_VERSION, &m_major);
+	glGetIntegerv(GL_MINOR_VERSION, &m_minor);
+
+	int count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+	m_extensions.clear();
+	m_extensions.reserve(count);
+	for (int i = 0; i < count; i++)
+	{
+		m_extensions.emplace_back((const char *)glGetStringi(GL_EXTENSIONS, i));
+	}
+	sort(m_extensions.begin(), m_extensions.end());
+
+	if (atLeast(4, 1) || has("GL_ARB_get_program_binary"))
+	{
+		ext_glGetProgramBinary = (PFNGLGETPROGRAMBINARYPROC)loader("glGetProgramBinary");
+		ext_glProgramBinary = (PFNGLPROGRAMBINARYPROC)loader("glProgramBinary");
+		ext_glProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC)loader("glProgramParameteri");
+
+		// a driver may expose the entry points but support no binary formats at all
+		int formats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+		programBinary = ext_glGetProgramBinary && ext_glProgramBinary && ext_glProgramParameteri && formats > 0;
+	}
+
+	if (has("GL_KHR_parallel_shader_compile"))
+	{
+		ext_glMaxShaderCompilerThreadsKHR = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)loader("glMaxShaderCompilerThreadsKHR");
+	}
+	else if (has("GL_ARB_parallel_shader_compile"))
+	{
+		ext_glMaxShaderCompilerThreadsKHR = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)loader("glMaxShaderCompilerThreadsARB");
+	}
+	parallelShaderCompile = ext_glMaxShaderCompilerThreadsKHR != NULL;
+
+	s3tc = has("GL_EXT_texture_compression_s3tc");
+
+	if (atLeast(4, 2) || has("GL_ARB_texture_storage"))
+	{
+		ext_glTexStorage2D = (PFNGLTEXSTORAGE2DPROC)loader("glTexStorage2D");
+		ext_glTexStorage3D = (PFNGLTEXSTORAGE3DPROC)loader("glTexStorage3D");
+	}
+	textureStorage = ext_glTexStorage2D && ext_glTexStorage3D;
+
+	if (atLeast(4, 3) || has("GL_ARB_internalformat_query2"))
+	{
+		ext_glGetInternalformativ = (PFNGLGETINTERNALFORMATIVPROC)loader("glGetInternalformativ");
+	}
+	internalformatQuery = ext_glGetInternalformativ != NULL;
+}
+
+bool GLExtensions::has(const char *extension)
+{
+	return binary_search(m_extensions.begin(), m_extensions.end(), string(extension));
+}
+
+bool GLExtensions::atLeast(const int &major, const int &minor)
+{
+	return m_major > major || (m_major == major && m_minor >= minor);
+}
\ No newline at end of file
@@ -0,0 +1,404 @@
+#include "graphics/GLState.hpp"
+
+#include <cstring>
+#include <unordered_set>
+
+static const unsigned int UNKNOWN = 0xFFFFFFFFu;
+
+enum TEXTURE_TARGETS
+{
+	TARGET_2D,
+	TARGET_2D_ARRAY,
+	TARGET_3D,
+	TARGET_CUBE_MAP,
+	TARGET_COUNT
+};
+
+enum BUFFER_TARGETS
+{
+	BUFFER_ARRAY,
+	BUFFER_ELEMENT_ARRAY,
+	BUFFER_UNIFORM,
+	BUFFER_PIXEL_UNPACK,
+	BUFFER_PIXEL_PACK,
+	BUFFER_COPY_READ,
+	BUFFER_COPY_WRITE,
+	BUFFER_COUNT
+};
+
+struct RangeBinding
+{
+	unsigned int buffer;
+	GLintptr offset;
+	GLsizeiptr size;
+};
+
+static unsigned int s_program;
+static unsigned int s_vao;
+static unsigned int s_framebuffer;
+static unsigned int s_buffers[BUFFER_COUNT];
+static RangeBinding s_uniformRanges[GLState::MAX_UNIFORM_BINDINGS];
+static unsigned int s_activeUnit;
+static unsigned int s_textures[GLState::MAX_TEXTURE_UNITS][TARGET_COUNT];
+static GLenum s_polygonMode;
+static int s_blend, s_depthTest, s_cullFace;
+static GLenum s_blendSource, s_blendDestination, s_depthFunc;
+static float s_clearColor[4];
+static int s_viewport[4];
+
+static GLState::Counters s_current = {0, 0};
+static GLState::Counters s_last = {0, 0};
+
+static std::unordered_set<unsigned int> s_usedPrograms;
+static std::vector<unsigned int> s_firstUses;
+static std::vector<unsigned int> s_lastFirstUses;
+
+static int textureTarget(const GLenum &target)
+{
+	switch (target)
+	{
+	case GL_TEXTURE_2D:
+		return TARGET_2D;
+	case GL_TEXTURE_2D_ARRAY:
+		return TARGET_2D_ARRAY;
+	case GL_TEXTURE_3D:
+		return TARGET_3D;
+	case GL_TEXTURE_CUBE_MAP:
+		return TARGET_CUBE_MAP;
+	default:
+		return -1;
+	}
+}
+
+static int bufferTarget(const GLenum &target)
+{
+	switch (target)
+	{
+	case GL_ARRAY_BUFFER:
+		return BUFFER_ARRAY;
+	case GL_ELEMENT_ARRAY_BUFFER:
+		return BUFFER_ELEMENT_ARRAY;
+	case GL_UNIFORM_BUFFER:
+		return BUFFER_UNIFORM;
+	case GL_PIXEL_UNPACK_BUFFER:
+		return BUFFER_PIXEL_UNPACK;
+	case GL_PIXEL_PACK_BUFFER:
+		return BUFFER_PIXEL_PACK;
+	case GL_COPY_READ_BUFFER:
+		return BUFFER_COPY_READ;
+	case GL_COPY_WRITE_BUFFER:
+		return BUFFER_COPY_WRITE;
+	default:
+		return -1;
+	}
+}
+
+// returns true (and counts an issued call) if cached differs from value, updating it
+template <typename T>
+static bool changes(T &cached, const T &value)
+{
+	if (cached == value)
+	{
+		s_current.elided++;
+		return false;
+	}
+	cached = value;
+	s_current.issued++;
+	return true;
+}
+
+void GLState::useProgram(const unsigned int &program)
+{
+	if (changes(s_program, program))
+	{
+		glUseProgram(program);
+		// only reached when the program actually changes, so the lookup stays off the common path
+		if (s_usedPrograms.insert(program).second)
+		{
+			s_firstUses.push_back(program);
+		}
+	}
+}
+
+void GLState::bindFramebuffer(const unsigned int &framebuffer)
+{
+	if (changes(s_framebuffer, framebuffer))
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	}
+}
+
+void GLState::bindVertexArray(const unsigned int &vao)
+{
+	if (changes(s_vao, vao))
+	{
+		glBindVertexArray(vao);
+		// the element array binding is part of the VAO
+		s_buffers[BUFFER_ELEMENT_ARRAY] = UNKNOWN;
+	}
+}
+
+void GLState::bindBuffer(const GLenum &target, const unsigned int &buffer)
+{
+	int index = bufferTarget(target);
+	if (index < 0)
+	{
+		s_current.issued++;
+		glBindBuffer(target, buffer);
+		return;
+	}
+	if (changes(s_buffers[index], buffer))
+	{
+		glBindBuffer(target, buffer);
+	}
+}
+
+void GLState::bindBufferRange(const GLenum &target, const unsigned int &index, const unsigned int &buffer, const GLintptr &offset, const GLsizeiptr &size)
+{
+	if (target != GL_UNIFORM_BUFFER || index >= (unsigned int)MAX_UNIFORM_BINDINGS)
+	{
+		s_current.issued++;
+		glBindBufferRange(target, index, buffer, offset, size);
+		return;
+	}
+
+	RangeBinding &range = s_uniformRanges[index];
+	if (range.buffer == buffer && range.offset == offset && range.size == size)
+	{
+		s_current.elided++;
+		return;
+	}
+	range = {buffer, offset, size};
+	// binding a range also binds the generic target
+	s_buffers[BUFFER_UNIFORM] = buffer;
+	s_current.issued++;
+	glBindBufferRange(target, index, buffer, offset, size);
+}
+
+void GLState::bindTexture(const unsigned int &unit, const GLenum &target, const unsigned int &texture)
+{
+	int index = textureTarget(target);
+	if (unit >= (unsigned int)MAX_TEXTURE_UNITS || index < 0)
+	{
+		s_current.issued += 2;
+		s_activeUnit = UNKNOWN;
+		glActiveTexture(GL_TEXTURE0 + unit);
+		glBindTexture(target, texture);
+		return;
+	}
+
+	// the unit is selected even when the bind is elided, callers edit the texture through it. It is
+	// not a binding of its own, so only the switch is counted and the bind alone decides elided or issued
+	if (s_activeUnit != unit)
+	{
+		s_activeUnit = unit;
+		s_current.issued++;
+		glActiveTexture(GL_TEXTURE0 + unit);
+	}
+	if (changes(s_textures[unit][index], texture))
+	{
+		glBindTexture(target, texture);
+	}
+}
+
+void GLState::polygonMode(const GLenum &mode)
+{
+	if (changes(s_polygonMode, mode))
+	{
+		glPolygonMode(GL_FRONT_AND_BACK, mode);
+	}
+}
+
+void GLState::setEnabled(const GLenum &capability, const bool &enabled)
+{
+	int *cached = NULL;
+	switch (capability)
+	{
+	case GL_BLEND:
+		cached = &s_blend;
+		break;
+	case GL_DEPTH_TEST:
+		cached = &s_depthTest;
+		break;
+	case GL_CULL_FACE:
+		cached = &s_cullFace;
+		break;
+	}
+
+	if (cached != NULL && !changes(*cached, (int)enabled))
+	{
+		return;
+	}
+	if (cached == NULL)
+	{
+		s_current.issued++;
+	}
+	if (enabled)
+	{
+		glEnable(capability);
+	}
+	else
+	{
+		glDisable(capability);
+	}
+}
+
+void GLState::blendFunc(const GLenum &source, const GLenum &destination)
+{
+	if (s_blendSource == source && s_blendDestination == destination)
+	{
+		s_current.elided++;
+		return;
+	}
+	s_blendSource = source;
+	s_blendDestination = destination;
+	s_current.issued++;
+	glBlendFunc(source, destination);
+}
+
+void GLState::depthFunc(const GLenum &func)
+{
+	if (changes(s_depthFunc, func))
+	{
+		glDepthFunc(func);
+	}
+}
+
+void GLState::clearColor(const float &r, const float &g, const float &b, const float &a)
+{
+	const float color[4] = {r, g, b, a};
+	if (memcmp(s_clearColor, color, sizeof(color)) == 0)
+	{
+		s_current.elided++;
+		return;
+	}
+	memcpy(s_clearColor, color, sizeof(color));
+	s_current.issued++;
+	glClearColor(r, g, b, a);
+}
+
+void GLState::viewport(const int &x, const int &y, const int &width, const int &height)
+{
+	const int rect[4] = {x, y, width, height};
+	if (memcmp(s_viewport, rect, sizeof(rect)) == 0)
+	{
+		s_current.elided++;
+		return;
+	}
+	memcpy(s_viewport, rect, sizeof(rect));
+	s_current.issued++;
+	glViewport(x, y, width, height);
+}
+
+void GLState::deleteProgram(const unsigned int &program)
+{
+	// a program in use stays alive until unbound, but its name must not match a future one
+	if (s_program == program)
+	{
+		s_program = UNKNOWN;
+	}
+	// a later program may get the same name and deserves its own first use
+	s_usedPrograms.erase(program);
+	glDeleteProgram(program);
+}
+
+void GLState::deleteVertexArray(const unsigned int &vao)
+{
+	if (s_vao == vao)
+	{
+		s_vao = 0;
+		s_buffers[BUFFER_ELEMENT_ARRAY] = UNKNOWN;
+	}
+	glDeleteVertexArrays(1, &vao);
+}
+
+void GLState::deleteBuffer(const unsigned int &buffer)
+{
+	for (unsigned int &bound : s_buffers)
+	{
+		if (bound == buffer)
+		{
+			bound = 0;
+		}
+	}
+	for (RangeBinding &range : s_uniformRanges)
+	{
+		if (range.buffer == buffer)
+		{
+			range = {0, 0, 0};
+		}
+	}
+	glDeleteBuffers(1, &buffer);
+}
+
+void GLState::deleteTexture(const unsigned int &texture)
+{
+	for (auto &unit : s_textures)
+	{
+		for (unsigned int &bound : unit)
+		{
+			if (bound == texture)
+			{
+				bound = 0;
+			}
+		}
+	}
+	glDeleteTextures(1, &texture);
+}
+
+void GLState::invalidate()
+{
+	s_program = UNKNOWN;
+	s_vao = UNKNOWN;
+	s_framebuffer = UNKNOWN;
+	for (unsigned int &buffer : s_buffers)
+	{
+		buffer = UNKNOWN;
+	}
+	for (RangeBinding &range : s_uniformRanges)
+	{
+		range = {UNKNOWN, -1, -1};
+	}
+	s_activeUnit = UNKNOWN;
+	for (auto &unit : s_textures)
+	{
+		for (unsigned int &texture : unit)
+		{
+			texture = UNKNOWN;
+		}
+	}
+	s_polygonMode = UNKNOWN;
+	s_blend = s_depthTest = s_cullFace = -1;
+	s_blendSource = s_blendDestination = s_depthFunc = UNKNOWN;
+	for (float &c : s_clearColor)
+	{
+		c = -1.f;
+	}
+	for (int &v : s_viewport)
+	{
+		v = -1;
+	}
+}
+
+void GLState::endFrame()
+{
+	s_last = s_current;
+	s_current = {0, 0};
+	s_lastFirstUses.swap(s_firstUses);
+	s_firstUses.clear();
+}
+
+const GLState::Counters &GLState::lastFrame()
+{
+	return s_last;
+}
+
+const GLState::Counters &GLState::currentFrame()
+{
+	return s_current;
+}
+
+const std::vector<unsigned int> &GLState::lastFrameFirstUses()
+{
+	return s_lastFirstUses;
+}
\ No newline at end of file
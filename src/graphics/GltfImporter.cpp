@@ -0,0 +1,180 @@
+#include "graphics/GltfImporter.hpp"
+#include "graphics/GLState.hpp"
+#include "graphics/TextureFormat.hpp"
+#include "util/ThreadPool.hpp"
+
+#include <chrono>
+#include <iostream>
+
+using namespace std;
+
+static unsigned int createBuffer(const void *data, const size_t &size)
+{
+	unsigned int buffer;
+	glGenBuffers(1, &buffer);
+	GLState::bindBuffer(GL_ARRAY_BUFFER, buffer);
+	glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)size, data, GL_STATIC_DRAW);
+	return buffer;
+}
+
+static unsigned int createTexture(const GltfPreparedImage &image)
+{
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	GLState::bindTexture(0, GL_TEXTURE_2D, texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	PixelFormat format = TextureFormat::forChannels(image.channels);
+	TextureFormat::allocate2D(GL_TEXTURE_2D, (int)image.levels.size(), format, image.levels[0].width, image.levels[0].height);
+	for (size_t level = 0; level < image.levels.size(); level++)
+	{
+		const TextureLevel &mip = image.levels[level];
+		glPixelStorei(GL_UNPACK_ALIGNMENT, TextureFormat::unpackAlignment(mip.width, format.channels));
+		glTexSubImage2D(GL_TEXTURE_2D, (GLint)level, 0, 0, mip.width, mip.height, format.format, GL_UNSIGNED_BYTE, mip.data.data());
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	TextureFormat::setSwizzle(GL_TEXTURE_2D, format.channels);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)image.levels.size() - 1);
+	return texture;
+}
+
+bool GltfImporter::import(const std::string &path, GltfScene &scene, GltfImportStats *stats)
+{
+	scene = GltfScene();
+	auto start = chrono::steady_clock::now();
+	GltfDocument document;
+	if (!GltfFile::open(path, document))
+	{
+		return false;
+	}
+	auto opened = chrono::steady_clock::now();
+
+	GltfPrepared prepared;
+	if (!GltfFile::prepare(document, prepared))
+	{
+		return false;
+	}
+	// RGB is padded where the driver would do it itself, after the mips like TextureLoader does
+	ThreadPool::shared().parallelFor(0, (int)prepared.images.size(), [&prepared](int i)
+									 {
+										 GltfPreparedImage &image = prepared.images[i];
+										 if (!image.levels.empty() && TextureFormat::uploadChannels(image.channels) != image.channels)
+										 {
+											 for (TextureLevel &level : image.levels)
+											 {
+												 TextureFormat::padToRgba(level);
+											 }
+											 image.channels = 4;
+										 } });
+	auto ready = chrono::steady_clock::now();
+
+	vector<unsigned int> viewBuffers(document.bufferViews.size(), 0);
+	for (size_t i = 0; i < document.bufferViews.size(); i++)
+	{
+		if (prepared.viewUsed[i])
+		{
+			// the driver reads straight from the mapping
+			viewBuffers[i] = createBuffer(GltfFile::viewData(document, (int)i), document.bufferViews[i].length);
+			scene.buffers.push_back(viewBuffers[i]);
+		}
+	}
+
+	size_t textureBytes = 0;
+	for (const GltfPreparedImage &image : prepared.images)
+	{
+		scene.textures.push_back(image.levels.empty() ? 0 : createTexture(image));
+		for (const TextureLevel &level : image.levels)
+		{
+			textureBytes += level.data.size();
+		}
+	}
+
+	size_t triangles = 0;
+	for (const GltfPreparedPrimitive &primitive : prepared.primitives)
+	{
+		GltfDraw draw = {};
+		glGenVertexArrays(1, &draw.vao);
+		GLState::bindVertexArray(draw.vao);
+		for (const GltfStream &stream : primitive.attributes)
+		{
+			unsigned int buffer = stream.bufferView >= 0 ? viewBuffers[stream.bufferView] : createBuffer(stream.converted.data(), stream.converted.size());
+			if (stream.bufferView < 0)
+			{
+				scene.buffers.push_back(buffer);
+			}
+			GLState::bindBuffer(GL_ARRAY_BUFFER, buffer);
+			// glTF component types are the GL enums
+			glVertexAttribPointer(stream.location, stream.components, stream.componentType, stream.normalized ? GL_TRUE : GL_FALSE,
+								  (GLsizei)stream.stride, (void *)stream.offset);
+			glEnableVertexAttribArray(stream.location);
+		}
+
+		const GltfStream &indices = primitive.indices;
+		unsigned int indexBuffer = indices.bufferView >= 0 ? viewBuffers[indices.bufferView] : 0;
+		if (!indexBuffer)
+		{
+			glGenBuffers(1, &indexBuffer);
+			scene.buffers.push_back(indexBuffer);
+			GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)indices.converted.size(), indices.converted.data(), GL_STATIC_DRAW);
+		}
+		else
+		{
+			GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+		}
+
+		draw.indexCount = (GLsizei)primitive.indexCount;
+		draw.indexType = indices.componentType;
+		draw.indexOffset = indices.offset;
+		if (primitive.material >= 0 && document.materials[primitive.material].baseColorImage >= 0)
+		{
+			draw.texture = scene.textures[document.materials[primitive.material].baseColorImage];
+		}
+		scene.draws.push_back(draw);
+		triangles += primitive.indexCount / 3;
+	}
+	GLState::bindVertexArray(0);
+	scene.bounds = prepared.bounds;
+	auto uploaded = chrono::steady_clock::now();
+
+	if (prepared.skipped > 0)
+	{
+		cout << "WARNING::GLTF_IMPORTER::SKIPPED_PRIMITIVES " << prepared.skipped << " in " << path << " are not triangle lists" << endl;
+	}
+	if (stats)
+	{
+		stats->openMs = chrono::duration<double, milli>(opened - start).count();
+		stats->prepareMs = chrono::duration<double, milli>(ready - opened).count();
+		stats->uploadMs = chrono::duration<double, milli>(uploaded - ready).count();
+		stats->viewBytes = prepared.viewBytes;
+		stats->convertedBytes = prepared.convertedBytes;
+		stats->textureBytes = textureBytes;
+		stats->triangles = triangles;
+		stats->images = (int)prepared.images.size();
+		stats->skipped = prepared.skipped;
+	}
+	return true;
+}
+
+void GltfImporter::destroy(GltfScene &scene)
+{
+	for (const GltfDraw &draw : scene.draws)
+	{
+		GLState::deleteVertexArray(draw.vao);
+	}
+	for (unsigned int buffer : scene.buffers)
+	{
+		GLState::deleteBuffer(buffer);
+	}
+	for (unsigned int texture : scene.textures)
+	{
+		if (texture)
+		{
+			GLState::deleteTexture(texture);
+		}
+	}
+	scene = GltfScene();
+}
\ No newline at end of file
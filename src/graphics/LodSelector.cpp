@@ -0,0 +1,58 @@
+#include "graphics/LodSelector.hpp"
+
+using namespace std;
+
+LodSelector::LodSelector() : m_pixelError(DEFAULT_PIXEL_ERROR), m_hysteresis(DEFAULT_HYSTERESIS), m_counters() {}
+
+void LodSelector::create(const float &pixelError, const float &hysteresis)
+{
+	m_pixelError = pixelError;
+	m_hysteresis = hysteresis;
+	m_levels.clear();
+	m_counters = Counters();
+}
+
+void LodSelector::update(const std::vector<std::vector<MeshLod>> &chains, const float &pixelsPerUnit)
+{
+	// draws start at full detail and settle within a frame
+	m_levels.resize(chains.size(), 0);
+	m_counters.fullTriangles = 0;
+	m_counters.drawnTriangles = 0;
+	float finer = m_pixelError * (1.0f + m_hysteresis), coarser = m_pixelError * (1.0f - m_hysteresis);
+	for (size_t draw = 0; draw < chains.size(); draw++)
+	{
+		const vector<MeshLod> &chain = chains[draw];
+		if (chain.empty())
+		{
+			m_levels[draw] = 0;
+			continue;
+		}
+
+		size_t level = min(m_levels[draw], chain.size() - 1);
+		while (level > 0 && chain[level].error * pixelsPerUnit > finer)
+		{
+			level--;
+		}
+		while (level + 1 < chain.size() && chain[level + 1].error * pixelsPerUnit < coarser)
+		{
+			level++;
+		}
+		if (level != m_levels[draw])
+		{
+			m_counters.switches++;
+			m_levels[draw] = level;
+		}
+		m_counters.fullTriangles += chain[0].indexCount / 3;
+		m_counters.drawnTriangles += chain[level].indexCount / 3;
+	}
+}
+
+size_t LodSelector::level(const size_t &draw) const
+{
+	return draw < m_levels.size() ? m_levels[draw] : 0;
+}
+
+const LodSelector::Counters &LodSelector::counters() const
+{
+	return m_counters;
+}
\ No newline at end of file
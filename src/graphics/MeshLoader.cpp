@@ -0,0 +1,100 @@
+#include "graphics/MeshLoader.hpp"
+#include "graphics/GLState.hpp"
+#include "util/MappedFile.hpp"
+
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+GLenum MeshLoader::glType(const uint32_t &type)
+{
+	switch (type)
+	{
+	case MESH_FLOAT16:
+		return GL_HALF_FLOAT;
+	case MESH_INT8:
+		return GL_BYTE;
+	case MESH_UINT8:
+		return GL_UNSIGNED_BYTE;
+	case MESH_INT16:
+		return GL_SHORT;
+	case MESH_UINT16:
+		return GL_UNSIGNED_SHORT;
+	default:
+		return GL_FLOAT;
+	}
+}
+
+bool MeshLoader::load(const std::string &path, GpuMesh &mesh)
+{
+	MappedFile file;
+	MeshFileView view;
+	if (!file.open(path) || !MeshFile::parse(file.data(), file.size(), view))
+	{
+		cout << "ERROR::MESH_LOADER::INVALID_FILE " << path << endl;
+		return false;
+	}
+	upload(view, mesh);
+	return true;
+}
+
+void MeshLoader::upload(const std::vector<MeshAttribute> &attributes, const uint32_t &stride, const void *vertices, const size_t &vertexBytes,
+						const void *indices, const size_t &indexCount, const uint32_t &indexSize, GpuMesh &mesh)
+{
+	glGenVertexArrays(1, &mesh.vao);
+	glGenBuffers(1, &mesh.vertexBuffer);
+	glGenBuffers(1, &mesh.indexBuffer);
+
+	GLState::bindVertexArray(mesh.vao);
+	GLState::bindBuffer(GL_ARRAY_BUFFER, mesh.vertexBuffer);
+	glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)vertexBytes, vertices, GL_STATIC_DRAW);
+	GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.indexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)(indexCount * indexSize), indices, GL_STATIC_DRAW);
+
+	for (const MeshAttribute &attribute : attributes)
+	{
+		glVertexAttribPointer(attribute.location, attribute.components, glType(attribute.type), attribute.normalized ? GL_TRUE : GL_FALSE,
+							  stride, (void *)(size_t)attribute.offset);
+		glEnableVertexAttribArray(attribute.location);
+	}
+
+	mesh.indexCount = (GLsizei)indexCount;
+	mesh.indexType = indexSize == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+void MeshLoader::upload(const MeshFileView &view, GpuMesh &mesh)
+{
+	// the driver reads straight from the mapped file
+	upload(view.attributes, view.header.stride, view.vertices, view.vertexBytes, view.indices, view.header.indexCount, view.header.indexSize, mesh);
+	mesh.bounds = view.header.bounds;
+	memcpy(mesh.dequantizeScale, view.header.dequantizeScale, sizeof(mesh.dequantizeScale));
+	memcpy(mesh.dequantizeOffset, view.header.dequantizeOffset, sizeof(mesh.dequantizeOffset));
+	mesh.lods = view.lods;
+}
+
+void MeshLoader::upload(const MeshData &data, GpuMesh &mesh)
+{
+	size_t vertexCount = data.stride ? data.vertices.size() / data.stride : 0;
+	if (vertexCount <= 0x10000)
+	{
+		vector<uint16_t> narrow(data.indices.begin(), data.indices.end());
+		upload(data.attributes, data.stride, data.vertices.data(), data.vertices.size(), narrow.data(), narrow.size(), 2, mesh);
+	}
+	else
+	{
+		upload(data.attributes, data.stride, data.vertices.data(), data.vertices.size(), data.indices.data(), data.indices.size(), 4, mesh);
+	}
+	mesh.bounds = MeshFile::computeBounds(data);
+	memcpy(mesh.dequantizeScale, data.dequantizeScale, sizeof(mesh.dequantizeScale));
+	memcpy(mesh.dequantizeOffset, data.dequantizeOffset, sizeof(mesh.dequantizeOffset));
+	mesh.lods = data.lods;
+}
+
+void MeshLoader::destroy(GpuMesh &mesh)
+{
+	GLState::deleteVertexArray(mesh.vao);
+	GLState::deleteBuffer(mesh.vertexBuffer);
+	GLState::deleteBuffer(mesh.indexBuffer);
+	mesh = GpuMesh();
+}
\ No newline at end of file
@@ -0,0 +1,246 @@
+#include "graphics/ParameterBlock.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+static bool describe(const GLenum &type, int &components, bool &isInt)
+{
+	isInt = false;
+	switch (type)
+	{
+	case GL_FLOAT:
+		components = 1;
+		return true;
+	case GL_FLOAT_VEC2:
+		components = 2;
+		return true;
+	case GL_FLOAT_VEC3:
+		components = 3;
+		return true;
+	case GL_FLOAT_VEC4:
+		components = 4;
+		return true;
+	case GL_FLOAT_MAT3:
+		components = 9;
+		return true;
+	case GL_FLOAT_MAT4:
+		components = 16;
+		return true;
+	case GL_INT:
+	case GL_UNSIGNED_INT:
+	case GL_BOOL:
+	case GL_SAMPLER_1D:
+	case GL_SAMPLER_2D:
+	case GL_SAMPLER_3D:
+	case GL_SAMPLER_CUBE:
+	case GL_SAMPLER_2D_ARRAY:
+	case GL_SAMPLER_2D_SHADOW:
+	case GL_SAMPLER_2D_ARRAY_SHADOW:
+	case GL_SAMPLER_BUFFER:
+	// integer samplers take a texture unit like any other
+	case GL_INT_SAMPLER_1D:
+	case GL_INT_SAMPLER_2D:
+	case GL_INT_SAMPLER_3D:
+	case GL_INT_SAMPLER_CUBE:
+	case GL_INT_SAMPLER_2D_ARRAY:
+	case GL_INT_SAMPLER_BUFFER:
+	case GL_UNSIGNED_INT_SAMPLER_1D:
+	case GL_UNSIGNED_INT_SAMPLER_2D:
+	case GL_UNSIGNED_INT_SAMPLER_3D:
+	case GL_UNSIGNED_INT_SAMPLER_CUBE:
+	case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+	case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+		components = 1;
+		isInt = true;
+		return true;
+	default:
+		return false;
+	}
+}
+
+void ParameterBlock::add(const std::string &name, const int &location, const GLenum &type)
+{
+	Param param = {};
+	param.hash = Hash::fnv1a(name.c_str(), name.size());
+	param.location = location;
+	param.type = type;
+	if (!describe(type, param.components, param.isInt))
+	{
+		// not a type this block handles, the location setters on Shader still work
+		cout << "WARNING::PARAMETER_BLOCK::UNSUPPORTED_TYPE " << name << " (0x" << hex << type << dec << ")" << endl;
+		return;
+	}
+	m_params.push_back(param);
+}
+
+void ParameterBlock::sort()
+{
+	std::sort(m_params.begin(), m_params.end(), [](const Param &a, const Param &b)
+			  { return a.hash < b.hash; });
+	for (size_t i = 1; i < m_params.size(); i++)
+	{
+		if (m_params[i].hash == m_params[i - 1].hash && m_params[i].location != m_params[i - 1].location)
+		{
+			cout << "WARNING::PARAMETER_BLOCK::HASH_COLLISION at locations " << m_params[i - 1].location << " and " << m_params[i].location << endl;
+		}
+	}
+	m_dirty.clear();
+}
+
+ParameterBlock::Param *ParameterBlock::find(const uint32_t &name)
+{
+	auto it = lower_bound(m_params.begin(), m_params.end(), name, [](const Param &p, const uint32_t &h)
+						  { return p.hash < h; });
+	return it != m_params.end() && it->hash == name ? &*it : NULL;
+}
+
+bool ParameterBlock::has(const uint32_t &name) const
+{
+	auto it = lower_bound(m_params.begin(), m_params.end(), name, [](const Param &p, const uint32_t &h)
+						  { return p.hash < h; });
+	return it != m_params.end() && it->hash == name;
+}
+
+void ParameterBlock::write(const uint32_t &name, const float *values, const int &components)
+{
+	Param *param = find(name);
+	if (param == NULL || param->isInt || param->components != components)
+	{
+		return;
+	}
+	if (memcmp(param->value.f, values, components * sizeof(float)) == 0)
+	{
+		return;
+	}
+	memcpy(param->value.f, values, components * sizeof(float));
+	if (!param->dirty)
+	{
+		param->dirty = true;
+		m_dirty.push_back((unsigned int)(param - m_params.data()));
+	}
+}
+
+void ParameterBlock::write(const uint32_t &name, const int *values, const int &components)
+{
+	Param *param = find(name);
+	if (param == NULL || !param->isInt || param->components != components)
+	{
+		return;
+	}
+	if (memcmp(param->value.i, values, components * sizeof(int)) == 0)
+	{
+		return;
+	}
+	memcpy(param->value.i, values, components * sizeof(int));
+	if (!param->dirty)
+	{
+		param->dirty = true;
+		m_dirty.push_back((unsigned int)(param - m_params.data()));
+	}
+}
+
+void ParameterBlock::setBool(const uint32_t &name, bool value)
+{
+	int v = (int)value;
+	write(name, &v, 1);
+}
+
+void ParameterBlock::setInt(const uint32_t &name, int value)
+{
+	write(name, &value, 1);
+}
+
+void ParameterBlock::setFloat(const uint32_t &name, float value)
+{
+	write(name, &value, 1);
+}
+
+void ParameterBlock::setVec2(const uint32_t &name, float x, float y)
+{
+	float v[] = {x, y};
+	write(name, v, 2);
+}
+
+void ParameterBlock::setVec3(const uint32_t &name, float x, float y, float z)
+{
+	float v[] = {x, y, z};
+	write(name, v, 3);
+}
+
+void ParameterBlock::setVec4(const uint32_t &name, float x, float y, float z, float w)
+{
+	float v[] = {x, y, z, w};
+	write(name, v, 4);
+}
+
+void ParameterBlock::setMat3(const uint32_t &name, const float *value)
+{
+	write(name, value, 9);
+}
+
+void ParameterBlock::setMat4(const uint32_t &name, const float *value)
+{
+	write(name, value, 16);
+}
+
+void ParameterBlock::upload(const Param &param) const
+{
+	switch (param.type)
+	{
+	case GL_FLOAT:
+		glUniform1fv(param.location, 1, param.value.f);
+		break;
+	case GL_FLOAT_VEC2:
+		glUniform2fv(param.location, 1, param.value.f);
+		break;
+	case GL_FLOAT_VEC3:
+		glUniform3fv(param.location, 1, param.value.f);
+		break;
+	case GL_FLOAT_VEC4:
+		glUniform4fv(param.location, 1, param.value.f);
+		break;
+	case GL_FLOAT_MAT3:
+		glUniformMatrix3fv(param.location, 1, GL_FALSE, param.value.f);
+		break;
+	case GL_FLOAT_MAT4:
+		glUniformMatrix4fv(param.location, 1, GL_FALSE, param.value.f);
+		break;
+	case GL_UNSIGNED_INT:
+		glUniform1ui(param.location, (GLuint)param.value.i[0]);
+		break;
+	default:
+		glUniform1iv(param.location, 1, param.value.i);
+		break;
+	}
+}
+
+void ParameterBlock::flush()
+{
+	for (unsigned int index : m_dirty)
+	{
+		upload(m_params[index]);
+		m_params[index].dirty = false;
+	}
+	m_dirty.clear();
+}
+
+void ParameterBlock::adopt(const ParameterBlock &other)
+{
+	for (const Param &source : other.m_params)
+	{
+		Param *param = find(source.hash);
+		if (param == NULL || param->type != source.type)
+		{
+			continue;
+		}
+		param->value = source.value;
+		if (!param->dirty)
+		{
+			param->dirty = true;
+			m_dirty.push_back((unsigned int)(param - m_params.data()));
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "graphics/PipelineWarmup.hpp"
+#include "graphics/GLState.hpp"
+
+#include <chrono>
+#include <iostream>
+
+using namespace std;
+
+double PipelineWarmup::run(const std::vector<Shader *> &shaders, const std::vector<unsigned int> &vaos, const std::vector<GLenum> &indexTypes)
+{
+	auto start = chrono::steady_clock::now();
+
+	int viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+
+	unsigned int framebuffer, colorBuffer;
+	glGenFramebuffers(1, &framebuffer);
+	glGenRenderbuffers(1, &colorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, 1, 1);
+	GLState::bindFramebuffer(framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+	GLState::viewport(0, 0, 1, 1);
+
+	for (Shader *shader : shaders)
+	{
+		if (!shader->isLinked())
+		{
+			continue;
+		}
+		shader->use();
+		shader->params.flush();
+		for (size_t i = 0; i < vaos.size(); i++)
+		{
+			GLState::bindVertexArray(vaos[i]);
+
+			int elementBuffer = 0;
+			glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &elementBuffer);
+			if (elementBuffer != 0)
+			{
+				glDrawElements(GL_TRIANGLES, 3, i < indexTypes.size() ? indexTypes[i] : GL_UNSIGNED_INT, 0);
+			}
+			else
+			{
+				glDrawArrays(GL_TRIANGLES, 0, 3);
+			}
+		}
+	}
+	glFinish();
+
+	GLState::bindFramebuffer(0);
+	GLState::viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+	glDeleteFramebuffers(1, &framebuffer);
+	glDeleteRenderbuffers(1, &colorBuffer);
+
+	// the first uses happened here, keep them out of the first real frame
+	GLState::endFrame();
+
+	chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+	return elapsed.count();
+}
+
+HitchDetector::HitchDetector(const double &budgetMs) : m_budgetMs(budgetMs), m_frameStart(0.0), m_frame(0), m_hitches(0) {}
+
+void HitchDetector::beginFrame(const double &now)
+{
+	m_frameStart = now;
+}
+
+void HitchDetector::endFrame(const double &now)
+{
+	m_frame++;
+	double frameMs = (now - m_frameStart) * 1000.0;
+	const vector<unsigned int> &firstUses = GLState::lastFrameFirstUses();
+	if (frameMs <= m_budgetMs || firstUses.empty())
+	{
+		return;
+	}
+
+	m_hitches++;
+	cout << "HITCH::FIRST_USE frame " << m_frame << " took " << frameMs << " ms (budget " << m_budgetMs << " ms), first use of program";
+	for (unsigned int program : firstUses)
+	{
+		cout << " " << program;
+	}
+	cout << endl;
+}
+
+unsigned int HitchDetector::hitches() const
+{
+	return m_hitches;
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#include "graphics/PixelUploadRing.hpp"
+#include "graphics/GLState.hpp"
+
+#include <cstddef>
+
+PixelUploadRing::PixelUploadRing() : m_next(0) {}
+
+void PixelUploadRing::create(const int &slots)
+{
+	m_next = 0;
+	m_slots.resize(slots);
+	for (Slot &slot : m_slots)
+	{
+		glGenBuffers(1, &slot.buffer);
+		slot.capacity = 0;
+		slot.fence = 0;
+	}
+}
+
+void PixelUploadRing::destroy()
+{
+	for (Slot &slot : m_slots)
+	{
+		if (slot.fence)
+		{
+			glDeleteSync(slot.fence);
+		}
+		GLState::deleteBuffer(slot.buffer);
+	}
+	m_slots.clear();
+}
+
+bool PixelUploadRing::ready()
+{
+	Slot &slot = m_slots[m_next];
+	if (!slot.fence)
+	{
+		return true;
+	}
+	// never wait here, a busy slot just means trying again next frame
+	GLenum state = glClientWaitSync(slot.fence, 0, 0);
+	if (state == GL_TIMEOUT_EXPIRED)
+	{
+		return false;
+	}
+	glDeleteSync(slot.fence);
+	slot.fence = 0;
+	return true;
+}
+
+unsigned char *PixelUploadRing::map(const GLsizeiptr &size)
+{
+	Slot &slot = m_slots[m_next];
+	GLState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+	if (size > slot.capacity)
+	{
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+		slot.capacity = size;
+	}
+	return (unsigned char *)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+}
+
+void PixelUploadRing::unmap()
+{
+	glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+}
+
+void PixelUploadRing::submit()
+{
+	Slot &slot = m_slots[m_next];
+	if (slot.fence)
+	{
+		glDeleteSync(slot.fence);
+	}
+	slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	GLState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	m_next = (m_next + 1) % (int)m_slots.size();
+}
\ No newline at end of file
@@ -0,0 +1,160 @@
+#include "graphics/ProgramCache.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+
+using namespace std;
+
+static const uint32_t CACHE_MAGIC = 0x50424331; // "PBC1"
+
+string ProgramCache::m_directory = "./cache/shaders/";
+atomic<int> ProgramCache::hits(0);
+atomic<int> ProgramCache::misses(0);
+
+static uint64_t fnv1a(uint64_t hash, const char *data, size_t length)
+{
+	for (size_t i = 0; i < length; i++)
+	{
+		hash ^= (unsigned char)data[i];
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+static uint64_t fnv1a(uint64_t hash, const string &s)
+{
+	// hash the terminator too so "ab"+"c" and "a"+"bc" differ
+	return fnv1a(hash, s.c_str(), s.size() + 1);
+}
+
+// one of the binary formats this driver accepts
+static bool supportsFormat(const uint32_t &format)
+{
+	int count = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &count);
+	vector<int> formats(max(count, 0));
+	if (count > 0)
+	{
+		glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats.data());
+	}
+	return find(formats.begin(), formats.end(), (int)format) != formats.end();
+}
+
+void ProgramCache::setDirectory(const std::string &directory)
+{
+	m_directory = directory;
+}
+
+string ProgramCache::pathFor(const std::string &vertexCode, const std::string &fragmentCode)
+{
+	const char *renderer = (const char *)glGetString(GL_RENDERER);
+	const char *version = (const char *)glGetString(GL_VERSION);
+
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	hash = fnv1a(hash, vertexCode);
+	hash = fnv1a(hash, fragmentCode);
+	hash = fnv1a(hash, renderer ? renderer : "");
+	hash = fnv1a(hash, version ? version : "");
+
+	char name[17];
+	snprintf(name, sizeof(name), "%016llx", (unsigned long long)hash);
+	return m_directory + name + ".bin";
+}
+
+bool ProgramCache::load(const unsigned int &program, const std::string &vertexCode, const std::string &fragmentCode)
+{
+	if (!GLExtensions::programBinary)
+	{
+		return false;
+	}
+
+	string path = pathFor(vertexCode, fragmentCode);
+	ifstream file(path, ios::binary);
+	if (!file)
+	{
+		misses++;
+		return false;
+	}
+
+	uint32_t magic = 0, format = 0, length = 0;
+	file.read((char *)&magic, sizeof(magic));
+	file.read((char *)&format, sizeof(format));
+	file.read((char *)&length, sizeof(length));
+
+	// the length is only trusted once the header checks out and the file actually holds that many bytes
+	error_code ec;
+	uintmax_t fileSize = filesystem::file_size(path, ec);
+	const uintmax_t headerSize = sizeof(magic) + sizeof(format) + sizeof(length);
+	bool valid = file && !ec && magic == CACHE_MAGIC && supportsFormat(format) && fileSize >= headerSize && length <= fileSize - headerSize;
+	vector<char> binary;
+	if (valid)
+	{
+		binary.resize(length);
+		file.read(binary.data(), length);
+		valid = file.gcount() == (streamsize)length;
+	}
+
+	if (!valid)
+	{
+		cout << "WARNING::PROGRAM_CACHE::CORRUPT_ENTRY " << path << endl;
+		file.close();
+		remove(path.c_str());
+		misses++;
+		return false;
+	}
+
+	glProgramBinary(program, format, binary.data(), length);
+
+	int success;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		// the driver is free to reject binaries, e.g. after an update, fall back to compiling
+		cout << "WARNING::PROGRAM_CACHE::BINARY_REJECTED " << path << endl;
+		file.close();
+		remove(path.c_str());
+		misses++;
+		return false;
+	}
+
+	hits++;
+	return true;
+}
+
+void ProgramCache::store(const unsigned int &program, const std::string &vertexCode, const std::string &fragmentCode)
+{
+	if (!GLExtensions::programBinary)
+	{
+		return;
+	}
+
+	int length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+	{
+		return;
+	}
+
+	vector<char> binary(length);
+	GLenum format = 0;
+	glGetProgramBinary(program, length, NULL, &format, binary.data());
+
+	error_code ec;
+	filesystem::create_directories(m_directory, ec);
+
+	string path = pathFor(vertexCode, fragmentCode);
+	ofstream file(path, ios::binary | ios::trunc);
+	if (!file)
+	{
+		cout << "WARNING::PROGRAM_CACHE::CANNOT_WRITE " << path << endl;
+		return;
+	}
+
+	uint32_t magic = CACHE_MAGIC, binaryFormat = format, binaryLength = length;
+	file.write((const char *)&magic, sizeof(magic));
+	file.write((const char *)&binaryFormat, sizeof(binaryFormat));
+	file.write((const char *)&binaryLength, sizeof(binaryLength));
+	file.write(binary.data(), length);
+}
\ No newline at end of file
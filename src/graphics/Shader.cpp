@@ -1,33 +1,44 @@
 #include "graphics/Shader.hpp"
+#include "graphics/ShaderBatch.hpp"
+#include "graphics/UniformBuffer.hpp"
+#include "graphics/GLState.hpp"
+
+#include <algorithm>
 
 using namespace std;
 
-void Shader::compileShader(const unsigned int &shader, const char *source, const char *name)
+void Shader::compileShader(const unsigned int &shader, const char *source)
 {
-	int success;
-	char infoLog[512];
-
 	glShaderSource(shader, 1, &source, NULL);
 	glCompileShader(shader);
+}
 
-	glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-	glGetShaderInfoLog(shader, 512, NULL, infoLog);
+bool Shader::checkShader(const unsigned int &shader, const char *name)
+{
+	int success;
+	char infoLog[512];
 
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
 	if (!success)
 	{
+		glGetShaderInfoLog(shader, 512, NULL, infoLog);
 		std::cout << "ERROR::SHADER::" << name << "::COMPILATION_FAILED" << endl
 				  << infoLog << std::endl;
 	}
+	return success;
 }
 
-void Shader::linkShaders(const unsigned int &program, unsigned int &vertex, unsigned int &fragment)
+void Shader::linkShaders(const unsigned int &program, const unsigned int &vertex, const unsigned int &fragment)
 {
-	int success;
-	char infoLog[512];
-
 	glAttachShader(program, vertex);
 	glAttachShader(program, fragment);
 	glLinkProgram(program);
+}
+
+bool Shader::checkProgram(const unsigned int &program)
+{
+	int success;
+	char infoLog[512];
 
 	glGetProgramiv(program, GL_LINK_STATUS, &success);
 	if (!success)
@@ -36,74 +47,160 @@ void Shader::linkShaders(const unsigned int &program, unsigned int &vertex, unsi
 		cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED" << endl
 			 << infoLog << endl;
 	}
+	return success;
 }
 
-Shader::Shader(const char *vertexPath, const char *fragmentPath)
+void Shader::cacheUniforms()
 {
-	// 1. retrieve the vertex/fragment source code from filePath
-	string vertexCode, fragmentCode;
-	ifstream vShaderFile, fShaderFile;
-	stringstream vShaderStream, fShaderStream;
+	int count = 0, maxLength = 0;
+	glGetProgramiv(programId, GL_ACTIVE_UNIFORMS, &count);
+	glGetProgramiv(programId, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
 
-	// ensure ifstream objects can throw exceptions:
-	vShaderFile.exceptions(ifstream::failbit | ifstream::badbit);
-	fShaderFile.exceptions(ifstream::failbit | ifstream::badbit);
+	m_uniforms.clear();
+	m_uniforms.reserve(count);
+	params = ParameterBlock();
+	vector<char> nameBuffer(maxLength > 0 ? maxLength : 1);
 
-	try
+	for (int i = 0; i < count; i++)
 	{
-		// open files
-		vShaderFile.open(vertexPath);
-		fShaderFile.open(fragmentPath);
+		int length, size;
+		GLenum type;
+		glGetActiveUniform(programId, i, maxLength, &length, &size, &type, nameBuffer.data());
+
+		string name(nameBuffer.data(), length);
+		int location = glGetUniformLocation(programId, name.c_str());
+		if (location < 0)
+		{
+			// uniforms inside a uniform block have no location
+			continue;
+		}
+
+		m_uniforms.push_back({name, location});
+
+		// arrays are reported as "name[0]", also make them reachable by their plain name
+		size_t bracket = name.find('[');
+		if (bracket != string::npos)
+		{
+			m_uniforms.push_back({name.substr(0, bracket), location});
+		}
+		params.add(name.substr(0, bracket), location, type);
+	}
+	params.sort();
 
-		// read file's buffer contents into streams
-		vShaderStream << vShaderFile.rdbuf();
-		fShaderStream << fShaderFile.rdbuf();
+	sort(m_uniforms.begin(), m_uniforms.end(), [](const Uniform &a, const Uniform &b)
+		 { return a.name < b.name; });
+}
 
-		// close file handlers
-		vShaderFile.close();
-		fShaderFile.close();
+void Shader::bindUniformBlocks()
+{
+	int count = 0, maxLength = 0;
+	glGetProgramiv(programId, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+	glGetProgramiv(programId, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength);
 
-		// convert stream into string
-		vertexCode = vShaderStream.str();
-		fragmentCode = fShaderStream.str();
-	}
-	catch (ifstream::failure e)
+	vector<char> nameBuffer(maxLength > 0 ? maxLength : 1);
+	for (int i = 0; i < count; i++)
 	{
-		cout << "ERROR::SHADER::FILE_NOT_READ " << e.what() << endl;
+		int length;
+		glGetActiveUniformBlockName(programId, i, maxLength, &length, nameBuffer.data());
+
+		unsigned int binding;
+		if (UniformBuffer::bindingFor(string(nameBuffer.data(), length), binding))
+		{
+			glUniformBlockBinding(programId, i, binding);
+		}
+		else
+		{
+			cout << "WARNING::SHADER::UNKNOWN_UNIFORM_BLOCK " << nameBuffer.data() << endl;
+		}
 	}
+}
 
-	const char *vShaderCode = vertexCode.c_str();
-	const char *fShaderCode = fragmentCode.c_str();
+Shader::Shader(const char *vertexPath, const char *fragmentPath)
+{
+	ShaderBatch batch;
+	batch.add(vertexPath, fragmentPath);
+	*this = batch.build().front();
+}
 
-	unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
-	unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+Shader::Shader(const unsigned int &program) : m_linked(false), programId(program)
+{
+	int success;
+	glGetProgramiv(programId, GL_LINK_STATUS, &success);
+	m_linked = success;
+	cacheUniforms();
+	bindUniformBlocks();
+}
 
-	compileShader(vertexShader, vShaderCode, "VERTEX");
-	compileShader(fragmentShader, fShaderCode, "FRAGMENT");
+bool Shader::readFile(const char *path, std::string &out)
+{
+	ifstream file;
+	stringstream stream;
 
-	programId = glCreateProgram();
-	linkShaders(programId, vertexShader, fragmentShader);
+	// ensure ifstream objects can throw exceptions:
+	file.exceptions(ifstream::failbit | ifstream::badbit);
 
-	glDeleteShader(vertexShader);
-	glDeleteShader(fragmentShader);
+	try
+	{
+		file.open(path);
+		stream << file.rdbuf();
+		file.close();
+		out = stream.str();
+	}
+	catch (ifstream::failure &e)
+	{
+		cout << "ERROR::SHADER::FILE_NOT_READ " << path << " " << e.what() << endl;
+		return false;
+	}
+	return true;
 }
 
 void Shader::use()
 {
-	glUseProgram(programId);
+	GLState::useProgram(programId);
+}
+
+bool Shader::isLinked() const
+{
+	return m_linked;
+}
+
+int Shader::getUniformLocation(const std::string &name) const
+{
+	auto it = lower_bound(m_uniforms.begin(), m_uniforms.end(), name, [](const Uniform &u, const std::string &n)
+						  { return u.name < n; });
+	if (it == m_uniforms.end() || it->name != name)
+	{
+		return -1;
+	}
+	return it->location;
 }
 
 void Shader::setBool(const std::string &name, bool value) const
 {
-	glUniform1i(glGetUniformLocation(programId, name.c_str()), (int)value);
+	setBool(getUniformLocation(name), value);
 }
 
 void Shader::setInt(const std::string &name, int value) const
 {
-	glUniform1i(glGetUniformLocation(programId, name.c_str()), value);
+	setInt(getUniformLocation(name), value);
 }
 
 void Shader::setFloat(const std::string &name, float value) const
 {
-	glUniform1f(glGetUniformLocation(programId, name.c_str()), value);
+	setFloat(getUniformLocation(name), value);
+}
+
+void Shader::setBool(int location, bool value) const
+{
+	glUniform1i(location, (int)value);
+}
+
+void Shader::setInt(int location, int value) const
+{
+	glUniform1i(location, value);
+}
+
+void Shader::setFloat(int location, float value) const
+{
+	glUniform1f(location, value);
 }
\ No newline at end of file
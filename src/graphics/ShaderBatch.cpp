@@ -0,0 +1,104 @@
+#include "graphics/ShaderBatch.hpp"
+#include "graphics/GLExtensions.hpp"
+#include "graphics/ProgramCache.hpp"
+#include "graphics/ShaderPreprocessor.hpp"
+#include "util/ThreadPool.hpp"
+
+#include <future>
+
+using namespace std;
+
+int ShaderBatch::add(const std::string &vertexPath, const std::string &fragmentPath, const std::vector<std::string> &defines)
+{
+	Entry entry;
+	entry.vertexPath = vertexPath;
+	entry.fragmentPath = fragmentPath;
+	entry.defines = defines;
+	m_entries.push_back(entry);
+	return (int)m_entries.size() - 1;
+}
+
+vector<Shader> ShaderBatch::build(std::vector<std::vector<std::string>> *dependencies)
+{
+	// 1. read and preprocess every source file on the pool, nothing here touches GL
+	vector<future<void>> reads;
+	reads.reserve(m_entries.size());
+	for (Entry &entry : m_entries)
+	{
+		reads.push_back(ThreadPool::shared().submit([&entry]()
+													{
+			vector<string> fragmentDependencies;
+			ShaderPreprocessor::process(entry.vertexPath, entry.defines, entry.vertexCode, entry.dependencies);
+			ShaderPreprocessor::process(entry.fragmentPath, entry.defines, entry.fragmentCode, fragmentDependencies);
+			entry.dependencies.insert(entry.dependencies.end(), fragmentDependencies.begin(), fragmentDependencies.end()); }));
+	}
+	for (future<void> &read : reads)
+	{
+		read.get();
+	}
+
+	if (GLExtensions::parallelShaderCompile)
+	{
+		// let the driver pick as many compiler threads as it likes
+		glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+	}
+
+	// 2. programs with a cached binary are done, submit compiles for the rest without waiting
+	for (Entry &entry : m_entries)
+	{
+		entry.program = glCreateProgram();
+		entry.cached = ProgramCache::load(entry.program, entry.vertexCode, entry.fragmentCode);
+		if (entry.cached)
+		{
+			continue;
+		}
+
+		entry.vertex = glCreateShader(GL_VERTEX_SHADER);
+		entry.fragment = glCreateShader(GL_FRAGMENT_SHADER);
+		Shader::compileShader(entry.vertex, entry.vertexCode.c_str());
+		Shader::compileShader(entry.fragment, entry.fragmentCode.c_str());
+	}
+
+	// 3. submit every link, still without querying any status
+	for (Entry &entry : m_entries)
+	{
+		if (entry.cached)
+		{
+			continue;
+		}
+		if (GLExtensions::programBinary)
+		{
+			glProgramParameteri(entry.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		}
+		Shader::linkShaders(entry.program, entry.vertex, entry.fragment);
+	}
+
+	// 4. only now wait for results, by the time the first program is checked the others are in flight
+	vector<Shader> shaders;
+	shaders.reserve(m_entries.size());
+	for (Entry &entry : m_entries)
+	{
+		if (!entry.cached)
+		{
+			Shader::checkShader(entry.vertex, "VERTEX");
+			Shader::checkShader(entry.fragment, "FRAGMENT");
+			if (Shader::checkProgram(entry.program))
+			{
+				ProgramCache::store(entry.program, entry.vertexCode, entry.fragmentCode);
+			}
+
+			glDetachShader(entry.program, entry.vertex);
+			glDetachShader(entry.program, entry.fragment);
+			glDeleteShader(entry.vertex);
+			glDeleteShader(entry.fragment);
+		}
+		shaders.emplace_back(entry.program);
+		if (dependencies)
+		{
+			dependencies->push_back(entry.dependencies);
+		}
+	}
+
+	m_entries.clear();
+	return shaders;
+}
\ No newline at end of file
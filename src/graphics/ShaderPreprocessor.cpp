@@ -0,0 +1,119 @@
+#include "graphics/ShaderPreprocessor.hpp"
+#include "graphics/ShaderSource.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+static bool startsWithDirective(const string &line, const char *directive, size_t &rest)
+{
+	size_t p = line.find_first_not_of(" \t");
+	if (p == string::npos || line[p] != '#')
+	{
+		return false;
+	}
+	p = line.find_first_not_of(" \t", p + 1);
+	size_t length = char_traits<char>::length(directive);
+	if (p == string::npos || line.compare(p, length, directive) != 0)
+	{
+		return false;
+	}
+	rest = p + length;
+	return true;
+}
+
+string ShaderPreprocessor::directoryOf(const std::string &path)
+{
+	size_t slash = path.find_last_of("/\\");
+	return slash == string::npos ? string() : path.substr(0, slash + 1);
+}
+
+bool ShaderPreprocessor::process(const std::string &path, const std::vector<std::string> &defines, std::string &out, std::vector<std::string> &dependencies)
+{
+	out.clear();
+	dependencies.clear();
+	return expand(path, defines, out, dependencies, true);
+}
+
+bool ShaderPreprocessor::expand(const std::string &path, const std::vector<std::string> &defines, std::string &out, std::vector<std::string> &dependencies, const bool &topLevel)
+{
+	if (find(dependencies.begin(), dependencies.end(), path) != dependencies.end())
+	{
+		// already included once
+		return true;
+	}
+
+	string source;
+	if (!ShaderSource::load(path, source))
+	{
+		return false;
+	}
+	const int fileIndex = (int)dependencies.size();
+	dependencies.push_back(path);
+
+	auto writeDefines = [&](int nextLine)
+	{
+		for (const string &define : defines)
+		{
+			out += "#define " + define + " 1\n";
+		}
+		out += "#line " + to_string(nextLine) + " " + to_string(fileIndex) + "\n";
+	};
+
+	size_t rest;
+	bool hasVersion = false;
+	istringstream scan(source);
+	string line;
+	while (!hasVersion && getline(scan, line))
+	{
+		hasVersion = startsWithDirective(line, "version", rest);
+	}
+	if (topLevel && !hasVersion)
+	{
+		writeDefines(1);
+	}
+	else if (!topLevel)
+	{
+		out += "#line 1 " + to_string(fileIndex) + "\n";
+	}
+
+	istringstream lines(source);
+	int lineNumber = 0;
+	bool ok = true;
+	while (getline(lines, line))
+	{
+		lineNumber++;
+
+		if (startsWithDirective(line, "version", rest))
+		{
+			out += line + "\n";
+			if (topLevel)
+			{
+				writeDefines(lineNumber + 1);
+			}
+			continue;
+		}
+
+		if (startsWithDirective(line, "include", rest))
+		{
+			size_t open = line.find('"', rest);
+			size_t close = open == string::npos ? string::npos : line.find('"', open + 1);
+			if (close == string::npos)
+			{
+				cout << "ERROR::SHADER::PREPROCESSOR::MALFORMED_INCLUDE " << path << ":" << lineNumber << endl;
+				ok = false;
+				continue;
+			}
+
+			string includePath = directoryOf(path) + line.substr(open + 1, close - open - 1);
+			ok = expand(includePath, defines, out, dependencies, false) && ok;
+			out += "#line " + to_string(lineNumber + 1) + " " + to_string(fileIndex) + "\n";
+			continue;
+		}
+
+		out += line + "\n";
+	}
+	return ok;
+}
\ No newline at end of file
@@ -0,0 +1,120 @@
+#include "graphics/ShaderReloader.hpp"
+#include "graphics/ShaderBatch.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+using namespace std;
+
+ShaderReloader::ShaderReloader(GLFWwindow *window, const std::string &directory) : m_context(NULL), m_watcher(directory), m_pending(false)
+{
+	if (!m_watcher.isActive())
+	{
+		return;
+	}
+
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	m_context = glfwCreateWindow(1, 1, "", NULL, window);
+	glfwDefaultWindowHints();
+	if (m_context == NULL)
+	{
+		cout << "ERROR::SHADER_RELOADER::NO_SHARED_CONTEXT hot reload disabled" << endl;
+	}
+}
+
+ShaderReloader::~ShaderReloader()
+{
+	m_watcher.stop();
+	if (m_thread.joinable())
+	{
+		m_thread.join();
+	}
+	if (m_context != NULL)
+	{
+		glfwDestroyWindow(m_context);
+	}
+}
+
+void ShaderReloader::watch(ShaderVariants *variants)
+{
+	m_watched.push_back(variants);
+}
+
+void ShaderReloader::start()
+{
+	if (m_context != NULL && !m_thread.joinable())
+	{
+		m_thread = thread(&ShaderReloader::run, this);
+	}
+}
+
+void ShaderReloader::run()
+{
+	glfwMakeContextCurrent(m_context);
+
+	vector<string> changed;
+	while (m_watcher.wait(changed))
+	{
+		ShaderBatch batch;
+		vector<pair<ShaderVariants *, unsigned int>> queued;
+		for (ShaderVariants *variants : m_watched)
+		{
+			bool affected = any_of(changed.begin(), changed.end(), [variants](const string &file)
+								   { return variants->dependsOn(file); });
+			if (!affected)
+			{
+				continue;
+			}
+			for (unsigned int mask : variants->compiled())
+			{
+				batch.add(variants->vertexPath(), variants->fragmentPath(), variants->definesFor(mask));
+				queued.emplace_back(variants, mask);
+			}
+		}
+		if (queued.empty())
+		{
+			continue;
+		}
+
+		vector<vector<string>> dependencies;
+		vector<Shader> shaders = batch.build(&dependencies);
+		// the render context may only use the programs once the driver is done with them
+		glFinish();
+
+		lock_guard<mutex> lock(m_mutex);
+		for (size_t i = 0; i < shaders.size(); i++)
+		{
+			const string name = queued[i].first->fragmentPath() + " (variant " + to_string(queued[i].second) + ")";
+			if (shaders[i].isLinked())
+			{
+				cout << "shader " << name << " reloaded." << endl;
+				m_results.push_back({queued[i].first, queued[i].second, shaders[i], dependencies[i]});
+			}
+			else
+			{
+				cout << "shader " << name << " failed to reload, keeping the previous one." << endl;
+				glDeleteProgram(shaders[i].programId);
+			}
+		}
+		m_pending.store(!m_results.empty(), memory_order_release);
+	}
+
+	glfwMakeContextCurrent(NULL);
+}
+
+bool ShaderReloader::apply()
+{
+	if (!m_pending.load(memory_order_acquire))
+	{
+		return false;
+	}
+
+	lock_guard<mutex> lock(m_mutex);
+	for (Reloaded &reloaded : m_results)
+	{
+		reloaded.variants->replace(reloaded.mask, reloaded.shader, reloaded.dependencies);
+	}
+	m_results.clear();
+	m_pending.store(false, memory_order_relaxed);
+	return true;
+}
\ No newline at end of file
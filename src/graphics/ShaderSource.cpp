@@ -0,0 +1,61 @@
+#include "graphics/ShaderSource.hpp"
+#include "graphics/Shader.hpp"
+
+#include <fstream>
+
+#if __has_include("generated/EmbeddedShaders.hpp")
+#include "generated/EmbeddedShaders.hpp"
+#else
+// built without the embed step, everything comes from disk
+#include <cstddef>
+struct EmbeddedShader
+{
+	const char *name;
+	const char *source;
+	size_t length;
+};
+constexpr EmbeddedShader EMBEDDED_SHADERS[] = {{"", "", 0}};
+constexpr size_t EMBEDDED_SHADER_COUNT = 0;
+#endif
+
+using namespace std;
+
+bool ShaderSource::preferDisk = false;
+
+bool ShaderSource::loadEmbedded(const std::string &path, std::string &out)
+{
+	size_t slash = path.find_last_of("/\\");
+	string name = slash == string::npos ? path : path.substr(slash + 1);
+
+	for (size_t i = 0; i < EMBEDDED_SHADER_COUNT; i++)
+	{
+		if (name == EMBEDDED_SHADERS[i].name)
+		{
+			out.assign(EMBEDDED_SHADERS[i].source, EMBEDDED_SHADERS[i].length);
+			return true;
+		}
+	}
+	return false;
+}
+
+int ShaderSource::embeddedCount()
+{
+	return (int)EMBEDDED_SHADER_COUNT;
+}
+
+bool ShaderSource::load(const std::string &path, std::string &out)
+{
+	if (!preferDisk && loadEmbedded(path, out))
+	{
+		return true;
+	}
+	if (preferDisk && ifstream(path).good())
+	{
+		return Shader::readFile(path.c_str(), out);
+	}
+	if (loadEmbedded(path, out))
+	{
+		return true;
+	}
+	return Shader::readFile(path.c_str(), out);
+}
@@ -0,0 +1,144 @@
+#include "graphics/ShaderVariants.hpp"
+#include "graphics/ShaderBatch.hpp"
+#include "graphics/GLState.hpp"
+
+#include <algorithm>
+
+using namespace std;
+
+static string fileNameOf(const string &path)
+{
+	size_t slash = path.find_last_of("/\\");
+	return slash == string::npos ? path : path.substr(slash + 1);
+}
+
+ShaderVariants::ShaderVariants(const std::string &vertexPath, const std::string &fragmentPath, const std::vector<std::string> &features)
+	: m_vertexPath(vertexPath), m_fragmentPath(fragmentPath), m_features(features) {}
+
+const string &ShaderVariants::vertexPath() const
+{
+	return m_vertexPath;
+}
+
+const string &ShaderVariants::fragmentPath() const
+{
+	return m_fragmentPath;
+}
+
+vector<string> ShaderVariants::definesFor(const unsigned int &mask) const
+{
+	vector<string> defines;
+	for (size_t i = 0; i < m_features.size(); i++)
+	{
+		if (mask & (1u << i))
+		{
+			defines.push_back(m_features[i]);
+		}
+	}
+	return defines;
+}
+
+void ShaderVariants::addDependencies(const std::vector<std::string> &files)
+{
+	for (const string &file : files)
+	{
+		string name = fileNameOf(file);
+		if (find(m_dependencies.begin(), m_dependencies.end(), name) == m_dependencies.end())
+		{
+			m_dependencies.push_back(name);
+		}
+	}
+}
+
+Shader &ShaderVariants::get(const unsigned int &mask)
+{
+	{
+		lock_guard<mutex> lock(m_mutex);
+		auto it = m_variants.find(mask);
+		if (it != m_variants.end())
+		{
+			return it->second;
+		}
+	}
+
+	prepare({mask});
+	lock_guard<mutex> lock(m_mutex);
+	return m_variants.at(mask);
+}
+
+void ShaderVariants::prepare(const std::vector<unsigned int> &masks)
+{
+	ShaderBatch batch;
+	vector<unsigned int> missing;
+	{
+		lock_guard<mutex> lock(m_mutex);
+		for (unsigned int mask : masks)
+		{
+			if (m_variants.count(mask) == 0 && find(missing.begin(), missing.end(), mask) == missing.end())
+			{
+				batch.add(m_vertexPath, m_fragmentPath, definesFor(mask));
+				missing.push_back(mask);
+			}
+		}
+	}
+	if (missing.empty())
+	{
+		return;
+	}
+
+	vector<vector<string>> dependencies;
+	vector<Shader> shaders = batch.build(&dependencies);
+
+	lock_guard<mutex> lock(m_mutex);
+	for (size_t i = 0; i < missing.size(); i++)
+	{
+		m_variants.insert_or_assign(missing[i], shaders[i]);
+		addDependencies(dependencies[i]);
+	}
+}
+
+vector<unsigned int> ShaderVariants::compiled() const
+{
+	lock_guard<mutex> lock(m_mutex);
+	vector<unsigned int> masks;
+	for (auto const &[mask, _] : m_variants)
+	{
+		masks.push_back(mask);
+	}
+	return masks;
+}
+
+bool ShaderVariants::dependsOn(const std::string &fileName) const
+{
+	lock_guard<mutex> lock(m_mutex);
+	return find(m_dependencies.begin(), m_dependencies.end(), fileName) != m_dependencies.end();
+}
+
+void ShaderVariants::replace(const unsigned int &mask, const Shader &shader, const std::vector<std::string> &dependencies)
+{
+	lock_guard<mutex> lock(m_mutex);
+	auto it = m_variants.find(mask);
+	if (it == m_variants.end())
+	{
+		m_variants.insert_or_assign(mask, shader);
+	}
+	else
+	{
+		// keep the values that were set on the program being replaced
+		Shader previous = it->second;
+		it->second = shader;
+		it->second.params.adopt(previous.params);
+		GLState::deleteProgram(previous.programId);
+	}
+	addDependencies(dependencies);
+}
+
+void ShaderVariants::clear()
+{
+	lock_guard<mutex> lock(m_mutex);
+	for (auto const &[_, shader] : m_variants)
+	{
+		GLState::deleteProgram(shader.programId);
+	}
+	m_variants.clear();
+}
\ No newline at end of file
@@ -0,0 +1,151 @@
+#include "graphics/TextureArrays.hpp"
+#include "graphics/GLState.hpp"
+#include "graphics/TextureFormat.hpp"
+#include "asset/MipGenerator.hpp"
+#include "asset/JpegDecoder.hpp"
+#include "util/ThreadPool.hpp"
+
+#include <stb/stb_image.h>
+
+#include <algorithm>
+#include <iostream>
+#include <tuple>
+
+using namespace std;
+
+void TextureArrays::add(const std::string &path)
+{
+	if (std::find(m_paths.begin(), m_paths.end(), path) == m_paths.end())
+	{
+		m_paths.push_back(path);
+	}
+}
+
+void TextureArrays::decode(Image &image)
+{
+	// already on a pool thread, images are spread across the pool instead of rows
+	unsigned char *data = JpegDecoder::load(image.path.c_str(), &image.width, &image.height, &image.channels, 0, false);
+	if (!data)
+	{
+		data = stbi_load(image.path.c_str(), &image.width, &image.height, &image.channels, 0);
+	}
+	if (!data)
+	{
+		return;
+	}
+
+	MipOptions options;
+	options.parallel = false;
+	MipGenerator::generate(data, image.width, image.height, image.channels, options, image.levels);
+	stbi_image_free(data);
+
+	if (TextureFormat::uploadChannels(image.channels) != image.channels)
+	{
+		for (TextureLevel &level : image.levels)
+		{
+			TextureFormat::padToRgba(level);
+		}
+		image.channels = 4;
+	}
+}
+
+unsigned int TextureArrays::upload(const std::vector<const Image *> &group, const GLenum &wrap)
+{
+	const Image &first = *group.front();
+	PixelFormat format = TextureFormat::forChannels(first.channels);
+
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	GLState::bindTexture(0, GL_TEXTURE_2D_ARRAY, texture);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, wrap);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, wrap);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	TextureFormat::setSwizzle(GL_TEXTURE_2D_ARRAY, format.channels);
+
+	// every layer is filled once, so the storage can be immutable
+	TextureFormat::allocate3D(GL_TEXTURE_2D_ARRAY, (int)first.levels.size(), format, first.width, first.height, (int)group.size());
+	for (size_t level = 0; level < first.levels.size(); level++)
+	{
+		const TextureLevel &mip = first.levels[level];
+		glPixelStorei(GL_UNPACK_ALIGNMENT, TextureFormat::unpackAlignment(mip.width, format.channels));
+		for (size_t layer = 0; layer < group.size(); layer++)
+		{
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, (GLint)level, 0, 0, (GLint)layer, mip.width, mip.height, 1, format.format, GL_UNSIGNED_BYTE, group[layer]->levels[level].data.data());
+		}
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	return texture;
+}
+
+void TextureArrays::build(const GLenum &wrap)
+{
+	vector<Image> images(m_paths.size());
+	for (size_t i = 0; i < images.size(); i++)
+	{
+		images[i].path = m_paths[i];
+	}
+	ThreadPool::shared().parallelFor(0, (int)images.size(), [&images](int i)
+									 { decode(images[i]); });
+
+	// same size and channel count means the same level sizes and upload format
+	map<tuple<int, int, int>, vector<const Image *>> groups;
+	for (const Image &image : images)
+	{
+		if (image.levels.empty())
+		{
+			cout << "Failed to load texture " << image.path << endl;
+			continue;
+		}
+		groups[make_tuple(image.width, image.height, image.channels)].push_back(&image);
+	}
+
+	int maxLayers = 256;
+	glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+	for (auto &entry : groups)
+	{
+		const vector<const Image *> &group = entry.second;
+		for (size_t begin = 0; begin < group.size(); begin += maxLayers)
+		{
+			vector<const Image *> chunk(group.begin() + begin, group.begin() + min(group.size(), begin + maxLayers));
+			unsigned int texture = upload(chunk, wrap);
+			m_arrays.push_back(texture);
+			for (size_t layer = 0; layer < chunk.size(); layer++)
+			{
+				m_layers[chunk[layer]->path] = {texture, (int)layer};
+			}
+		}
+	}
+	m_paths.clear();
+}
+
+void TextureArrays::destroy()
+{
+	for (unsigned int texture : m_arrays)
+	{
+		GLState::deleteTexture(texture);
+	}
+	m_arrays.clear();
+	m_layers.clear();
+}
+
+bool TextureArrays::find(const std::string &path, TextureLayer &layer) const
+{
+	auto it = m_layers.find(path);
+	if (it == m_layers.end())
+	{
+		return false;
+	}
+	layer = it->second;
+	return true;
+}
+
+int TextureArrays::arrayCount() const
+{
+	return (int)m_arrays.size();
+}
+
+int TextureArrays::layerCount() const
+{
+	return (int)m_layers.size();
+}
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include "graphics/TextureFormat.hpp"
+#include "graphics/GLExtensions.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+using namespace std;
+
+// desktop drivers keep RGB8 in four bytes per texel, assume so unless the driver says otherwise
+bool TextureFormat::m_padRgb = true;
+
+void TextureFormat::detect()
+{
+	m_padRgb = true;
+	if (!GLExtensions::internalformatQuery)
+	{
+		return;
+	}
+
+	GLint preferred = 0, imageFormat = 0;
+	glGetInternalformativ(GL_TEXTURE_2D, GL_RGB8, GL_INTERNALFORMAT_PREFERRED, 1, &preferred);
+	glGetInternalformativ(GL_TEXTURE_2D, GL_RGB8, GL_TEXTURE_IMAGE_FORMAT, 1, &imageFormat);
+	// an RGB8 the driver keeps as RGB8 and wants uploaded as RGB is the one case not worth padding
+	m_padRgb = !(preferred == GL_RGB8 && imageFormat == GL_RGB);
+	cout << "texture format: RGB8 preferred 0x" << hex << preferred << " upload 0x" << imageFormat << dec
+		 << (m_padRgb ? ", padding RGB to RGBA" : ", uploading RGB as is") << endl;
+}
+
+bool TextureFormat::padRgb()
+{
+	return m_padRgb;
+}
+
+PixelFormat TextureFormat::forChannels(const int &channels, const bool &srgb)
+{
+	switch (channels)
+	{
+	case 1:
+		return {GL_R8, GL_RED, 1};
+	case 2:
+		return {GL_RG8, GL_RG, 2};
+	case 3:
+		return {srgb ? (GLenum)GL_SRGB8 : (GLenum)GL_RGB8, GL_RGB, 3};
+	default:
+		return {srgb ? (GLenum)GL_SRGB8_ALPHA8 : (GLenum)GL_RGBA8, GL_RGBA, 4};
+	}
+}
+
+int TextureFormat::uploadChannels(const int &channels)
+{
+	return channels == 3 && m_padRgb ? 4 : channels;
+}
+
+int TextureFormat::unpackAlignment(const int &width, const int &bytesPerPixel)
+{
+	int row = width * bytesPerPixel;
+	for (int alignment = 8; alignment > 1; alignment /= 2)
+	{
+		if (row % alignment == 0)
+		{
+			return alignment;
+		}
+	}
+	return 1;
+}
+
+void TextureFormat::setSwizzle(const GLenum &target, const int &channels)
+{
+	static const GLint GREY[] = {GL_RED, GL_RED, GL_RED, GL_ONE};
+	static const GLint GREY_ALPHA[] = {GL_RED, GL_RED, GL_RED, GL_GREEN};
+	static const GLint IDENTITY[] = {GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA};
+	glTexParameteriv(target, GL_TEXTURE_SWIZZLE_RGBA, channels == 1 ? GREY : channels == 2 ? GREY_ALPHA
+																						   : IDENTITY);
+}
+
+void TextureFormat::padToRgba(const unsigned char *rgb, unsigned char *rgba, const size_t &pixels)
+{
+	size_t i = 0;
+#ifdef __SSSE3__
+	// four pixels per step, the last load would read past the end so it is left to the scalar loop
+	const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+	for (; i + 6 <= pixels; i += 4)
+	{
+		__m128i source = _mm_loadu_si128((const __m128i *)(rgb + i * 3));
+		_mm_storeu_si128((__m128i *)(rgba + i * 4), _mm_or_si128(_mm_shuffle_epi8(source, shuffle), alpha));
+	}
+#endif
+	for (; i < pixels; i++)
+	{
+		rgba[i * 4 + 0] = rgb[i * 3 + 0];
+		rgba[i * 4 + 1] = rgb[i * 3 + 1];
+		rgba[i * 4 + 2] = rgb[i * 3 + 2];
+		rgba[i * 4 + 3] = 255;
+	}
+}
+
+void TextureFormat::padToRgba(TextureLevel &level)
+{
+	size_t pixels = (size_t)level.width * level.height;
+	vector<unsigned char> padded(pixels * 4);
+	padToRgba(level.data.data(), padded.data(), pixels);
+	level.data.swap(padded);
+}
+
+void TextureFormat::allocate2D(const GLenum &target, const int &levels, const PixelFormat &format, const int &width, const int &height)
+{
+	if (GLExtensions::textureStorage)
+	{
+		glTexStorage2D(target, levels, format.internalFormat, width, height);
+		return;
+	}
+	for (int level = 0; level < levels; level++)
+	{
+		glTexImage2D(target, level, format.internalFormat, max(1, width >> level), max(1, height >> level), 0, format.format, GL_UNSIGNED_BYTE, NULL);
+	}
+	glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, levels - 1);
+}
+
+void TextureFormat::allocate3D(const GLenum &target, const int &levels, const PixelFormat &format, const int &width, const int &height, const int &depth)
+{
+	if (GLExtensions::textureStorage)
+	{
+		glTexStorage3D(target, levels, format.internalFormat, width, height, depth);
+		return;
+	}
+	for (int level = 0; level < levels; level++)
+	{
+		glTexImage3D(target, level, format.internalFormat, max(1, width >> level), max(1, height >> level), depth, 0, format.format, GL_UNSIGNED_BYTE, NULL);
+	}
+	glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, levels - 1);
+}
\ No newline at end of file
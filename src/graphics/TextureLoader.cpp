@@ -0,0 +1,282 @@
+#include "graphics/TextureLoader.hpp"
+#include "graphics/GLState.hpp"
+#include "graphics/GLExtensions.hpp"
+#include "graphics/TextureFormat.hpp"
+#include "util/ThreadPool.hpp"
+#include "asset/TextureBaker.hpp"
+#include "asset/MipGenerator.hpp"
+#include "asset/JpegDecoder.hpp"
+
+#include <stb/stb_image.h>
+
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+TextureLoader::TextureLoader() : m_bytesPerFrame(DEFAULT_BYTES_PER_FRAME), m_residency(NULL), m_pending(0), m_uploaded(0) {}
+
+void TextureLoader::create(const size_t &bytesPerFrame)
+{
+	m_bytesPerFrame = bytesPerFrame;
+	m_ring.create();
+}
+
+void TextureLoader::setResidency(TextureResidency *residency)
+{
+	m_residency = residency;
+}
+
+void TextureLoader::destroy()
+{
+	// decode tasks reference this loader
+	for (future<void> &task : m_tasks)
+	{
+		task.wait();
+	}
+	m_tasks.clear();
+	m_decoded.clear();
+
+	m_ring.destroy();
+}
+
+unsigned int TextureLoader::load(const std::string &path, const GLenum &wrap)
+{
+	static const unsigned char PLACEHOLDER[4] = {255, 255, 255, 255};
+
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	GLState::bindTexture(0, GL_TEXTURE_2D, texture);
+
+	// set the texture wrapping/filtering options (on the currently bound texture object)
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, PLACEHOLDER);
+	// the placeholder is complete with a single level
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+
+	m_pending++;
+	m_tasks.push_back(ThreadPool::shared().submit([this, texture, path]()
+												  {
+		Decoded decoded;
+		decoded.texture = texture;
+		decoded.path = path;
+		if (openBaked(path, decoded))
+		{
+			lock_guard<mutex> lock(m_mutex);
+			m_decoded.push_back(move(decoded));
+			return;
+		}
+
+		int nrChannels;
+		// a large jpeg is split across the pool as well, this task helps out while it waits
+		unsigned char *data = JpegDecoder::load(path.c_str(), &decoded.width, &decoded.height, &nrChannels, 0);
+		if (!data)
+		{
+			data = stbi_load(path.c_str(), &decoded.width, &decoded.height, &nrChannels, 0);
+		}
+		if (data)
+		{
+			// this already runs on the pool, so the levels are built serially and images go in parallel
+			MipOptions options;
+			options.parallel = false;
+			MipGenerator::generate(data, decoded.width, decoded.height, nrChannels, options, decoded.levels);
+			stbi_image_free(data);
+
+			// padded after filtering, the constant alpha would only cost the mip generator time
+			decoded.channels = TextureFormat::uploadChannels(nrChannels);
+			if (decoded.channels != nrChannels)
+			{
+				for (TextureLevel &level : decoded.levels)
+				{
+					TextureFormat::padToRgba(level);
+				}
+			}
+		}
+
+		lock_guard<mutex> lock(m_mutex);
+		m_decoded.push_back(move(decoded)); }));
+	return texture;
+}
+
+bool TextureLoader::openBaked(const std::string &path, Decoded &decoded)
+{
+	string bakedPath = TextureBaker::bakedPathFor(path);
+	if (TextureBaker::isStale(path, bakedPath))
+	{
+		return false;
+	}
+
+	shared_ptr<MappedFile> baked = make_shared<MappedFile>();
+	if (!baked->open(bakedPath) || !TextureFile::parse(baked->data(), baked->size(), decoded.view) ||
+		(TextureFile::bytesPerPixel(decoded.view.header.format) == 0 && !TextureFile::isCompressed(decoded.view.header.format)))
+	{
+		cout << "WARNING::TEXTURE_LOADER::BAKED_FILE_INVALID " << bakedPath << " falling back to " << path << endl;
+		return false;
+	}
+	if (TextureFile::isCompressed(decoded.view.header.format) && !GLExtensions::s3tc)
+	{
+		cout << "WARNING::TEXTURE_LOADER::S3TC_UNSUPPORTED " << bakedPath << " falling back to " << path << endl;
+		return false;
+	}
+
+	decoded.baked = baked;
+	decoded.width = (int)decoded.view.header.width;
+	decoded.height = (int)decoded.view.header.height;
+	return true;
+}
+
+void TextureLoader::upload(const Decoded &decoded)
+{
+	GLsizeiptr size = 0;
+	for (const TextureLevel &level : decoded.levels)
+	{
+		size += (GLsizeiptr)level.data.size();
+	}
+
+	unsigned char *target = m_ring.map(size);
+	if (target)
+	{
+		// every level back to back, uploaded from its offset in the buffer
+		vector<size_t> offsets;
+		size_t offset = 0;
+		for (const TextureLevel &level : decoded.levels)
+		{
+			memcpy(target + offset, level.data.data(), level.data.size());
+			offsets.push_back(offset);
+			offset += level.data.size();
+		}
+		m_ring.unmap();
+
+		// replaces the placeholder storage of the same texture object, the copy runs asynchronously. Not
+		// immutable storage for that reason, and because the residency manager re-specifies levels
+		PixelFormat format = TextureFormat::forChannels(decoded.channels);
+		GLState::bindTexture(0, GL_TEXTURE_2D, decoded.texture);
+		for (size_t level = 0; level < decoded.levels.size(); level++)
+		{
+			const TextureLevel &mip = decoded.levels[level];
+			glPixelStorei(GL_UNPACK_ALIGNMENT, TextureFormat::unpackAlignment(mip.width, format.channels));
+			glTexImage2D(GL_TEXTURE_2D, (GLint)level, format.internalFormat, mip.width, mip.height, 0, format.format, GL_UNSIGNED_BYTE, (void *)offsets[level]);
+		}
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		TextureFormat::setSwizzle(GL_TEXTURE_2D, format.channels);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)decoded.levels.size() - 1);
+	}
+	m_ring.submit();
+}
+
+void TextureLoader::uploadBaked(const Decoded &decoded)
+{
+	const TextureFileView &view = decoded.view;
+
+	GLState::bindTexture(0, GL_TEXTURE_2D, decoded.texture);
+	if (TextureFile::isCompressed(view.header.format))
+	{
+		GLenum internalFormat = view.header.format == TEX_FMT_BC1 ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		for (uint32_t level = 0; level < view.header.mipCount; level++)
+		{
+			glCompressedTexImage2D(GL_TEXTURE_2D, level, internalFormat, view.mips[level].width, view.mips[level].height, 0, (GLsizei)view.mips[level].size, view.data[level]);
+		}
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, view.header.mipCount - 1);
+		return;
+	}
+
+	// format values match the channel count, not padded since the driver reads straight from the mapped file
+	PixelFormat format = TextureFormat::forChannels(view.header.format);
+	for (uint32_t level = 0; level < view.header.mipCount; level++)
+	{
+		glPixelStorei(GL_UNPACK_ALIGNMENT, TextureFormat::unpackAlignment(view.mips[level].width, format.channels));
+		glTexImage2D(GL_TEXTURE_2D, level, format.internalFormat, view.mips[level].width, view.mips[level].height, 0, format.format, GL_UNSIGNED_BYTE, view.data[level]);
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	TextureFormat::setSwizzle(GL_TEXTURE_2D, format.channels);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, view.header.mipCount - 1);
+}
+
+void TextureLoader::update()
+{
+	if (m_pending.load(memory_order_relaxed) == 0)
+	{
+		return;
+	}
+
+	size_t spent = 0;
+	while (true)
+	{
+		Decoded decoded;
+		size_t size;
+		{
+			lock_guard<mutex> lock(m_mutex);
+			if (m_decoded.empty())
+			{
+				break;
+			}
+			Decoded &front = m_decoded.front();
+			size = front.baked ? front.baked->size() : 0;
+			for (const TextureLevel &level : front.levels)
+			{
+				size += level.data.size();
+			}
+
+			// at least one image per frame, even if it alone is over the budget
+			if (spent > 0 && spent + size > m_bytesPerFrame)
+			{
+				break;
+			}
+			if (!m_residency && !front.levels.empty() && !m_ring.ready())
+			{
+				break;
+			}
+			decoded = move(front);
+			m_decoded.pop_front();
+		}
+
+		if (m_residency && (decoded.baked || !decoded.levels.empty()))
+		{
+			// only the tail goes up now, finer levels stream in once the texture is drawn
+			ResidencySource source;
+			source.format = (uint32_t)decoded.channels;
+			source.levels = move(decoded.levels);
+			source.baked = decoded.baked;
+			source.view = decoded.view;
+			m_residency->track(decoded.texture, move(source));
+			m_uploaded++;
+			spent += size;
+		}
+		else if (decoded.baked)
+		{
+			uploadBaked(decoded);
+			m_uploaded++;
+			spent += size;
+		}
+		else if (!decoded.levels.empty())
+		{
+			upload(decoded);
+			m_uploaded++;
+			spent += size;
+		}
+		else
+		{
+			cout << "Failed to load texture " << decoded.path << endl;
+		}
+		m_pending--;
+	}
+
+	if (m_pending.load(memory_order_relaxed) == 0)
+	{
+		// every decode task has finished
+		m_tasks.clear();
+	}
+}
+
+int TextureLoader::pending() const
+{
+	return m_pending.load(memory_order_relaxed);
+}
+
+int TextureLoader::uploaded() const
+{
+	return m_uploaded;
+}
\ No newline at end of file
@@ -0,0 +1,305 @@
+#include "graphics/TextureResidency.hpp"
+#include "graphics/GLState.hpp"
+#include "graphics/GLExtensions.hpp"
+#include "graphics/TextureFormat.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace std;
+
+static GLenum compressedFormat(const uint32_t &format)
+{
+	return format == TEX_FMT_BC1 ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+}
+
+TextureResidency::TextureResidency() : m_bytesPerFrame(DEFAULT_BYTES_PER_FRAME), m_frame(0), m_streamInSamples(0), m_streamInTotalMs(0.0), m_counters() {}
+
+void TextureResidency::create(const size_t &budgetBytes, const size_t &bytesPerFrame)
+{
+	m_counters = Counters();
+	m_counters.budgetBytes = budgetBytes;
+	m_bytesPerFrame = bytesPerFrame;
+	m_ring.create();
+}
+
+void TextureResidency::destroy()
+{
+	// the texture objects belong to whoever created them
+	m_entries.clear();
+	m_counters.residentBytes = 0;
+	m_ring.destroy();
+}
+
+void TextureResidency::uploadLevel(const unsigned int &texture, const Entry &entry, const int &level, const void *pixels)
+{
+	const TextureFileMip &mip = entry.mips[level];
+	GLState::bindTexture(0, GL_TEXTURE_2D, texture);
+	if (TextureFile::isCompressed(entry.format))
+	{
+		glCompressedTexImage2D(GL_TEXTURE_2D, level, compressedFormat(entry.format), mip.width, mip.height, 0, (GLsizei)mip.size, pixels);
+	}
+	else
+	{
+		PixelFormat format = TextureFormat::forChannels(entry.format);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, TextureFormat::unpackAlignment(mip.width, format.channels));
+		glTexImage2D(GL_TEXTURE_2D, level, format.internalFormat, mip.width, mip.height, 0, format.format, GL_UNSIGNED_BYTE, pixels);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	}
+}
+
+void TextureResidency::releaseLevel(const unsigned int &texture, Entry &entry)
+{
+	GLState::bindTexture(0, GL_TEXTURE_2D, texture);
+
+	// move the base first so the texture stays complete, then let the driver free the level
+	int level = entry.top++;
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, entry.top);
+	if (TextureFile::isCompressed(entry.format))
+	{
+		glCompressedTexImage2D(GL_TEXTURE_2D, level, compressedFormat(entry.format), 0, 0, 0, 0, NULL);
+	}
+	else
+	{
+		PixelFormat format = TextureFormat::forChannels(entry.format);
+		glTexImage2D(GL_TEXTURE_2D, level, format.internalFormat, 0, 0, 0, format.format, GL_UNSIGNED_BYTE, NULL);
+	}
+
+	m_counters.residentBytes -= entry.mips[level].size;
+	m_counters.droppedLevels++;
+	if (entry.top == entry.tail)
+	{
+		m_counters.evictions++;
+	}
+	if (entry.top > entry.requested && !entry.waiting)
+	{
+		entry.waiting = true;
+		entry.requestedAt = chrono::steady_clock::now();
+	}
+}
+
+bool TextureResidency::makeRoom(const size_t &bytes)
+{
+	while (m_counters.residentBytes + bytes > m_counters.budgetBytes)
+	{
+		// detail finer than what was last asked for goes first, then anything not drawn this frame,
+		// least recently used first in both cases
+		unsigned int victim = 0;
+		Entry *victimEntry = NULL;
+		bool victimSurplus = false;
+		for (auto &it : m_entries)
+		{
+			Entry &entry = it.second;
+			if (entry.streaming || entry.top >= entry.tail)
+			{
+				continue;
+			}
+			bool surplus = entry.top < entry.requested;
+			if (!surplus && entry.lastUsed >= m_frame)
+			{
+				continue;
+			}
+			if (!victimEntry || (surplus && !victimSurplus) || (surplus == victimSurplus && entry.lastUsed < victimEntry->lastUsed))
+			{
+				victim = it.first;
+				victimEntry = &entry;
+				victimSurplus = surplus;
+			}
+		}
+		if (!victimEntry)
+		{
+			return false;
+		}
+		releaseLevel(victim, *victimEntry);
+	}
+	return true;
+}
+
+void TextureResidency::track(const unsigned int &texture, ResidencySource source)
+{
+	untrack(texture);
+	Entry &entry = m_entries[texture];
+	entry.source = move(source);
+
+	if (entry.source.baked)
+	{
+		entry.format = entry.source.view.header.format;
+		entry.mips = entry.source.view.mips;
+		entry.data = entry.source.view.data;
+	}
+	else
+	{
+		entry.format = entry.source.format;
+		for (const TextureLevel &level : entry.source.levels)
+		{
+			entry.mips.push_back({0, level.data.size(), level.width, level.height});
+			entry.data.push_back(level.data.data());
+		}
+	}
+
+	const int last = (int)entry.mips.size() - 1;
+	entry.tail = 0;
+	while (entry.tail < last && max(entry.mips[entry.tail].width, entry.mips[entry.tail].height) > TAIL_SIZE)
+	{
+		entry.tail++;
+	}
+	entry.top = entry.tail;
+	entry.requested = entry.tail;
+	entry.lastUsed = m_frame;
+	entry.waiting = false;
+	entry.streaming = false;
+
+	GLState::bindTexture(0, GL_TEXTURE_2D, texture);
+	if (entry.tail > 0)
+	{
+		// drop the loader's 1x1 placeholder
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	}
+	// the tail is a few KB, straight from client memory so the texture is complete at once
+	for (int level = last; level >= entry.tail; level--)
+	{
+		uploadLevel(texture, entry, level, entry.data[level]);
+		m_counters.residentBytes += entry.mips[level].size;
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, entry.top);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, last);
+	if (!TextureFile::isCompressed(entry.format))
+	{
+		TextureFormat::setSwizzle(GL_TEXTURE_2D, entry.format);
+	}
+}
+
+void TextureResidency::untrack(const unsigned int &texture)
+{
+	auto it = m_entries.find(texture);
+	if (it == m_entries.end())
+	{
+		return;
+	}
+	for (size_t level = it->second.top; level < it->second.mips.size(); level++)
+	{
+		m_counters.residentBytes -= it->second.mips[level].size;
+	}
+	m_entries.erase(it);
+}
+
+void TextureResidency::touch(const unsigned int &texture, const int &screenWidth, const int &screenHeight)
+{
+	auto it = m_entries.find(texture);
+	if (it == m_entries.end())
+	{
+		return;
+	}
+
+	Entry &entry = it->second;
+	entry.lastUsed = m_frame;
+	entry.requested = min(mipForScreenSize(entry.mips[0].width, entry.mips[0].height, screenWidth, screenHeight), entry.tail);
+	if (entry.top > entry.requested && !entry.waiting)
+	{
+		entry.waiting = true;
+		entry.requestedAt = chrono::steady_clock::now();
+	}
+	else if (entry.top <= entry.requested)
+	{
+		entry.waiting = false;
+	}
+}
+
+void TextureResidency::update()
+{
+	// largest gap between resident and requested detail first, recently used first among equals
+	vector<pair<unsigned int, Entry *>> wanted;
+	for (auto &it : m_entries)
+	{
+		if (it.second.top > it.second.requested)
+		{
+			wanted.push_back({it.first, &it.second});
+		}
+	}
+	sort(wanted.begin(), wanted.end(), [](const pair<unsigned int, Entry *> &a, const pair<unsigned int, Entry *> &b)
+		 {
+		int gapA = a.second->top - a.second->requested, gapB = b.second->top - b.second->requested;
+		return gapA != gapB ? gapA > gapB : a.second->lastUsed > b.second->lastUsed; });
+
+	// the levels are planned first, room is made for them as they are, then copied into one slot
+	// and uploaded from it in the same order. Nothing streams while the next slot is still busy.
+	vector<Upload> uploads;
+	size_t spent = 0;
+	const bool slotFree = m_ring.ready();
+	for (auto &it : wanted)
+	{
+		Entry &entry = *it.second;
+		// coarse to fine, one level at a time, so the texture sharpens progressively
+		entry.streaming = true;
+		for (int level = entry.top - 1; slotFree && level >= entry.requested; level--)
+		{
+			size_t size = entry.mips[level].size;
+			if ((spent > 0 && spent + size > m_bytesPerFrame) || !makeRoom(size))
+			{
+				break;
+			}
+			uploads.push_back({it.first, &entry, level, spent});
+			m_counters.residentBytes += size;
+			spent += size;
+		}
+	}
+
+	if (!uploads.empty())
+	{
+		unsigned char *target = m_ring.map((GLsizeiptr)spent);
+		if (target)
+		{
+			for (const Upload &upload : uploads)
+			{
+				memcpy(target + upload.offset, upload.entry->data[upload.level], upload.entry->mips[upload.level].size);
+			}
+			m_ring.unmap();
+		}
+		else
+		{
+			// a failed mapping falls back to client memory, the levels are already counted as resident
+			GLState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		}
+		for (const Upload &upload : uploads)
+		{
+			const void *pixels = target ? (const void *)upload.offset : (const void *)upload.entry->data[upload.level];
+			uploadLevel(upload.texture, *upload.entry, upload.level, pixels);
+			upload.entry->top = upload.level;
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, upload.level);
+			m_counters.streamedLevels++;
+		}
+		m_ring.submit();
+	}
+
+	for (auto &it : wanted)
+	{
+		Entry &entry = *it.second;
+		entry.streaming = false;
+		if (entry.top <= entry.requested && entry.waiting)
+		{
+			entry.waiting = false;
+			double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - entry.requestedAt).count();
+			m_streamInSamples++;
+			m_streamInTotalMs += ms;
+			m_counters.lastStreamInMs = ms;
+			m_counters.maxStreamInMs = max(m_counters.maxStreamInMs, ms);
+			m_counters.averageStreamInMs = m_streamInTotalMs / m_streamInSamples;
+		}
+	}
+
+	// a lowered budget, or tails of newly tracked textures, can leave us over
+	makeRoom(0);
+	m_frame++;
+}
+
+int TextureResidency::mipForScreenSize(const uint32_t &width, const uint32_t &height, const int &screenWidth, const int &screenHeight)
+{
+	double ratio = max((double)width / max(screenWidth, 1), (double)height / max(screenHeight, 1));
+	return ratio <= 1.0 ? 0 : (int)floor(log2(ratio));
+}
+
+const TextureResidency::Counters &TextureResidency::counters() const
+{
+	return m_counters;
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+#include "graphics/UniformBuffer.hpp"
+#include "graphics/GLState.hpp"
+
+#include <cstring>
+
+using namespace std;
+
+map<string, unsigned int> UniformBuffer::m_bindings;
+
+void UniformBuffer::registerBlock(const std::string &name, const unsigned int &binding)
+{
+	m_bindings[name] = binding;
+}
+
+bool UniformBuffer::bindingFor(const std::string &name, unsigned int &binding)
+{
+	auto it = m_bindings.find(name);
+	if (it == m_bindings.end())
+	{
+		return false;
+	}
+	binding = it->second;
+	return true;
+}
+
+UniformBuffer::UniformBuffer() : m_buffer(0), m_binding(0), m_size(0), m_stride(0), m_slot(-1) {}
+
+void UniformBuffer::create(const unsigned int &binding, const int &size, const int &slots)
+{
+	int alignment = 256;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+
+	m_binding = binding;
+	m_size = size;
+	m_stride = (size + alignment - 1) / alignment * alignment;
+	m_slot = -1;
+	m_fences.assign(slots, (GLsync)0);
+
+	glGenBuffers(1, &m_buffer);
+	GLState::bindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+	glBufferData(GL_UNIFORM_BUFFER, (GLsizeiptr)m_stride * slots, NULL, GL_DYNAMIC_DRAW);
+}
+
+void UniformBuffer::upload(const void *data)
+{
+	// everything submitted since the last upload read the current slot, fence it before moving on
+	if (m_slot >= 0)
+	{
+		m_fences[m_slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+	m_slot = (m_slot + 1) % (int)m_fences.size();
+
+	if (m_fences[m_slot])
+	{
+		// only blocks when the CPU is a full ring ahead of the GPU
+		glClientWaitSync(m_fences[m_slot], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+		glDeleteSync(m_fences[m_slot]);
+		m_fences[m_slot] = 0;
+	}
+
+	GLintptr offset = (GLintptr)m_slot * m_stride;
+	GLState::bindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+	void *target = glMapBufferRange(GL_UNIFORM_BUFFER, offset, m_size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	if (target)
+	{
+		memcpy(target, data, m_size);
+		glUnmapBuffer(GL_UNIFORM_BUFFER);
+	}
+
+	GLState::bindBufferRange(GL_UNIFORM_BUFFER, m_binding, m_buffer, offset, m_size);
+}
+
+void UniformBuffer::destroy()
+{
+	for (GLsync &fence : m_fences)
+	{
+		if (fence)
+		{
+			glDeleteSync(fence);
+			fence = 0;
+		}
+	}
+	if (m_buffer)
+	{
+		GLState::deleteBuffer(m_buffer);
+		m_buffer = 0;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,495 @@
+#include "graphics/VirtualTexture.hpp"
+#include "graphics/GLState.hpp"
+#include "graphics/TextureFormat.hpp"
+#include "util/ThreadPool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+static int nextPowerOfTwo(const uint32_t &value)
+{
+	int result = 1;
+	while ((uint32_t)result < value)
+	{
+		result <<= 1;
+	}
+	return result;
+}
+
+VirtualTexture::VirtualTexture() : m_cache(0), m_pageTable(0), m_feedbackFramebuffer(0), m_feedbackColor(0), m_feedbackWidth(0), m_feedbackHeight(0),
+								   m_viewportWidth(0), m_viewportHeight(0), m_nextReadback(0), m_frame(0), m_counters() {}
+
+uint64_t VirtualTexture::pageKey(const uint32_t &level, const uint32_t &x, const uint32_t &y)
+{
+	return (uint64_t)level << 48 | (uint64_t)y << 24 | x;
+}
+
+void VirtualTexture::pageOf(const uint64_t &key, uint32_t &level, uint32_t &x, uint32_t &y)
+{
+	level = (uint32_t)(key >> 48);
+	y = (uint32_t)(key >> 24) & 0xFFFFFF;
+	x = (uint32_t)key & 0xFFFFFF;
+}
+
+bool VirtualTexture::open(const std::string &path, const VirtualTextureOptions &options)
+{
+	destroy();
+	m_file = make_shared<MappedFile>();
+	if (!m_file->open(path) || !VirtualTextureFile::parse(m_file->data(), m_file->size(), m_view))
+	{
+		cout << "ERROR::VIRTUAL_TEXTURE::INVALID_FILE " << path << endl;
+		m_file.reset();
+		return false;
+	}
+	m_options = options;
+
+	// the cache is a single texture, shrink it rather than fail on small limits
+	int maxSize = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+	const int padded = (int)m_view.paddedSize();
+	if (padded > maxSize || nextPowerOfTwo(m_view.pagesX[0]) > maxSize || nextPowerOfTwo(m_view.pagesY[0]) > maxSize)
+	{
+		cout << "ERROR::VIRTUAL_TEXTURE::TOO_LARGE " << path << endl;
+		m_file.reset();
+		return false;
+	}
+	m_options.cachePages = max(1, min(m_options.cachePages, min(maxSize / padded, 255)));
+	const int cacheSize = m_options.cachePages * padded;
+
+	glGenTextures(1, &m_cache);
+	GLState::bindTexture(0, GL_TEXTURE_2D, m_cache);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	TextureFormat::allocate2D(GL_TEXTURE_2D, 1, TextureFormat::forChannels(4), cacheSize, cacheSize);
+
+	// mip level l of the table has a texel per page of virtual level l
+	const int levels = (int)m_view.header.levels;
+	const int tableWidth = nextPowerOfTwo(m_view.pagesX[0]), tableHeight = nextPowerOfTwo(m_view.pagesY[0]);
+	m_table.resize(levels);
+	m_tableWidth.resize(levels);
+	m_tableHeight.resize(levels);
+	m_dirty.assign(levels, {INT32_MAX, INT32_MAX, -1, -1});
+	for (int l = 0; l < levels; l++)
+	{
+		m_tableWidth[l] = max(1, tableWidth >> l);
+		m_tableHeight[l] = max(1, tableHeight >> l);
+		m_table[l].assign((size_t)m_tableWidth[l] * m_tableHeight[l] * 4, 0);
+	}
+
+	glGenTextures(1, &m_pageTable);
+	GLState::bindTexture(0, GL_TEXTURE_2D, m_pageTable);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	// integer textures cannot be filtered
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+	TextureFormat::allocate2D(GL_TEXTURE_2D, levels, {GL_RGBA8UI, GL_RGBA_INTEGER, 4}, tableWidth, tableHeight);
+
+	m_slots.assign((size_t)m_options.cachePages * m_options.cachePages, {NO_PAGE, 0});
+	m_counters = Counters();
+	m_counters.cacheCapacity = (int)m_slots.size();
+
+	// the coarsest page is the fallback for everything and is never evicted
+	const uint32_t top = m_view.header.levels - 1;
+	const unsigned char *pixels = m_view.tile(top, 0, 0);
+	upload({pageKey(top, 0, 0), vector<unsigned char>(pixels, pixels + m_view.tileBytes)});
+	uploadTable();
+
+	m_readbacks.assign(READBACK_COUNT, {0, 0, 0, 0});
+	for (Readback &readback : m_readbacks)
+	{
+		glGenBuffers(1, &readback.buffer);
+	}
+
+	cout << "virtual texture: " << m_view.header.width << "x" << m_view.header.height << ", " << levels << " levels of "
+		 << m_view.header.tileSize << " texel pages, cache " << m_slots.size() << " pages (" << ((size_t)cacheSize * cacheSize * 4 >> 20) << " MB)" << endl;
+	return true;
+}
+
+void VirtualTexture::destroy()
+{
+	// reads reference the mapping and this object
+	for (future<void> &read : m_reads)
+	{
+		read.wait();
+	}
+	m_reads.clear();
+	m_pending.clear();
+	m_loaded.clear();
+	m_resident.clear();
+	m_slots.clear();
+	m_table.clear();
+
+	for (Readback &readback : m_readbacks)
+	{
+		if (readback.fence)
+		{
+			glDeleteSync(readback.fence);
+		}
+		GLState::deleteBuffer(readback.buffer);
+	}
+	m_readbacks.clear();
+	if (m_feedbackFramebuffer)
+	{
+		glDeleteFramebuffers(1, &m_feedbackFramebuffer);
+		glDeleteRenderbuffers(1, &m_feedbackColor);
+		m_feedbackFramebuffer = m_feedbackColor = 0;
+		m_feedbackWidth = m_feedbackHeight = 0;
+	}
+	if (m_cache)
+	{
+		GLState::deleteTexture(m_cache);
+		GLState::deleteTexture(m_pageTable);
+		m_cache = m_pageTable = 0;
+	}
+	m_file.reset();
+}
+
+bool VirtualTexture::isOpen() const
+{
+	return m_file != nullptr;
+}
+
+void VirtualTexture::resizeFeedback(const int &width, const int &height)
+{
+	if (!m_feedbackFramebuffer)
+	{
+		glGenFramebuffers(1, &m_feedbackFramebuffer);
+		glGenRenderbuffers(1, &m_feedbackColor);
+	}
+	glBindRenderbuffer(GL_RENDERBUFFER, m_feedbackColor);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA16UI, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	GLState::bindFramebuffer(m_feedbackFramebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_feedbackColor);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		cout << "ERROR::VIRTUAL_TEXTURE::FEEDBACK_FRAMEBUFFER_INCOMPLETE" << endl;
+	}
+	m_feedbackWidth = width;
+	m_feedbackHeight = height;
+}
+
+void VirtualTexture::beginFeedback(const int &framebufferWidth, const int &framebufferHeight)
+{
+	int width = max(1, framebufferWidth / m_options.feedbackScale), height = max(1, framebufferHeight / m_options.feedbackScale);
+	if (width != m_feedbackWidth || height != m_feedbackHeight)
+	{
+		resizeFeedback(width, height);
+	}
+
+	m_viewportWidth = framebufferWidth;
+	m_viewportHeight = framebufferHeight;
+	GLState::bindFramebuffer(m_feedbackFramebuffer);
+	GLState::viewport(0, 0, width, height);
+	// alpha 0 marks pixels nothing was drawn to
+	static const GLuint NOTHING[4] = {0, 0, 0, 0};
+	glClearBufferuiv(GL_COLOR, 0, NOTHING);
+}
+
+void VirtualTexture::endFeedback()
+{
+	Readback &readback = m_readbacks[m_nextReadback];
+	// every buffer still waits to be consumed, skip this frame's feedback rather than stall
+	if (!readback.fence)
+	{
+		GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+		if (readback.width != m_feedbackWidth || readback.height != m_feedbackHeight)
+		{
+			glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)m_feedbackWidth * m_feedbackHeight * 4 * sizeof(uint16_t), NULL, GL_STREAM_READ);
+			readback.width = m_feedbackWidth;
+			readback.height = m_feedbackHeight;
+		}
+		glPixelStorei(GL_PACK_ALIGNMENT, 4);
+		glReadPixels(0, 0, m_feedbackWidth, m_feedbackHeight, GL_RGBA_INTEGER, GL_UNSIGNED_SHORT, (void *)0);
+		readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		m_nextReadback = (m_nextReadback + 1) % READBACK_COUNT;
+	}
+
+	GLState::bindFramebuffer(0);
+	GLState::viewport(0, 0, m_viewportWidth, m_viewportHeight);
+}
+
+void VirtualTexture::readFeedback(std::vector<uint64_t> &requests)
+{
+	unordered_set<uint64_t> visible, requested;
+	const uint32_t top = m_view.header.levels - 1;
+
+	// oldest first, m_nextReadback is the one written longest ago
+	for (int i = 0; i < READBACK_COUNT; i++)
+	{
+		Readback &readback = m_readbacks[(m_nextReadback + i) % READBACK_COUNT];
+		if (!readback.fence || glClientWaitSync(readback.fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+		{
+			continue;
+		}
+		glDeleteSync(readback.fence);
+		readback.fence = 0;
+
+		GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+		size_t texels = (size_t)readback.width * readback.height;
+		const uint16_t *pixels = (const uint16_t *)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, texels * 4 * sizeof(uint16_t), GL_MAP_READ_BIT);
+		if (pixels)
+		{
+			for (size_t p = 0; p < texels; p++)
+			{
+				const uint16_t *texel = pixels + p * 4;
+				if (texel[3] == 0 || texel[2] > top || texel[0] >= m_view.pagesX[texel[2]] || texel[1] >= m_view.pagesY[texel[2]])
+				{
+					continue;
+				}
+				visible.insert(pageKey(texel[2], texel[0], texel[1]));
+			}
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		}
+		GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	}
+	if (visible.empty())
+	{
+		return;
+	}
+	m_counters.visiblePages = (int)visible.size();
+
+	// a visible page keeps its ancestors alive too, they are its fallback while it streams in
+	for (uint64_t key : visible)
+	{
+		uint32_t level, x, y;
+		pageOf(key, level, x, y);
+		for (; level <= top; level++, x >>= 1, y >>= 1)
+		{
+			uint64_t page = pageKey(level, x, y);
+			auto resident = m_resident.find(page);
+			if (resident != m_resident.end())
+			{
+				m_slots[resident->second].lastUsed = m_frame;
+			}
+			else if (!m_pending.count(page) && requested.insert(page).second)
+			{
+				requests.push_back(page);
+			}
+		}
+	}
+}
+
+void VirtualTexture::requestReads(std::vector<uint64_t> &requests)
+{
+	// coarse pages first, they cover the most screen while the finer ones follow
+	sort(requests.begin(), requests.end(), [](const uint64_t &a, const uint64_t &b)
+		 { return a > b; });
+
+	ThreadPool &pool = ThreadPool::shared();
+	for (uint64_t page : requests)
+	{
+		if ((int)m_pending.size() >= m_options.maxReadsInFlight)
+		{
+			break;
+		}
+		uint32_t level, x, y;
+		pageOf(page, level, x, y);
+		const unsigned char *pixels = m_view.tile(level, x, y);
+		const size_t bytes = m_view.tileBytes;
+
+		m_pending.insert(page);
+		// the copy is what faults the page in from disk, so it happens here and not on the render thread
+		m_reads.push_back(pool.submit([this, page, pixels, bytes]()
+									  {
+			Tile tile = {page, vector<unsigned char>(pixels, pixels + bytes)};
+			lock_guard<mutex> lock(m_mutex);
+			m_loaded.push_back(move(tile)); }));
+	}
+
+	m_reads.erase(remove_if(m_reads.begin(), m_reads.end(), [](future<void> &read)
+							{ return read.wait_for(chrono::seconds(0)) == future_status::ready; }),
+				  m_reads.end());
+}
+
+void VirtualTexture::evict(const int &slot)
+{
+	uint32_t level, x, y;
+	pageOf(m_slots[slot].page, level, x, y);
+	m_resident.erase(m_slots[slot].page);
+	m_slots[slot].page = NO_PAGE;
+
+	// fall back to whatever the parent resolves to
+	unsigned char *entry = &m_table[level][((size_t)y * m_tableWidth[level] + x) * 4];
+	const unsigned char *parent = &m_table[level + 1][((size_t)(y >> 1) * m_tableWidth[level + 1] + (x >> 1)) * 4];
+	memcpy(entry, parent, 4);
+	refreshTable(level, x, y);
+	m_counters.evictions++;
+}
+
+bool VirtualTexture::upload(const Tile &tile)
+{
+	const uint32_t top = m_view.header.levels - 1;
+	int slot = -1;
+	long long oldest = m_frame;
+	for (size_t i = 0; i < m_slots.size(); i++)
+	{
+		if (m_slots[i].page == NO_PAGE)
+		{
+			slot = (int)i;
+			break;
+		}
+		// pages seen in this frame's feedback stay
+		if (m_slots[i].lastUsed < oldest && (uint32_t)(m_slots[i].page >> 48) != top)
+		{
+			oldest = m_slots[i].lastUsed;
+			slot = (int)i;
+		}
+	}
+	if (slot < 0)
+	{
+		return false;
+	}
+	if (m_slots[slot].page != NO_PAGE)
+	{
+		evict(slot);
+	}
+
+	const int padded = (int)m_view.paddedSize();
+	const int slotX = slot % m_options.cachePages, slotY = slot / m_options.cachePages;
+	GLState::bindTexture(0, GL_TEXTURE_2D, m_cache);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, TextureFormat::unpackAlignment(padded, 4));
+	glTexSubImage2D(GL_TEXTURE_2D, 0, slotX * padded, slotY * padded, padded, padded, GL_RGBA, GL_UNSIGNED_BYTE, tile.pixels.data());
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	uint32_t level, x, y;
+	pageOf(tile.page, level, x, y);
+	m_slots[slot] = {tile.page, m_frame};
+	m_resident[tile.page] = slot;
+	unsigned char *entry = &m_table[level][((size_t)y * m_tableWidth[level] + x) * 4];
+	entry[0] = (unsigned char)slotX;
+	entry[1] = (unsigned char)slotY;
+	entry[2] = (unsigned char)level;
+	entry[3] = 255;
+	refreshTable(level, x, y);
+	m_counters.uploads++;
+	return true;
+}
+
+void VirtualTexture::refreshTable(const uint32_t &level, const uint32_t &x, const uint32_t &y)
+{
+	auto markDirty = [this](const int &l, const int &x0, const int &y0, const int &x1, const int &y1)
+	{
+		DirtyRect &dirty = m_dirty[l];
+		dirty = {min(dirty.x0, x0), min(dirty.y0, y0), max(dirty.x1, x1), max(dirty.y1, y1)};
+	};
+	markDirty(level, x, y, x + 1, y + 1);
+
+	// coarse to fine, so every parent is final before its children copy it
+	for (int l = (int)level - 1; l >= 0; l--)
+	{
+		const int shift = (int)level - l;
+		const int x0 = (int)x << shift, y0 = (int)y << shift;
+		const int x1 = min(((int)x + 1) << shift, m_tableWidth[l]), y1 = min(((int)y + 1) << shift, m_tableHeight[l]);
+		for (int j = y0; j < y1; j++)
+		{
+			for (int i = x0; i < x1; i++)
+			{
+				unsigned char *entry = &m_table[l][((size_t)j * m_tableWidth[l] + i) * 4];
+				// resident pages point at themselves
+				if (entry[3] && entry[2] == l)
+				{
+					continue;
+				}
+				memcpy(entry, &m_table[l + 1][((size_t)(j >> 1) * m_tableWidth[l + 1] + (i >> 1)) * 4], 4);
+			}
+		}
+		if (x0 < x1 && y0 < y1)
+		{
+			markDirty(l, x0, y0, x1, y1);
+		}
+	}
+}
+
+void VirtualTexture::uploadTable()
+{
+	GLState::bindTexture(0, GL_TEXTURE_2D, m_pageTable);
+	for (size_t l = 0; l < m_dirty.size(); l++)
+	{
+		DirtyRect &dirty = m_dirty[l];
+		if (dirty.x1 <= dirty.x0)
+		{
+			continue;
+		}
+		// whole rows, so the CPU copy can be handed over without a row length
+		glTexSubImage2D(GL_TEXTURE_2D, (GLint)l, 0, dirty.y0, m_tableWidth[l], dirty.y1 - dirty.y0, GL_RGBA_INTEGER, GL_UNSIGNED_BYTE,
+						&m_table[l][(size_t)dirty.y0 * m_tableWidth[l] * 4]);
+		dirty = {INT32_MAX, INT32_MAX, -1, -1};
+	}
+}
+
+void VirtualTexture::update()
+{
+	if (!isOpen())
+	{
+		return;
+	}
+	m_frame++;
+
+	vector<uint64_t> requests;
+	readFeedback(requests);
+	requestReads(requests);
+
+	for (int i = 0; i < m_options.uploadsPerFrame; i++)
+	{
+		Tile tile;
+		{
+			lock_guard<mutex> lock(m_mutex);
+			if (m_loaded.empty())
+			{
+				break;
+			}
+			tile = move(m_loaded.front());
+			m_loaded.pop_front();
+		}
+		m_pending.erase(tile.page);
+		if (m_resident.count(tile.page))
+		{
+			continue;
+		}
+		if (!upload(tile))
+		{
+			// requested again by a later feedback if it is still visible
+			m_counters.dropped++;
+		}
+	}
+	uploadTable();
+
+	m_counters.residentPages = (int)m_resident.size();
+	m_counters.pendingReads = (int)m_pending.size();
+}
+
+void VirtualTexture::setUniforms(ParameterBlock &params, const bool &feedback) const
+{
+	const float cacheSize = (float)(m_options.cachePages * m_view.paddedSize());
+	params.setInt("vtPageTable"_hash, 1);
+	params.setVec4("vtInfo"_hash, (float)m_view.header.width, (float)m_view.header.height, (float)m_view.header.tileSize, (float)m_view.header.border);
+	// the feedback target is smaller, its derivatives would otherwise pick a coarser level than the frame does
+	params.setVec4("vtCacheInfo"_hash, cacheSize, cacheSize, (float)(m_view.header.levels - 1), feedback ? -log2((float)m_options.feedbackScale) : 0.f);
+}
+
+unsigned int VirtualTexture::cacheTexture() const
+{
+	return m_cache;
+}
+
+unsigned int VirtualTexture::pageTableTexture() const
+{
+	return m_pageTable;
+}
+
+const VirtualTexture::Counters &VirtualTexture::counters() const
+{
+	return m_counters;
+}
\ No newline at end of file
@@ -1,15 +1,36 @@
-#define STB_IMAGE_IMPLEMENTATION
-
 #include <vector>
 #include <map>
+#include <memory>
 #include <algorithm>
+#include <chrono>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
-#include <stb/stb_image.h>
 
 #include "graphics/Color.hpp"
 #include "graphics/Shader.hpp"
+#include "graphics/GLExtensions.hpp"
+#include "graphics/GLState.hpp"
+#include "graphics/ProgramCache.hpp"
+#include "graphics/ShaderBatch.hpp"
+#include "graphics/ShaderReloader.hpp"
+#include "graphics/ShaderVariants.hpp"
+#include "graphics/ShaderSource.hpp"
+#include "graphics/Std140.hpp"
+#include "graphics/UniformBuffer.hpp"
+#include "graphics/PipelineWarmup.hpp"
+#include "graphics/TextureLoader.hpp"
+#include "graphics/TextureArrays.hpp"
+#include "graphics/TextureResidency.hpp"
+#include "graphics/TextureFormat.hpp"
+#include "graphics/VirtualTexture.hpp"
+#include "asset/MeshQuantizer.hpp"
+#include "graphics/MeshLoader.hpp"
+#include "graphics/GltfImporter.hpp"
+#include "graphics/LodSelector.hpp"
+#include "asset/AtlasPacker.hpp"
 #include "util/Text.hpp"
+#include "util/Hash.hpp"
+#include "bench/Bench.hpp"
 
 using namespace std;
 
@@ -19,19 +40,88 @@ constexpr int GLFW_MINOR_VERSION = 3;
 const char *SHADERS_BASE_PATH = "./res/shaders/";
 const char *TEXTURES_BASE_PATH = "./res/textures/";
 const string TEX_CONTAINER = "TextureContainer";
+// optional, written by "bake atlas", images listed in it are drawn from shared pages
+const char *ATLAS_MANIFEST = "atlas.atlas";
 
 enum SHADERS
 {
 	SHA_TRI_RBW,
-	SHA_TRI_CON
+	SHA_TRI_CON,
+	SHA_TRI_ARR,
+	SHA_TRI_VT,
+	SHA_TRI_VT_FB
+};
+
+// bit i enables TRIANGLE_FEATURES[i] in the triangle shaders
+enum SHADER_FEATURES
+{
+	FEAT_TEXTURE = 1 << 0,
+	FEAT_TEXTURE_ARRAY = 1 << 1,
+	FEAT_VIRTUAL_TEXTURE = 1 << 2,
+	FEAT_VT_FEEDBACK = 1 << 3
+};
+const vector<string> TRIANGLE_FEATURES = {"HAS_TEXTURE", "HAS_TEXTURE_ARRAY", "HAS_VIRTUAL_TEXTURE", "VT_FEEDBACK"};
+
+// the triangle shader permutation behind each program
+const map<SHADERS, unsigned int> SHADER_VARIANTS = {
+	{SHADERS::SHA_TRI_RBW, 0},
+	{SHADERS::SHA_TRI_CON, FEAT_TEXTURE},
+	{SHADERS::SHA_TRI_ARR, FEAT_TEXTURE | FEAT_TEXTURE_ARRAY},
+	{SHADERS::SHA_TRI_VT, FEAT_TEXTURE | FEAT_VIRTUAL_TEXTURE},
+	{SHADERS::SHA_TRI_VT_FB, FEAT_TEXTURE | FEAT_VIRTUAL_TEXTURE | FEAT_VT_FEEDBACK},
 };
 
+// mirrors the Frame block in res/shaders/frame.glsl
+struct FrameData
+{
+	std140::Mat4 transform;
+	std140::Float time;
+};
+STD140_OFFSET(FrameData, transform, 0);
+STD140_OFFSET(FrameData, time, 64);
+
 const Color BG = Color(0.2f, 0.3f, 0.3f);
+// 1.5 frames at 60 Hz, so ordinary vsync jitter is not reported as a hitch
+constexpr double FRAME_BUDGET_MS = 25.0;
 
 vector<unsigned int> VAOs, VBOs, EBOs;
+// per VAO, what drawTrangles passes to glDrawElements, and a texture replacing the scene's (0 for none)
+vector<GLsizei> indexCounts;
+vector<GLenum> indexTypes;
+vector<size_t> indexOffsets;
+vector<unsigned int> drawTextures;
+// per VAO, ranges of its index buffer from finest to coarsest, empty for draws with a single level
+vector<vector<MeshLod>> drawLods;
+// owned by imported scenes
+vector<unsigned int> sceneTextures;
+// layout of the quad's vertices, --vertex-format <float|half|int16>
+QuantizeOptions vertexFormat;
 vector<int> pressedKeys;
-map<SHADERS, Shader> shaderPrograms;
+ShaderVariants triangleShaders(string(SHADERS_BASE_PATH) + "triangle.vs", string(SHADERS_BASE_PATH) + "triangle.fs", TRIANGLE_FEATURES);
 map<string, unsigned int> textures;
+// source file name -> region, and the page textures they live on
+map<string, AtlasEntry> atlasEntries;
+vector<unsigned int> atlasPages;
+// texture name -> region, for textures that resolved to an atlas page
+map<string, AtlasEntry> textureRegions;
+// with --texture-arrays, same sized images share GL_TEXTURE_2D_ARRAY objects and vertices carry the layer
+bool useTextureArrays = false;
+TextureArrays textureArrays;
+map<string, string> arrayTexturePaths;
+map<string, int> textureLayers;
+unique_ptr<ShaderReloader> shaderReloader;
+UniformBlock<FrameData> frameBlock;
+TextureLoader textureLoader;
+TextureResidency textureResidency;
+// with --virtual-texture <file.vtex>, the quad samples a paged texture through the feedback driven cache
+VirtualTexture virtualTexture;
+// --lod-pixels <n>, how many pixels of simplification error a level may show
+LodSelector lodSelector;
+// the model transform without zoom, and clip space units per mesh unit
+float modelScale[3] = {1.0f, 1.0f, 1.0f}, modelOffset[3] = {0.0f, 0.0f, 0.0f};
+float clipPerUnit = 1.0f;
+// - and = zoom out and in, levels of detail follow the size the scene is drawn at
+float modelZoom = 1.0f;
 
 // Forward declare functions
 void framebufferSizeCallback(GLFWwindow *window, int width, int height);
@@ -39,13 +129,29 @@ void processWindowInput(GLFWwindow *window);
 void cleanVObjects();
 int exit_clean(int const &code, string const &reason);
 void clearColor(Color c);
-void setupShader(const char *vertexFileName, const char *fragmentFileName, const SHADERS &ShaderId);
+void setupFrameBlock();
+void updateFrameBlock();
+void setupShaders(const vector<SHADERS> &used);
+void warmupPipelines();
+Shader &getShader(const SHADERS &shaderId);
+void watchShaders(GLFWwindow *window);
+void reloadShaders();
+void setupAtlas();
 void setupTexture(const char *fileName, const string &textureName);
+void setupTextureArrays();
 void setupTriangles();
-void drawTrangles(Shader &shader, const unsigned int &texture);
+bool setupMesh(const char *path);
+bool setupGltf(const char *path);
+void fitBounds(const MeshBounds &bounds, const float dequantizeScale[3], const float dequantizeOffset[3]);
+void setModelTransform(const float scale[3], const float offset[3]);
+void drawTrangles(Shader &shader, const GLenum &target, const unsigned int &texture);
+bool hasArg(int argc, char **argv, const char *arg);
+int intArg(int argc, char **argv, const char *arg, const int &fallback);
+const char *stringArg(int argc, char **argv, const char *arg, const char *fallback);
+void reportFrameStats(GLFWwindow *window);
 
 // main function
-int main()
+int main(int argc, char **argv)
 {
 	if (!glfwInit())
 	{
@@ -67,34 +173,147 @@ int main()
 	{
 		exit_clean(-1, "Failed to initialize GLAD, exiting...");
 	}
+	GLExtensions::load((GLADloadproc)glfwGetProcAddress);
+	TextureFormat::detect();
 
-	glViewport(0, 0, 800, 600);
+	GLState::invalidate();
+	GLState::viewport(0, 0, 800, 600);
 
 	glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
 
+	useTextureArrays = hasArg(argc, argv, "--texture-arrays");
+	if (!MeshQuantizer::parseFormat(stringArg(argc, argv, "--vertex-format", "int16"), vertexFormat))
+	{
+		return exit_clean(-1, "--vertex-format is one of float, half or int16, exiting...");
+	}
+	// --vram-budget <MB>
+	textureResidency.create((size_t)intArg(argc, argv, "--vram-budget", (int)(TextureResidency::DEFAULT_BUDGET >> 20)) << 20);
+	textureLoader.create();
+	textureLoader.setResidency(&textureResidency);
+	lodSelector.create((float)intArg(argc, argv, "--lod-pixels", (int)LodSelector::DEFAULT_PIXEL_ERROR));
+	setupAtlas();
 	setupTexture("container.jpg", TEX_CONTAINER);
+	setupTextureArrays();
+	const char *virtualTexturePath = stringArg(argc, argv, "--virtual-texture", NULL);
+	if (virtualTexturePath)
+	{
+		virtualTexture.open(virtualTexturePath);
+	}
 
-	setupShader("vertex.vs", "fragment.fs", SHADERS::SHA_TRI_RBW);
-	setupShader("vertex_with_texture.vs", "fragment_with_texture.fs", SHADERS::SHA_TRI_CON);
+	// sources come from the executable unless asked otherwise, hot reload needs them from disk
+	ShaderSource::preferDisk = hasArg(argc, argv, "--shaders-from-disk") || ShaderSource::embeddedCount() == 0;
 
-	setupTriangles();
+	// blocks must be registered before programs link so they get bound automatically
+	setupFrameBlock();
 
-	Shader triangleShader = shaderPrograms.at(SHA_TRI_CON);
+	auto shaderStart = chrono::steady_clock::now();
+	// only programs the scene uses are compiled up front, others are built on first use
+	SHADERS sceneShader = useTextureArrays ? SHA_TRI_ARR : SHA_TRI_CON;
+	vector<SHADERS> usedShaders;
+	if (virtualTexture.isOpen())
+	{
+		// the feedback pass draws the same scene with its own program
+		sceneShader = SHA_TRI_VT;
+		usedShaders.push_back(SHA_TRI_VT_FB);
+	}
+	usedShaders.push_back(sceneShader);
+	setupShaders(usedShaders);
+	chrono::duration<double, milli> shaderTime = chrono::steady_clock::now() - shaderStart;
+	cout << "setupShaders: " << shaderTime.count() << " ms (" << (ProgramCache::hits > 0 && ProgramCache::misses == 0 ? "warm" : "cold")
+		 << ", program cache hits " << ProgramCache::hits << ", misses " << ProgramCache::misses << ")" << endl;
+
+	// --mesh <file.lmesh> or --gltf <file.gltf/.glb> draws that instead of the quad
+	const char *meshPath = stringArg(argc, argv, "--mesh", NULL);
+	const char *gltfPath = stringArg(argc, argv, "--gltf", NULL);
+	bool sceneLoaded = (meshPath && setupMesh(meshPath)) || (gltfPath && setupGltf(gltfPath));
+	if (!sceneLoaded)
+	{
+		setupTriangles();
+	}
+
+	// pay for lazy driver compilation now instead of in the first frames
+	if (!hasArg(argc, argv, "--no-warmup"))
+	{
+		warmupPipelines();
+	}
+
+	if (ShaderSource::preferDisk)
+	{
+		watchShaders(window);
+	}
+
+	// a reference, so reloaded programs are picked up by the render loop
+	Shader &triangleShader = getShader(sceneShader);
+	triangleShader.params.setInt("ourTexture"_hash, 0);
 	unsigned int texture = textures[TEX_CONTAINER];
+	GLenum textureTarget = useTextureArrays ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+	Shader *feedbackShader = NULL;
+	if (virtualTexture.isOpen())
+	{
+		feedbackShader = &getShader(SHA_TRI_VT_FB);
+		feedbackShader->params.setInt("ourTexture"_hash, 0);
+		virtualTexture.setUniforms(feedbackShader->params, true);
+		virtualTexture.setUniforms(triangleShader.params, false);
+		texture = virtualTexture.cacheTexture();
+		textureTarget = GL_TEXTURE_2D;
+	}
+
+	if (hasArg(argc, argv, "--bench"))
+	{
+		Bench::uniformSetters(triangleShader, "ourTexture", 5000, 100);
+		Bench::mipGeneration((string(TEXTURES_BASE_PATH) + "container.jpg").c_str(), 20);
+		Bench::textureUpload((string(TEXTURES_BASE_PATH) + "container.jpg").c_str(), 20);
+		if (meshPath)
+		{
+			Bench::meshLoad(meshPath, 5);
+		}
+		if (gltfPath)
+		{
+			Bench::gltfImport(gltfPath, 5);
+		}
+		return exit_clean(0, "");
+	}
+
+	HitchDetector hitchDetector(FRAME_BUDGET_MS);
 
 	// Render loop
 	while (!glfwWindowShouldClose(window))
 	{
+		hitchDetector.beginFrame(glfwGetTime());
+
 		// handle input events
 		processWindowInput(window);
+		reloadShaders();
+		textureLoader.update();
+		textureResidency.update();
 
 		// render commands
+		updateFrameBlock();
+		int framebufferWidth, framebufferHeight;
+		glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+		// clip space spans the framebuffer's height twice over, no perspective to account for
+		lodSelector.update(drawLods, clipPerUnit * modelZoom * framebufferHeight * 0.5f);
+		if (virtualTexture.isOpen())
+		{
+			// the pages this frame needs are found by drawing it small first, they arrive a few frames later
+			virtualTexture.update();
+			GLState::bindTexture(1, GL_TEXTURE_2D, virtualTexture.pageTableTexture());
+			virtualTexture.beginFeedback(framebufferWidth, framebufferHeight);
+			drawTrangles(*feedbackShader, textureTarget, texture);
+			virtualTexture.endFeedback();
+		}
 		clearColor(BG);
-		drawTrangles(triangleShader, texture);
+		// the quad covers half the framebuffer in each direction
+		textureResidency.touch(texture, framebufferWidth / 2, framebufferHeight / 2);
+		drawTrangles(triangleShader, textureTarget, texture);
 
 		// poll for events and swap buffers
 		glfwPollEvents();
 		glfwSwapBuffers(window);
+
+		GLState::endFrame();
+		hitchDetector.endFrame(glfwGetTime());
+		reportFrameStats(window);
 	}
 
 	exit_clean(0, "");
@@ -103,7 +322,7 @@ int main()
 // Functions
 void framebufferSizeCallback(GLFWwindow *window, int width, int height)
 {
-	glViewport(0, 0, width, height);
+	GLState::viewport(0, 0, width, height);
 }
 
 void processWindowInput(GLFWwindow *window)
@@ -121,7 +340,7 @@ void processWindowInput(GLFWwindow *window)
 	if (wKeyState == GLFW_RELEASE && find(pressedKeys.begin(), pressedKeys.end(), GLFW_KEY_W) != pressedKeys.end())
 	{
 		cout << "wireframe mode on." << endl;
-		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+		GLState::polygonMode(GL_LINE);
 		pressedKeys.erase(find(pressedKeys.begin(), pressedKeys.end(), GLFW_KEY_W));
 	}
 
@@ -133,7 +352,7 @@ void processWindowInput(GLFWwindow *window)
 	if (fKeyState == GLFW_RELEASE && find(pressedKeys.begin(), pressedKeys.end(), GLFW_KEY_F) != pressedKeys.end())
 	{
 		cout << "fill mode on." << endl;
-		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+		GLState::polygonMode(GL_FILL);
 		pressedKeys.erase(find(pressedKeys.begin(), pressedKeys.end(), GLFW_KEY_F));
 	}
 
@@ -145,29 +364,49 @@ void processWindowInput(GLFWwindow *window)
 	if (pKeyState == GLFW_RELEASE && find(pressedKeys.begin(), pressedKeys.end(), GLFW_KEY_P) != pressedKeys.end())
 	{
 		cout << "point mode on." << endl;
-		glPolygonMode(GL_FRONT_AND_BACK, GL_POINT);
+		GLState::polygonMode(GL_POINT);
 		pressedKeys.erase(find(pressedKeys.begin(), pressedKeys.end(), GLFW_KEY_P));
 	}
+
+	// held down, per frame
+	if (glfwGetKey(window, GLFW_KEY_MINUS) == GLFW_PRESS)
+	{
+		modelZoom = max(0.001f, modelZoom * 0.97f);
+	}
+	if (glfwGetKey(window, GLFW_KEY_EQUAL) == GLFW_PRESS)
+	{
+		modelZoom = min(100.0f, modelZoom / 0.97f);
+	}
 }
 
 void cleanVObjects()
 {
 	for (unsigned int vao : VAOs)
 	{
-		glDeleteVertexArrays(1, &vao);
+		GLState::deleteVertexArray(vao);
 	}
 	for (unsigned int vbo : VBOs)
 	{
-		glDeleteBuffers(1, &vbo);
+		GLState::deleteBuffer(vbo);
 	}
 	for (unsigned int ebo : EBOs)
 	{
-		glDeleteBuffers(1, &ebo);
+		GLState::deleteBuffer(ebo);
+	}
+	for (unsigned int texture : sceneTextures)
+	{
+		GLState::deleteTexture(texture);
 	}
 
 	VAOs.clear();
 	VBOs.clear();
 	EBOs.clear();
+	indexCounts.clear();
+	indexTypes.clear();
+	indexOffsets.clear();
+	drawTextures.clear();
+	drawLods.clear();
+	sceneTextures.clear();
 }
 
 int exit_clean(int const &code, string const &reason)
@@ -178,11 +417,14 @@ int exit_clean(int const &code, string const &reason)
 	}
 
 	cleanVObjects();
+	shaderReloader.reset();
+	frameBlock.destroy();
+	textureLoader.destroy();
+	textureResidency.destroy();
+	textureArrays.destroy();
+	virtualTexture.destroy();
 
-	for (auto const &[_, shaderProgram] : shaderPrograms)
-	{
-		glDeleteProgram(shaderProgram.programId);
-	}
+	triangleShaders.clear();
 
 	glfwTerminate();
 	return code;
@@ -190,97 +432,366 @@ int exit_clean(int const &code, string const &reason)
 
 void clearColor(Color c)
 {
-	glClearColor(c.get(Color::R), c.get(Color::G), c.get(Color::B), c.get(Color::A));
+	GLState::clearColor(c.get(Color::R), c.get(Color::G), c.get(Color::B), c.get(Color::A));
 	glClear(GL_COLOR_BUFFER_BIT);
 }
 
-void setupShader(const char *vertexFileName, const char *fragmentFileName, const SHADERS &ShaderId)
+void setupFrameBlock()
 {
-	char *vertexPath = CharUtil::concat(SHADERS_BASE_PATH, vertexFileName);
-	char *fragmentPath = CharUtil::concat(SHADERS_BASE_PATH, fragmentFileName);
+	frameBlock.create("Frame", UBO_FRAME);
 
-	Shader shader(vertexPath, fragmentPath);
-	shaderPrograms.insert_or_assign(ShaderId, shader);
+	// identity transform
+	for (int i = 0; i < 16; i++)
+	{
+		frameBlock.data.transform.m[i] = i % 5 == 0 ? 1.f : 0.f;
+	}
 }
 
-void setupTexture(const char *fileName, const string &textureName)
+void updateFrameBlock()
 {
-	char *containerPath = CharUtil::concat(TEXTURES_BASE_PATH, fileName);
-	int width, height, nrChannels;
-	unsigned int texture;
-	unsigned char *data = stbi_load(containerPath, &width, &height, &nrChannels, 0);
+	// zoomed about the clip space origin, where fitBounds centres the scene
+	for (int i = 0; i < 3; i++)
+	{
+		frameBlock.data.transform.m[i * 5] = modelScale[i] * modelZoom;
+		frameBlock.data.transform.m[12 + i] = modelOffset[i] * modelZoom;
+	}
+	frameBlock.data.time = (float)glfwGetTime();
+	frameBlock.upload();
+}
 
-	glGenTextures(1, &texture);
-	glBindTexture(GL_TEXTURE_2D, texture);
+void setupShaders(const vector<SHADERS> &used)
+{
+	vector<unsigned int> masks;
+	for (const SHADERS &shaderId : used)
+	{
+		masks.push_back(SHADER_VARIANTS.at(shaderId));
+	}
+	triangleShaders.prepare(masks);
+}
 
-	// set the texture wrapping/filtering options (on the currently bound texture object)
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+void warmupPipelines()
+{
+	vector<Shader *> shaders;
+	for (unsigned int mask : triangleShaders.compiled())
+	{
+		shaders.push_back(&triangleShaders.get(mask));
+	}
 
-	if (data)
+	// the programs read the frame block, make sure it is bound
+	updateFrameBlock();
+	double ms = PipelineWarmup::run(shaders, VAOs, indexTypes);
+	cout << "pipeline warm-up: " << shaders.size() << " programs x " << VAOs.size() << " vertex layouts in " << ms << " ms" << endl;
+}
+
+Shader &getShader(const SHADERS &shaderId)
+{
+	return triangleShaders.get(SHADER_VARIANTS.at(shaderId));
+}
+
+void watchShaders(GLFWwindow *window)
+{
+	shaderReloader = make_unique<ShaderReloader>(window, SHADERS_BASE_PATH);
+	shaderReloader->watch(&triangleShaders);
+	shaderReloader->start();
+}
+
+void reloadShaders()
+{
+	if (shaderReloader)
 	{
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
+		shaderReloader->apply();
+	}
+}
+
+void setupAtlas()
+{
+	vector<string> pageFiles;
+	vector<AtlasEntry> entries;
+	if (!AtlasPacker::readManifest(string(TEXTURES_BASE_PATH) + ATLAS_MANIFEST, pageFiles, entries))
+	{
+		return;
+	}
 
-		textures[textureName] = texture;
+	// pages have no source image, the loader maps the .ltex directly
+	for (const string &pageFile : pageFiles)
+	{
+		atlasPages.push_back(textureLoader.load(string(TEXTURES_BASE_PATH) + pageFile, GL_CLAMP_TO_EDGE));
 	}
-	else
+	for (const AtlasEntry &entry : entries)
 	{
-		std::cout << "Failed to load texture" << std::endl;
+		atlasEntries[entry.name] = entry;
 	}
-	stbi_image_free(data);
+	cout << "atlas: " << entries.size() << " images on " << pageFiles.size() << " pages" << endl;
+}
+
+void setupTexture(const char *fileName, const string &textureName)
+{
+	if (useTextureArrays)
+	{
+		// resolved together in setupTextureArrays
+		arrayTexturePaths[textureName] = string(TEXTURES_BASE_PATH) + fileName;
+		textureArrays.add(arrayTexturePaths[textureName]);
+		return;
+	}
+
+	auto region = atlasEntries.find(fileName);
+	if (region != atlasEntries.end())
+	{
+		textures[textureName] = atlasPages[region->second.page];
+		textureRegions[textureName] = region->second;
+		return;
+	}
+
+	// returns right away with a placeholder, the image streams in over the next frames
+	textures[textureName] = textureLoader.load(string(TEXTURES_BASE_PATH) + fileName);
+}
+
+void setupTextureArrays()
+{
+	if (arrayTexturePaths.empty())
+	{
+		return;
+	}
+
+	textureArrays.build();
+	for (const auto &entry : arrayTexturePaths)
+	{
+		TextureLayer layer;
+		if (textureArrays.find(entry.second, layer))
+		{
+			textures[entry.first] = layer.texture;
+			textureLayers[entry.first] = layer.layer;
+		}
+	}
+	cout << "texture arrays: " << textureArrays.layerCount() << " textures in " << textureArrays.arrayCount() << " arrays" << endl;
 }
 
 void setupTriangles()
 {
-	unsigned int VAO, VBO, EBO;
+	// texture array layer, so quads with different textures can share one bind
+	auto layer = textureLayers.find(TEX_CONTAINER);
+	float L = layer != textureLayers.end() ? (float)layer->second : 0.0f;
+
 	float vertices[] = {
-		// positions      // colors         // texture coords
-		0.5f, 0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f,	  // top right
-		0.5f, -0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f,  // bottom right
-		-0.5f, -0.5f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, // bottom left
-		-0.5f, 0.5f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f	  // top left
+		// positions      // colors         // texture coords // layer
+		0.5f, 0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, L,	 // top right
+		0.5f, -0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, L,	 // bottom right
+		-0.5f, -0.5f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, L, // bottom left
+		-0.5f, 0.5f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, L	 // top left
 	};
 
-	unsigned int indices[] = {
+	// an atlased texture only covers part of its page
+	auto region = textureRegions.find(TEX_CONTAINER);
+	if (region != textureRegions.end())
+	{
+		AtlasPacker::remapUVs(vertices, 4, 9, 6, region->second);
+	}
+
+	MeshData quad;
+	quad.attributes = {{0, MESH_FLOAT32, 3, 0, 0}, {1, MESH_FLOAT32, 3, 0, 12}, {2, MESH_FLOAT32, 2, 0, 24}, {3, MESH_FLOAT32, 1, 0, 32}};
+	quad.stride = 9 * sizeof(float);
+	quad.vertices.assign((unsigned char *)vertices, (unsigned char *)vertices + sizeof(vertices));
+	quad.indices = {
 		0, 1, 3, // first triangle
 		1, 2, 3	 // second triangle
 	};
 
-	glGenVertexArrays(1, &VAO);
-	glGenBuffers(1, &VBO);
-	glGenBuffers(1, &EBO);
+	// 36 bytes per vertex as floats, 20 with int16 positions, byte colours and unorm16 texcoords
+	MeshData packed;
+	MeshQuantizer::quantize(quad, vertexFormat, packed);
+	GpuMesh mesh;
+	MeshLoader::upload(packed, mesh);
+	setModelTransform(mesh.dequantizeScale, mesh.dequantizeOffset);
+
+	VAOs.emplace_back(mesh.vao);
+	VBOs.emplace_back(mesh.vertexBuffer);
+	EBOs.emplace_back(mesh.indexBuffer);
+	indexCounts.emplace_back(mesh.indexCount);
+	indexTypes.emplace_back(mesh.indexType);
+	indexOffsets.emplace_back(0);
+	drawTextures.emplace_back(0);
+	drawLods.emplace_back();
+}
 
-	// first triangle setup
-	glBindVertexArray(VAO);
+bool setupMesh(const char *path)
+{
+	auto start = chrono::steady_clock::now();
+	GpuMesh mesh;
+	if (!MeshLoader::load(path, mesh))
+	{
+		return false;
+	}
+	chrono::duration<double, milli> loadTime = chrono::steady_clock::now() - start;
+	cout << "mesh: " << path << ", " << (mesh.lods.empty() ? mesh.indexCount : (GLsizei)mesh.lods[0].indexCount) / 3 << " triangles, "
+		 << max((size_t)1, mesh.lods.size()) << " levels of detail in " << loadTime.count() << " ms" << endl;
+
+	VAOs.emplace_back(mesh.vao);
+	VBOs.emplace_back(mesh.vertexBuffer);
+	EBOs.emplace_back(mesh.indexBuffer);
+	indexCounts.emplace_back(mesh.indexCount);
+	indexTypes.emplace_back(mesh.indexType);
+	indexOffsets.emplace_back(0);
+	drawTextures.emplace_back(0);
+	drawLods.emplace_back(mesh.lods);
+
+	fitBounds(mesh.bounds, mesh.dequantizeScale, mesh.dequantizeOffset);
+	return true;
+}
 
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+bool setupGltf(const char *path)
+{
+	GltfScene scene;
+	GltfImportStats stats;
+	if (!GltfImporter::import(path, scene, &stats))
+	{
+		return false;
+	}
+	cout << "gltf: " << path << ", " << scene.draws.size() << " primitives, " << stats.triangles << " triangles, " << stats.images << " images in "
+		 << stats.openMs + stats.prepareMs + stats.uploadMs << " ms" << endl;
 
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+	// the scene's textures only replace the container where they are sampled the same way
+	bool ownTextures = !useTextureArrays && !virtualTexture.isOpen();
+	for (const GltfDraw &draw : scene.draws)
+	{
+		VAOs.emplace_back(draw.vao);
+		indexCounts.emplace_back(draw.indexCount);
+		indexTypes.emplace_back(draw.indexType);
+		indexOffsets.emplace_back(draw.indexOffset);
+		drawTextures.emplace_back(ownTextures ? draw.texture : 0);
+		drawLods.emplace_back();
+	}
+	// buffers are shared between draws, they are released once with the rest
+	VBOs.insert(VBOs.end(), scene.buffers.begin(), scene.buffers.end());
+	for (unsigned int texture : scene.textures)
+	{
+		if (texture)
+		{
+			sceneTextures.emplace_back(texture);
+		}
+	}
 
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)0);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)(3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)(6 * sizeof(float)));
-	glEnableVertexAttribArray(2);
+	// glTF positions are never quantized relative to the mesh here, normalized ones are decoded by GL
+	const float identityScale[3] = {1.0f, 1.0f, 1.0f}, identityOffset[3] = {0.0f, 0.0f, 0.0f};
+	fitBounds(scene.bounds, identityScale, identityOffset);
+	return true;
+}
 
-	VAOs.emplace_back(VAO);
-	VBOs.emplace_back(VBO);
-	EBOs.emplace_back(EBO);
+void fitBounds(const MeshBounds &bounds, const float dequantizeScale[3], const float dequantizeOffset[3])
+{
+	// meshes without vertex colours draw untinted, disabled arrays read this current value
+	glVertexAttrib3f(1, 1.0f, 1.0f, 1.0f);
+
+	// fit the bounding sphere into clip space, after dequantizing
+	float fit = bounds.radius > 0.0f ? 0.9f / bounds.radius : 1.0f;
+	clipPerUnit = fit;
+	float scale[3], offset[3];
+	for (int i = 0; i < 3; i++)
+	{
+		scale[i] = dequantizeScale[i] * fit;
+		offset[i] = (dequantizeOffset[i] - bounds.center[i]) * fit;
+	}
+	setModelTransform(scale, offset);
 }
 
-void drawTrangles(Shader &shader, const unsigned int &texture)
+void setModelTransform(const float scale[3], const float offset[3])
 {
-	for (int i = 0; i < sizeof(VAOs); i++)
+	// the frame block picks it up with the zoom applied
+	for (int i = 0; i < 3; i++)
 	{
+		modelScale[i] = scale[i];
+		modelOffset[i] = offset[i];
+	}
+}
+
+void drawTrangles(Shader &shader, const GLenum &target, const unsigned int &texture)
+{
+	for (size_t i = 0; i < VAOs.size(); i++)
+	{
+		// repeated binds are elided by GLState
 		shader.use();
-		glBindTexture(GL_TEXTURE_2D, texture);
-		glBindVertexArray(VAOs[i]);
-		glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+		shader.params.flush();
+		GLState::bindTexture(0, target, drawTextures[i] ? drawTextures[i] : texture);
+		GLState::bindVertexArray(VAOs[i]);
+		GLsizei count = indexCounts[i];
+		size_t offset = indexOffsets[i];
+		if (!drawLods[i].empty())
+		{
+			const MeshLod &lod = drawLods[i][lodSelector.level(i)];
+			count = (GLsizei)lod.indexCount;
+			offset += (size_t)lod.indexOffset * (indexTypes[i] == GL_UNSIGNED_SHORT ? 2 : 4);
+		}
+		glDrawElements(GL_TRIANGLES, count, indexTypes[i], (void *)offset);
+	}
+}
+
+bool hasArg(int argc, char **argv, const char *arg)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], arg) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+int intArg(int argc, char **argv, const char *arg, const int &fallback)
+{
+	for (int i = 1; i + 1 < argc; i++)
+	{
+		if (strcmp(argv[i], arg) == 0)
+		{
+			return atoi(argv[i + 1]);
+		}
 	}
+	return fallback;
+}
+
+const char *stringArg(int argc, char **argv, const char *arg, const char *fallback)
+{
+	for (int i = 1; i + 1 < argc; i++)
+	{
+		if (strcmp(argv[i], arg) == 0)
+		{
+			return argv[i + 1];
+		}
+	}
+	return fallback;
+}
+
+void reportFrameStats(GLFWwindow *window)
+{
+	static double windowStart = glfwGetTime();
+	static int frames = 0;
+
+	frames++;
+	double now = glfwGetTime();
+	if (now - windowStart < 1.0)
+	{
+		return;
+	}
+
+	const GLState::Counters &counters = GLState::lastFrame();
+	const TextureResidency::Counters &residency = textureResidency.counters();
+	string title = "LearnOpenGL - " + to_string(frames) + " fps, GL state calls " + to_string(counters.issued) + " issued / " +
+				   to_string(counters.elided) + " elided per frame, textures " + to_string(residency.residentBytes >> 10) + "/" +
+				   to_string(residency.budgetBytes >> 10) + " KB, " + to_string(residency.evictions) + " evictions, stream-in " +
+				   to_string((int)residency.averageStreamInMs) + " ms avg";
+	if (virtualTexture.isOpen())
+	{
+		const VirtualTexture::Counters &pages = virtualTexture.counters();
+		title += ", virtual pages " + to_string(pages.residentPages) + "/" + to_string(pages.cacheCapacity) + " (" + to_string(pages.visiblePages) +
+				 " visible, " + to_string(pages.pendingReads) + " reading, " + to_string(pages.evictions) + " evicted)";
+	}
+	const LodSelector::Counters &lods = lodSelector.counters();
+	if (lods.fullTriangles > 0)
+	{
+		title += ", LOD triangles " + to_string(lods.drawnTriangles) + "/" + to_string(lods.fullTriangles) + " (" +
+				 to_string(lods.fullTriangles - lods.drawnTriangles) + " saved per frame, " + to_string(lods.switches) + " switches)";
+	}
+	glfwSetWindowTitle(window, title.c_str());
+
+	windowStart = now;
+	frames = 0;
 }
\ No newline at end of file
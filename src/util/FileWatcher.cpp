@@ -0,0 +1,135 @@
+#include "util/FileWatcher.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// editors usually write a file in several steps, wait this long for the rest of a burst
+static const int COALESCE_MS = 50;
+
+#ifdef __linux__
+
+FileWatcher::FileWatcher(const std::string &directory) : m_inotify(-1), m_watch(-1), m_wakePipe{-1, -1}
+{
+	m_inotify = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+	if (m_inotify < 0 || pipe(m_wakePipe) != 0)
+	{
+		cout << "ERROR::FILE_WATCHER::INIT_FAILED" << endl;
+		return;
+	}
+
+	// CLOSE_WRITE covers in-place saves, MOVED_TO covers editors that write a temp file and rename it
+	m_watch = inotify_add_watch(m_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+	if (m_watch < 0)
+	{
+		cout << "ERROR::FILE_WATCHER::CANNOT_WATCH " << directory << endl;
+	}
+}
+
+FileWatcher::~FileWatcher()
+{
+	if (m_inotify >= 0)
+	{
+		close(m_inotify);
+	}
+	if (m_wakePipe[0] >= 0)
+	{
+		close(m_wakePipe[0]);
+		close(m_wakePipe[1]);
+	}
+}
+
+bool FileWatcher::isActive() const
+{
+	return m_watch >= 0;
+}
+
+void FileWatcher::drain(std::vector<std::string> &changed)
+{
+	alignas(inotify_event) char buffer[4096];
+	ssize_t length;
+	while ((length = read(m_inotify, buffer, sizeof(buffer))) > 0)
+	{
+		for (char *p = buffer; p < buffer + length;)
+		{
+			inotify_event *event = (inotify_event *)p;
+			if (event->len > 0)
+			{
+				string name(event->name);
+				if (find(changed.begin(), changed.end(), name) == changed.end())
+				{
+					changed.push_back(name);
+				}
+			}
+			p += sizeof(inotify_event) + event->len;
+		}
+	}
+}
+
+bool FileWatcher::wait(std::vector<std::string> &changed)
+{
+	changed.clear();
+	if (!isActive())
+	{
+		return false;
+	}
+
+	pollfd fds[2] = {{m_inotify, POLLIN, 0}, {m_wakePipe[0], POLLIN, 0}};
+	while (changed.empty())
+	{
+		if (poll(fds, 2, -1) < 0 || (fds[1].revents & POLLIN))
+		{
+			return false;
+		}
+		drain(changed);
+	}
+
+	// coalesce the rest of the burst
+	while (poll(fds, 1, COALESCE_MS) > 0)
+	{
+		drain(changed);
+	}
+	return true;
+}
+
+void FileWatcher::stop()
+{
+	if (m_wakePipe[1] >= 0)
+	{
+		char wake = 1;
+		(void)!write(m_wakePipe[1], &wake, 1);
+	}
+}
+
+#else
+
+FileWatcher::FileWatcher(const std::string &directory) : m_inotify(-1), m_watch(-1), m_wakePipe{-1, -1}
+{
+	cout << "WARNING::FILE_WATCHER::UNSUPPORTED_PLATFORM " << directory << " will not be watched" << endl;
+}
+
+FileWatcher::~FileWatcher() {}
+
+bool FileWatcher::isActive() const
+{
+	return false;
+}
+
+void FileWatcher::drain(std::vector<std::string> &changed) {}
+
+bool FileWatcher::wait(std::vector<std::string> &changed)
+{
+	changed.clear();
+	return false;
+}
+
+void FileWatcher::stop() {}
+
+#endif
\ No newline at end of file
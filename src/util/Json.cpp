@@ -0,0 +1,426 @@
+#include "util/Json.hpp"
+
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+static const JsonValue NULL_VALUE;
+
+// recursive descent over the text, nesting is limited so hostile files cannot exhaust the stack
+class JsonParser
+{
+private:
+	const char *m_p;
+	const char *m_end;
+	string m_error;
+
+	static const int MAX_DEPTH = 128;
+
+	bool fail(const char *reason)
+	{
+		if (m_error.empty())
+		{
+			m_error = reason;
+		}
+		return false;
+	}
+
+	void skipSpaces()
+	{
+		while (m_p < m_end && (*m_p == ' ' || *m_p == '\t' || *m_p == '\n' || *m_p == '\r'))
+		{
+			m_p++;
+		}
+	}
+
+	bool literal(const char *word)
+	{
+		size_t length = strlen(word);
+		if ((size_t)(m_end - m_p) < length || memcmp(m_p, word, length) != 0)
+		{
+			return fail("invalid literal");
+		}
+		m_p += length;
+		return true;
+	}
+
+	static void appendUtf8(string &out, const uint32_t &codepoint)
+	{
+		if (codepoint < 0x80)
+		{
+			out += (char)codepoint;
+		}
+		else if (codepoint < 0x800)
+		{
+			out += (char)(0xC0 | codepoint >> 6);
+			out += (char)(0x80 | (codepoint & 0x3F));
+		}
+		else if (codepoint < 0x10000)
+		{
+			out += (char)(0xE0 | codepoint >> 12);
+			out += (char)(0x80 | (codepoint >> 6 & 0x3F));
+			out += (char)(0x80 | (codepoint & 0x3F));
+		}
+		else
+		{
+			out += (char)(0xF0 | codepoint >> 18);
+			out += (char)(0x80 | (codepoint >> 12 & 0x3F));
+			out += (char)(0x80 | (codepoint >> 6 & 0x3F));
+			out += (char)(0x80 | (codepoint & 0x3F));
+		}
+	}
+
+	bool hex4(uint32_t &value)
+	{
+		if (m_end - m_p < 4)
+		{
+			return fail("truncated escape");
+		}
+		value = 0;
+		for (int i = 0; i < 4; i++)
+		{
+			char c = *m_p++;
+			value <<= 4;
+			if (c >= '0' && c <= '9')
+			{
+				value |= c - '0';
+			}
+			else if (c >= 'a' && c <= 'f')
+			{
+				value |= c - 'a' + 10;
+			}
+			else if (c >= 'A' && c <= 'F')
+			{
+				value |= c - 'A' + 10;
+			}
+			else
+			{
+				return fail("invalid escape");
+			}
+		}
+		return true;
+	}
+
+	bool parseString(string &out)
+	{
+		// at the opening quote
+		m_p++;
+		while (true)
+		{
+			const char *run = m_p;
+			while (m_p < m_end && *m_p != '"' && *m_p != '\\')
+			{
+				m_p++;
+			}
+			out.append(run, m_p - run);
+			if (m_p >= m_end)
+			{
+				return fail("unterminated string");
+			}
+			if (*m_p++ == '"')
+			{
+				return true;
+			}
+			if (m_p >= m_end)
+			{
+				return fail("unterminated string");
+			}
+			char escape = *m_p++;
+			switch (escape)
+			{
+			case '"':
+			case '\\':
+			case '/':
+				out += escape;
+				break;
+			case 'b':
+				out += '\b';
+				break;
+			case 'f':
+				out += '\f';
+				break;
+			case 'n':
+				out += '\n';
+				break;
+			case 'r':
+				out += '\r';
+				break;
+			case 't':
+				out += '\t';
+				break;
+			case 'u':
+			{
+				uint32_t codepoint;
+				if (!hex4(codepoint))
+				{
+					return false;
+				}
+				// surrogate pair
+				if (codepoint >= 0xD800 && codepoint < 0xDC00 && m_end - m_p >= 6 && m_p[0] == '\\' && m_p[1] == 'u')
+				{
+					m_p += 2;
+					uint32_t low;
+					if (!hex4(low))
+					{
+						return false;
+					}
+					codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+				}
+				appendUtf8(out, codepoint);
+				break;
+			}
+			default:
+				return fail("invalid escape");
+			}
+		}
+	}
+
+	bool parseNumber(double &out)
+	{
+		const char *start = m_p;
+		if (m_p < m_end && *m_p == '-')
+		{
+			m_p++;
+		}
+		while (m_p < m_end && ((*m_p >= '0' && *m_p <= '9') || *m_p == '.' || *m_p == 'e' || *m_p == 'E' || *m_p == '+' || *m_p == '-'))
+		{
+			m_p++;
+		}
+		// strtod needs a terminated copy, numbers are short
+		char buffer[64];
+		size_t length = m_p - start;
+		if (length == 0 || length >= sizeof(buffer))
+		{
+			return fail("invalid number");
+		}
+		memcpy(buffer, start, length);
+		buffer[length] = '\0';
+		char *end;
+		out = strtod(buffer, &end);
+		return end == buffer + length ? true : fail("invalid number");
+	}
+
+	bool parseValue(JsonValue &value, const int &depth)
+	{
+		if (depth > MAX_DEPTH)
+		{
+			return fail("nesting too deep");
+		}
+		skipSpaces();
+		if (m_p >= m_end)
+		{
+			return fail("unexpected end");
+		}
+		switch (*m_p)
+		{
+		case '{':
+			value.m_type = JSON_OBJECT;
+			m_p++;
+			skipSpaces();
+			if (m_p < m_end && *m_p == '}')
+			{
+				m_p++;
+				return true;
+			}
+			while (true)
+			{
+				skipSpaces();
+				if (m_p >= m_end || *m_p != '"')
+				{
+					return fail("expected member name");
+				}
+				value.m_members.emplace_back();
+				if (!parseString(value.m_members.back().first))
+				{
+					return false;
+				}
+				skipSpaces();
+				if (m_p >= m_end || *m_p++ != ':')
+				{
+					return fail("expected ':'");
+				}
+				if (!parseValue(value.m_members.back().second, depth + 1))
+				{
+					return false;
+				}
+				skipSpaces();
+				if (m_p < m_end && *m_p == ',')
+				{
+					m_p++;
+					continue;
+				}
+				if (m_p < m_end && *m_p == '}')
+				{
+					m_p++;
+					return true;
+				}
+				return fail("expected ',' or '}'");
+			}
+		case '[':
+			value.m_type = JSON_ARRAY;
+			m_p++;
+			skipSpaces();
+			if (m_p < m_end && *m_p == ']')
+			{
+				m_p++;
+				return true;
+			}
+			while (true)
+			{
+				value.m_items.emplace_back();
+				if (!parseValue(value.m_items.back(), depth + 1))
+				{
+					return false;
+				}
+				skipSpaces();
+				if (m_p < m_end && *m_p == ',')
+				{
+					m_p++;
+					continue;
+				}
+				if (m_p < m_end && *m_p == ']')
+				{
+					m_p++;
+					return true;
+				}
+				return fail("expected ',' or ']'");
+			}
+		case '"':
+			value.m_type = JSON_STRING;
+			return parseString(value.m_string);
+		case 't':
+			value.m_type = JSON_BOOL;
+			value.m_bool = true;
+			return literal("true");
+		case 'f':
+			value.m_type = JSON_BOOL;
+			value.m_bool = false;
+			return literal("false");
+		case 'n':
+			value.m_type = JSON_NULL;
+			return literal("null");
+		default:
+			value.m_type = JSON_NUMBER;
+			return parseNumber(value.m_number);
+		}
+	}
+
+public:
+	JsonParser(const char *text, const size_t &length) : m_p(text), m_end(text + length) {}
+
+	bool parse(JsonValue &value, string *error)
+	{
+		bool ok = parseValue(value, 0);
+		skipSpaces();
+		if (ok && m_p != m_end)
+		{
+			ok = fail("trailing characters");
+		}
+		if (!ok && error)
+		{
+			*error = m_error;
+		}
+		return ok;
+	}
+};
+
+JsonValue::JsonValue() : m_type(JSON_NULL), m_bool(false), m_number(0.0)
+{
+}
+
+bool JsonValue::parse(const char *text, const size_t &length, JsonValue &value, std::string *error)
+{
+	value = JsonValue();
+	return JsonParser(text, length).parse(value, error);
+}
+
+JSON_TYPES JsonValue::type() const
+{
+	return m_type;
+}
+
+bool JsonValue::isNull() const
+{
+	return m_type == JSON_NULL;
+}
+
+bool JsonValue::isNumber() const
+{
+	return m_type == JSON_NUMBER;
+}
+
+bool JsonValue::isString() const
+{
+	return m_type == JSON_STRING;
+}
+
+bool JsonValue::isArray() const
+{
+	return m_type == JSON_ARRAY;
+}
+
+bool JsonValue::isObject() const
+{
+	return m_type == JSON_OBJECT;
+}
+
+bool JsonValue::boolean(const bool &fallback) const
+{
+	return m_type == JSON_BOOL ? m_bool : fallback;
+}
+
+double JsonValue::number(const double &fallback) const
+{
+	return m_type == JSON_NUMBER ? m_number : fallback;
+}
+
+int JsonValue::integer(const int &fallback) const
+{
+	// out of range or fractional values would not survive the cast
+	return m_type == JSON_NUMBER && m_number >= INT_MIN && m_number <= INT_MAX && floor(m_number) == m_number ? (int)m_number : fallback;
+}
+
+const std::string &JsonValue::string() const
+{
+	return m_string;
+}
+
+size_t JsonValue::size() const
+{
+	if (m_type == JSON_OBJECT)
+	{
+		return m_members.size();
+	}
+	return m_items.size();
+}
+
+const JsonValue &JsonValue::operator[](const size_t &index) const
+{
+	return m_type == JSON_ARRAY && index < m_items.size() ? m_items[index] : NULL_VALUE;
+}
+
+const JsonValue &JsonValue::operator[](const char *key) const
+{
+	for (const auto &member : m_members)
+	{
+		if (member.first == key)
+		{
+			return member.second;
+		}
+	}
+	return NULL_VALUE;
+}
+
+bool JsonValue::has(const char *key) const
+{
+	return !(*this)[key].isNull();
+}
+
+const std::vector<std::pair<std::string, JsonValue>> &JsonValue::members() const
+{
+	return m_members;
+}
\ No newline at end of file
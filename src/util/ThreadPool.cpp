@@ -0,0 +1,104 @@
+#include "util/ThreadPool.hpp"
+
+#include <algorithm>
+
+using namespace std;
+
+ThreadPool::ThreadPool(unsigned int threads) : m_stopping(false)
+{
+	threads = max(1u, threads);
+	for (unsigned int i = 0; i < threads; i++)
+	{
+		m_workers.emplace_back(&ThreadPool::work, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_condition.notify_all();
+	for (thread &worker : m_workers)
+	{
+		worker.join();
+	}
+}
+
+ThreadPool &ThreadPool::shared()
+{
+	static ThreadPool pool(thread::hardware_concurrency());
+	return pool;
+}
+
+unsigned int ThreadPool::size() const
+{
+	return (unsigned int)m_workers.size();
+}
+
+void ThreadPool::work()
+{
+	while (true)
+	{
+		function<void()> task;
+		{
+			unique_lock<mutex> lock(m_mutex);
+			m_condition.wait(lock, [this]
+							 { return m_stopping || !m_tasks.empty(); });
+			if (m_stopping && m_tasks.empty())
+			{
+				return;
+			}
+			task = move(m_tasks.front());
+			m_tasks.pop();
+		}
+		task();
+	}
+}
+
+bool ThreadPool::runOne()
+{
+	function<void()> task;
+	{
+		lock_guard<mutex> lock(m_mutex);
+		if (m_tasks.empty())
+		{
+			return false;
+		}
+		task = move(m_tasks.front());
+		m_tasks.pop();
+	}
+	task();
+	return true;
+}
+
+void ThreadPool::parallelFor(const int &begin, const int &end, const std::function<void(int)> &body)
+{
+	const int count = end - begin;
+	if (count <= 0)
+	{
+		return;
+	}
+
+	// a few chunks per worker keeps uneven rows balanced without queueing one task per index
+	const int chunks = min(count, (int)size() * 4);
+	vector<future<void>> pending;
+	pending.reserve(chunks);
+	for (int c = 0; c < chunks; c++)
+	{
+		int from = begin + (int)((long long)count * c / chunks);
+		int to = begin + (int)((long long)count * (c + 1) / chunks);
+		pending.push_back(submit([from, to, &body]()
+								 {
+			for (int i = from; i < to; i++)
+			{
+				body(i);
+			} }));
+	}
+	for (future<void> &p : pending)
+	{
+		wait(p);
+		p.get();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,736 @@
+// Offline asset baking.
+//
+//	bake texture [--compress] [--fast] [--kaiser] [--alpha-cutoff <0..1>] <source image> <output .ltex>
+//	bake bc-report <source image>
+//	bake mip-report <source image>
+//	bake atlas [--page <size>] [--gutter <texels>] [--compress] <output .atlas> <source images...>
+//	bake jpeg-report <source images...>
+//	bake vt [--tile <texels>] [--border <texels>] <source image> <output .vtex>
+//	bake mesh [--vertex-format <float|half|int16>] [--no-optimize] [--no-lods] <source .obj> <output .lmesh>
+//	bake mesh-grid [--vertex-format <float|half|int16>] [--no-optimize] [--no-lods] <quads per side> <output .lmesh>
+//	bake meshes [--vertex-format <float|half|int16>] [--no-optimize] [--no-lods] <output directory> <source .obj/.lmesh...>
+//	bake quantize-report <source .obj/.lmesh...>
+//	bake optimize-report <source .obj/.lmesh...>
+//	bake gltf-report <source .gltf/.glb...>
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <stb/stb_image.h>
+
+#include "asset/TextureBaker.hpp"
+#include "asset/BlockCompressor.hpp"
+#include "asset/MipGenerator.hpp"
+#include "asset/AtlasPacker.hpp"
+#include "asset/JpegDecoder.hpp"
+#include "asset/VirtualTextureFile.hpp"
+#include "asset/MeshFile.hpp"
+#include "asset/ObjImporter.hpp"
+#include "asset/MeshQuantizer.hpp"
+#include "asset/MeshOptimizer.hpp"
+#include "asset/MeshSimplifier.hpp"
+#include "asset/GltfFile.hpp"
+#include "util/MappedFile.hpp"
+#include "util/ThreadPool.hpp"
+
+#include <filesystem>
+
+using namespace std;
+
+static int usage()
+{
+	cout << "usage:" << endl
+		 << "  bake texture [--compress] [--fast] [--kaiser] [--alpha-cutoff <0..1>] <source image> <output .ltex>" << endl
+		 << "  bake bc-report <source image>" << endl
+		 << "  bake mip-report <source image>" << endl
+		 << "  bake atlas [--page <size>] [--gutter <texels>] [--compress] <output .atlas> <source images...>" << endl
+		 << "  bake jpeg-report <source images...>" << endl
+		 << "  bake vt [--tile <texels>] [--border <texels>] <source image> <output .vtex>" << endl
+		 << "  bake mesh [--vertex-format <float|half|int16>] [--no-optimize] [--no-lods] <source .obj> <output .lmesh>" << endl
+		 << "  bake mesh-grid [--vertex-format <float|half|int16>] [--no-optimize] [--no-lods] <quads per side> <output .lmesh>" << endl
+		 << "  bake meshes [--vertex-format <float|half|int16>] [--no-optimize] [--no-lods] <output directory> <source .obj/.lmesh...>" << endl
+		 << "  bake quantize-report <source .obj/.lmesh...>" << endl
+		 << "  bake optimize-report <source .obj/.lmesh...>" << endl
+		 << "  bake gltf-report <source .gltf/.glb...>" << endl;
+	return 1;
+}
+
+static double psnr(const TextureLevel &source, const int &channels, const vector<unsigned char> &decoded)
+{
+	double error = 0.0;
+	size_t pixels = (size_t)source.width * source.height;
+	for (size_t i = 0; i < pixels; i++)
+	{
+		for (int c = 0; c < channels; c++)
+		{
+			double d = (double)source.data[i * channels + c] - decoded[i * 4 + c];
+			error += d * d;
+		}
+	}
+	double mse = error / (pixels * channels);
+	return mse == 0.0 ? INFINITY : 10.0 * log10(255.0 * 255.0 / mse);
+}
+
+// compresses the image at every quality, single threaded and on the pool, and prints quality and throughput
+static int bcReport(const char *path)
+{
+	int width, height, nrChannels;
+	unsigned char *data = stbi_load(path, &width, &height, &nrChannels, 0);
+	if (!data || nrChannels < 3)
+	{
+		cout << "ERROR::BAKE::UNSUPPORTED_IMAGE " << path << endl;
+		stbi_image_free(data);
+		return 1;
+	}
+	TextureLevel level = {(uint32_t)width, (uint32_t)height, vector<unsigned char>(data, data + (size_t)width * height * nrChannels)};
+	stbi_image_free(data);
+
+	uint32_t format = nrChannels == 4 ? TEX_FMT_BC3 : TEX_FMT_BC1;
+	unsigned int threads = max(1u, thread::hardware_concurrency());
+	double megapixels = (double)width * height / 1e6;
+	const int REPEATS = 5;
+
+	cout << path << " " << width << "x" << height << " " << (format == TEX_FMT_BC1 ? "BC1" : "BC3") << ", " << threads << " threads" << endl;
+	const BC_QUALITY QUALITIES[] = {BC_FAST, BC_NORMAL};
+	const char *NAMES[] = {"fast", "normal"};
+	for (int q = 0; q < 2; q++)
+	{
+		double seconds[2];
+		TextureLevel compressed;
+		for (int parallel = 0; parallel < 2; parallel++)
+		{
+			auto start = chrono::steady_clock::now();
+			for (int i = 0; i < REPEATS; i++)
+			{
+				compressed = BlockCompressor::compress(level, nrChannels, format, QUALITIES[q], parallel);
+			}
+			seconds[parallel] = chrono::duration<double>(chrono::steady_clock::now() - start).count() / REPEATS;
+		}
+
+		double single = megapixels / seconds[0], all = megapixels / seconds[1];
+		cout << "  " << NAMES[q] << ": PSNR " << psnr(level, nrChannels, BlockCompressor::decompress(compressed, format)) << " dB, "
+			 << single << " MPix/s single, " << all << " MPix/s all threads (" << all / threads << " per core)" << endl;
+	}
+	return 0;
+}
+
+// times the full chain for every filter, single threaded and on the pool
+static int mipReport(const char *path)
+{
+	int width, height, nrChannels;
+	unsigned char *data = stbi_load(path, &width, &height, &nrChannels, 0);
+	if (!data)
+	{
+		cout << "ERROR::BAKE::FILE_NOT_READ " << path << endl;
+		return 1;
+	}
+
+	unsigned int threads = max(1u, thread::hardware_concurrency());
+	const int REPEATS = 10;
+	cout << path << " " << width << "x" << height << "x" << nrChannels << ", " << threads << " threads" << endl;
+
+	const MIP_FILTERS FILTERS[] = {MIP_BOX, MIP_KAISER};
+	const char *NAMES[] = {"box", "kaiser"};
+	for (int f = 0; f < 2; f++)
+	{
+		double ms[2];
+		vector<TextureLevel> levels;
+		for (int parallel = 0; parallel < 2; parallel++)
+		{
+			MipOptions options;
+			options.filter = FILTERS[f];
+			options.parallel = parallel;
+			auto start = chrono::steady_clock::now();
+			for (int i = 0; i < REPEATS; i++)
+			{
+				MipGenerator::generate(data, width, height, nrChannels, options, levels);
+			}
+			ms[parallel] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / REPEATS;
+		}
+		cout << "  " << NAMES[f] << ": " << levels.size() << " levels, " << ms[0] << " ms single, " << ms[1] << " ms all threads" << endl;
+	}
+	stbi_image_free(data);
+	return 0;
+}
+
+// decode latency of stb_image against JpegDecoder, single threaded and on the pool
+static int jpegReport(int argc, char **argv)
+{
+	unsigned int threads = max(1u, thread::hardware_concurrency());
+	const int REPEATS = 5;
+	cout << threads << " threads" << endl;
+
+	for (int arg = 2; arg < argc; arg++)
+	{
+		int width, height, nrChannels;
+		double ms[3];
+		for (int run = 0; run < 3; run++)
+		{
+			auto start = chrono::steady_clock::now();
+			for (int i = 0; i < REPEATS; i++)
+			{
+				unsigned char *data = run == 0 ? stbi_load(argv[arg], &width, &height, &nrChannels, 0)
+											   : JpegDecoder::load(argv[arg], &width, &height, &nrChannels, 0, run == 2);
+				if (!data)
+				{
+					cout << "ERROR::BAKE::UNSUPPORTED_IMAGE " << argv[arg] << endl;
+					return 1;
+				}
+				stbi_image_free(data);
+			}
+			ms[run] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / REPEATS;
+		}
+		cout << "  " << argv[arg] << " " << width << "x" << height << "x" << nrChannels << ": stb " << ms[0] << " ms, "
+			 << ms[1] << " ms single, " << ms[2] << " ms all threads" << endl;
+	}
+	return 0;
+}
+
+// cuts the image's mip chain into the tiled page file the runtime virtual texture streams from
+static int virtualTexture(int argc, char **argv)
+{
+	uint32_t tileSize = 128, border = 4;
+	int arg = 2;
+	for (; arg < argc && strncmp(argv[arg], "--", 2) == 0; arg++)
+	{
+		if (strcmp(argv[arg], "--tile") == 0 && arg + 1 < argc)
+		{
+			tileSize = (uint32_t)atoi(argv[++arg]);
+		}
+		else if (strcmp(argv[arg], "--border") == 0 && arg + 1 < argc)
+		{
+			border = (uint32_t)atoi(argv[++arg]);
+		}
+		else
+		{
+			return usage();
+		}
+	}
+	if (argc - arg != 2 || tileSize == 0 || border >= tileSize || tileSize + 2 * border > VirtualTextureFile::MAX_PADDED_SIZE)
+	{
+		return usage();
+	}
+
+	int width, height, nrChannels;
+	unsigned char *data = JpegDecoder::load(argv[arg], &width, &height, &nrChannels, 4);
+	if (!data)
+	{
+		data = stbi_load(argv[arg], &width, &height, &nrChannels, 4);
+	}
+	if (!data)
+	{
+		cout << "ERROR::BAKE::FILE_NOT_READ " << argv[arg] << endl;
+		return 1;
+	}
+	vector<TextureLevel> levels;
+	MipGenerator::generate(data, width, height, 4, MipOptions(), levels);
+	stbi_image_free(data);
+
+	if (!VirtualTextureFile::write(argv[arg + 1], levels, tileSize, border))
+	{
+		return 1;
+	}
+
+	uint64_t pages = 0;
+	uint32_t written = 0;
+	for (const TextureLevel &level : levels)
+	{
+		pages += (uint64_t)VirtualTextureFile::pageCount(level.width, tileSize) * VirtualTextureFile::pageCount(level.height, tileSize);
+		written++;
+		if (VirtualTextureFile::pageCount(level.width, tileSize) == 1 && VirtualTextureFile::pageCount(level.height, tileSize) == 1)
+		{
+			break;
+		}
+	}
+	cout << "baked " << argv[arg] << " -> " << argv[arg + 1] << ": " << width << "x" << height << ", " << written << " levels, " << pages
+		 << " pages of " << tileSize << "+" << border * 2 << " texels, " << (filesystem::file_size(argv[arg + 1]) >> 20) << " MB" << endl;
+	return 0;
+}
+
+struct MeshBakeOptions
+{
+	QuantizeOptions format;
+	bool optimize = true;
+	bool lods = true;
+};
+
+// log is separate from cout so meshes baked on the pool report in order
+static int writeMesh(const string &source, const string &output, MeshData &mesh, const MeshBakeOptions &options, ostream &log)
+{
+	if (options.optimize)
+	{
+		size_t vertexCount = mesh.vertices.size() / mesh.stride;
+		VertexCacheStats before = MeshOptimizer::analyzeVertexCache(mesh.indices, vertexCount, OptimizeOptions().cacheSize);
+		MeshOptimizer::optimize(mesh);
+		VertexCacheStats after = MeshOptimizer::analyzeVertexCache(mesh.indices, mesh.vertices.size() / mesh.stride, OptimizeOptions().cacheSize);
+		log << "optimized " << source << ": ACMR " << before.acmr << " -> " << after.acmr << ", ATVR " << before.atvr << " -> " << after.atvr << endl;
+	}
+	if (options.lods)
+	{
+		// from the float positions, before quantization rounds them
+		auto start = chrono::steady_clock::now();
+		MeshSimplifier::buildLods(mesh);
+		double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+		log << "lods " << source << ":";
+		for (const MeshLod &lod : mesh.lods)
+		{
+			log << " " << lod.indexCount / 3 << " (" << lod.error << ")";
+		}
+		log << (mesh.lods.empty() ? " none, nothing left to collapse" : " triangles (error)") << " in " << ms << " ms" << endl;
+	}
+
+	MeshData packed;
+	MeshQuantizer::quantize(mesh, options.format, packed);
+	if (!MeshFile::write(output, packed))
+	{
+		log << "ERROR::BAKE::MESH_NOT_WRITTEN " << output << endl;
+		return 1;
+	}
+	size_t vertices = packed.vertices.size() / packed.stride;
+	size_t triangles = (packed.lods.empty() ? packed.indices.size() : packed.lods[0].indexCount) / 3;
+	log << "baked " << source << " -> " << output << ": " << vertices << " vertices of " << packed.stride << " bytes (" << mesh.stride << " as floats), "
+		<< triangles << " triangles, " << (vertices <= 0x10000 ? 16 : 32) << " bit indices, " << (filesystem::file_size(output) >> 10) << " KB" << endl;
+	return 0;
+}
+
+static int mesh(const char *source, const char *output, const MeshBakeOptions &options)
+{
+	MeshData data;
+	if (!ObjImporter::load(source, data))
+	{
+		return 1;
+	}
+	return writeMesh(source, output, data, options, cout);
+}
+
+// a flat, vertex coloured grid of quads on [-1, 1], big enough to measure load bandwidth
+static int meshGrid(const int &quads, const char *output, const MeshBakeOptions &options)
+{
+	if (quads <= 0 || quads > 8192)
+	{
+		return usage();
+	}
+
+	MeshData mesh;
+	mesh.attributes = {{0, MESH_FLOAT32, 3, 0, 0}, {1, MESH_FLOAT32, 3, 0, 12}, {2, MESH_FLOAT32, 2, 0, 24}};
+	mesh.stride = 32;
+	uint32_t side = (uint32_t)quads + 1;
+	mesh.vertices.resize((size_t)side * side * mesh.stride);
+	float *vertex = (float *)mesh.vertices.data();
+	for (uint32_t y = 0; y < side; y++)
+	{
+		for (uint32_t x = 0; x < side; x++)
+		{
+			float u = (float)x / quads, v = (float)y / quads;
+			float values[8] = {u * 2.f - 1.f, v * 2.f - 1.f, 0.f, u, v, 1.f - u, u, v};
+			memcpy(vertex, values, sizeof(values));
+			vertex += 8;
+		}
+	}
+	mesh.indices.reserve((size_t)quads * quads * 6);
+	for (uint32_t y = 0; y < (uint32_t)quads; y++)
+	{
+		for (uint32_t x = 0; x < (uint32_t)quads; x++)
+		{
+			uint32_t i = y * side + x;
+			mesh.indices.insert(mesh.indices.end(), {i, i + 1, i + side, i + 1, i + side + 1, i + side});
+		}
+	}
+	return writeMesh("grid", output, mesh, options, cout);
+}
+
+static bool loadMesh(const char *path, MeshData &mesh)
+{
+	size_t length = strlen(path);
+	if (length < 6 || strcmp(path + length - 6, ".lmesh") != 0)
+	{
+		return ObjImporter::load(path, mesh);
+	}
+	MappedFile file;
+	MeshFileView view;
+	if (!file.open(path) || !MeshFile::parse(file.data(), file.size(), view))
+	{
+		cout << "ERROR::BAKE::FILE_NOT_READ " << path << endl;
+		return false;
+	}
+	MeshFile::read(view, mesh);
+	if (!mesh.lods.empty())
+	{
+		// back to the full detail level, coarser ones are rebuilt from it
+		mesh.indices.resize(mesh.lods[0].indexOffset + mesh.lods[0].indexCount);
+		mesh.indices.erase(mesh.indices.begin(), mesh.indices.begin() + mesh.lods[0].indexOffset);
+		mesh.lods.clear();
+	}
+	return true;
+}
+
+// every source on its own pool task, meshes are independent so the bake scales with the core count
+static int meshes(const char *directory, char **sources, const int &count, const MeshBakeOptions &options)
+{
+	error_code error;
+	filesystem::create_directories(directory, error);
+	auto start = chrono::steady_clock::now();
+	vector<future<int>> tasks;
+	vector<ostringstream> logs(count);
+	for (int i = 0; i < count; i++)
+	{
+		tasks.push_back(ThreadPool::shared().submit([&, i]()
+													{
+			MeshData data;
+			if (!loadMesh(sources[i], data))
+			{
+				return 1;
+			}
+			string output = (filesystem::path(directory) / filesystem::path(sources[i]).stem()).string() + ".lmesh";
+			return writeMesh(sources[i], output, data, options, logs[i]); }));
+	}
+	int failed = 0;
+	for (int i = 0; i < count; i++)
+	{
+		ThreadPool::shared().wait(tasks[i]);
+		failed += tasks[i].get() != 0;
+		cout << logs[i].str();
+	}
+	double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+	cout << count - failed << " of " << count << " meshes baked in " << ms << " ms on " << ThreadPool::shared().size() << " threads" << endl;
+	return failed ? 1 : 0;
+}
+
+// ACMR/ATVR after each optimization pass, for a small and a large FIFO cache
+static int optimizeReport(int argc, char **argv)
+{
+	static const int CACHE_SIZES[] = {16, 32};
+	for (int arg = 2; arg < argc; arg++)
+	{
+		MeshData mesh;
+		if (!loadMesh(argv[arg], mesh))
+		{
+			return 1;
+		}
+		size_t vertexCount = mesh.vertices.size() / mesh.stride;
+		cout << argv[arg] << ": " << vertexCount << " vertices, " << mesh.indices.size() / 3 << " triangles" << endl;
+
+		auto print = [&mesh](const char *pass, const double &ms)
+		{
+			cout << "  " << pass;
+			for (int cacheSize : CACHE_SIZES)
+			{
+				VertexCacheStats stats = MeshOptimizer::analyzeVertexCache(mesh.indices, mesh.vertices.size() / mesh.stride, cacheSize);
+				cout << "  cache " << cacheSize << ": ACMR " << stats.acmr << " ATVR " << stats.atvr;
+			}
+			if (ms > 0.0)
+			{
+				cout << "  (" << ms << " ms)";
+			}
+			cout << endl;
+		};
+		print("input:        ", 0.0);
+
+		OptimizeOptions options;
+		vector<uint32_t> clusterStarts;
+		auto start = chrono::steady_clock::now();
+		MeshOptimizer::optimizeVertexCache(mesh.indices, vertexCount, options.cacheSize, &clusterStarts);
+		print("vertex cache: ", chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+		start = chrono::steady_clock::now();
+		MeshOptimizer::optimizeOverdraw(mesh, mesh.indices, clusterStarts, options.cacheSize, options.overdrawThreshold);
+		print("overdraw:     ", chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+		cout << "  " << clusterStarts.size() << " clusters before splitting" << endl;
+		start = chrono::steady_clock::now();
+		MeshOptimizer::optimizeVertexFetch(mesh);
+		print("vertex fetch: ", chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+	}
+	return 0;
+}
+
+// size and precision of every vertex format per mesh, position errors also relative to the bounding radius
+static int quantizeReport(int argc, char **argv)
+{
+	static const char *ATTRIBUTE_NAMES[] = {"position", "colour", "texcoord", "layer", "normal"};
+	for (int arg = 2; arg < argc; arg++)
+	{
+		MeshData original;
+		if (!loadMesh(argv[arg], original))
+		{
+			return 1;
+		}
+		MeshBounds bounds = MeshFile::computeBounds(original);
+		size_t vertices = original.vertices.size() / original.stride;
+		cout << argv[arg] << ": " << vertices << " vertices, " << original.indices.size() / 3 << " triangles, radius " << bounds.radius << endl;
+
+		for (const char *formatName : {"half", "int16"})
+		{
+			QuantizeOptions format;
+			MeshQuantizer::parseFormat(formatName, format);
+			MeshData packed;
+			MeshQuantizer::quantize(original, format, packed);
+			vector<QuantizeError> errors;
+			MeshQuantizer::measure(original, packed, errors);
+
+			cout << "  " << formatName << ": " << original.stride << " -> " << packed.stride << " bytes per vertex ("
+				 << 100.0 * packed.stride / original.stride << "%), indices " << (vertices <= 0x10000 ? 16 : 32) << " bit" << endl;
+			for (const QuantizeError &error : errors)
+			{
+				const char *name = error.location < 5 ? ATTRIBUTE_NAMES[error.location] : "attribute";
+				cout << "    " << name << " " << error.bytesBefore << " -> " << error.bytesAfter << " bytes, max error " << error.maxError << ", rms "
+					 << error.rmsError;
+				if (error.location == MeshFile::POSITION_LOCATION && bounds.radius > 0.f)
+				{
+					cout << " (" << error.maxError / bounds.radius << " of the radius)";
+				}
+				cout << endl;
+			}
+		}
+	}
+	return 0;
+}
+
+// parses and prepares every file serially and on the pool, everything the importer does short of the GL calls
+static int gltfReport(int argc, char **argv)
+{
+	for (int arg = 2; arg < argc; arg++)
+	{
+		double ms[2];
+		GltfPrepared prepared;
+		size_t bytes = 0;
+		for (int parallel = 0; parallel < 2; parallel++)
+		{
+			auto start = chrono::steady_clock::now();
+			GltfDocument document;
+			if (!GltfFile::open(argv[arg], document) || !GltfFile::prepare(document, prepared, parallel == 1))
+			{
+				return 1;
+			}
+			ms[parallel] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+			bytes = 0;
+			for (const std::shared_ptr<MappedFile> &file : document.files)
+			{
+				bytes += file->size();
+			}
+		}
+
+		size_t triangles = 0;
+		for (const GltfPreparedPrimitive &primitive : prepared.primitives)
+		{
+			triangles += primitive.indexCount / 3;
+		}
+		double megabytes = bytes / (1024.0 * 1024.0);
+		cout << argv[arg] << ": " << megabytes << " MB, " << prepared.primitives.size() << " primitives, " << triangles << " triangles, " << prepared.images.size()
+			 << " images, " << (prepared.viewBytes >> 10) << " KB used in place, " << (prepared.convertedBytes >> 10) << " KB converted" << endl
+			 << "  serial:   " << ms[0] << " ms (" << megabytes * 1000.0 / ms[0] << " MB/s)" << endl
+			 << "  parallel: " << ms[1] << " ms (" << megabytes * 1000.0 / ms[1] << " MB/s) on " << ThreadPool::shared().size() << " threads, "
+			 << ms[0] / ms[1] << "x" << endl;
+	}
+	return 0;
+}
+
+// packs the images into pages written next to the manifest as <manifest stem>_<page>.ltex
+static int atlas(int argc, char **argv)
+{
+	AtlasOptions options;
+	bool compress = false;
+	int arg = 2;
+	for (; arg < argc && strncmp(argv[arg], "--", 2) == 0; arg++)
+	{
+		if (strcmp(argv[arg], "--page") == 0 && arg + 1 < argc)
+		{
+			options.pageSize = atoi(argv[++arg]);
+		}
+		else if (strcmp(argv[arg], "--gutter") == 0 && arg + 1 < argc)
+		{
+			options.gutter = atoi(argv[++arg]);
+		}
+		else if (strcmp(argv[arg], "--compress") == 0)
+		{
+			compress = true;
+		}
+		else
+		{
+			return usage();
+		}
+	}
+	if (argc - arg < 2)
+	{
+		return usage();
+	}
+
+	filesystem::path manifest = argv[arg++];
+	vector<AtlasImage> images;
+	for (; arg < argc; arg++)
+	{
+		AtlasImage image;
+		int nrChannels;
+		unsigned char *data = stbi_load(argv[arg], &image.width, &image.height, &nrChannels, 4);
+		if (!data)
+		{
+			cout << "ERROR::BAKE::FILE_NOT_READ " << argv[arg] << endl;
+			return 1;
+		}
+		image.name = filesystem::path(argv[arg]).filename().string();
+		image.pixels.assign(data, data + (size_t)image.width * image.height * 4);
+		stbi_image_free(data);
+		images.push_back(move(image));
+	}
+
+	vector<AtlasPage> pages;
+	vector<AtlasEntry> entries;
+	if (!AtlasPacker::pack(images, options, pages, entries))
+	{
+		return 1;
+	}
+
+	vector<string> pageFiles;
+	for (size_t i = 0; i < pages.size(); i++)
+	{
+		// levels below mipLevels would blend neighbours across the gutter
+		vector<TextureLevel> levels;
+		MipGenerator::generate(pages[i].pixels.data(), pages[i].width, pages[i].height, 4, MipOptions(), levels);
+		levels.resize(min(levels.size(), (size_t)options.mipLevels + 1));
+
+		uint32_t format = TEX_FMT_RGBA8;
+		if (compress)
+		{
+			format = TEX_FMT_BC3;
+			for (TextureLevel &level : levels)
+			{
+				level = BlockCompressor::compress(level, 4, format, BC_NORMAL);
+			}
+		}
+
+		pageFiles.push_back(manifest.stem().string() + "_" + to_string(i) + ".ltex");
+		if (!TextureFile::write((manifest.parent_path() / pageFiles.back()).string(), format, TEX_FLAG_SRGB, levels))
+		{
+			return 1;
+		}
+	}
+	if (!AtlasPacker::writeManifest(manifest.string(), pageFiles, pages, entries))
+	{
+		return 1;
+	}
+
+	cout << "packed " << images.size() << " images into " << pages.size() << " pages of " << options.pageSize << "x" << options.pageSize << endl;
+	for (size_t i = 0; i < pages.size(); i++)
+	{
+		cout << "  " << pageFiles[i] << ": " << pages[i].occupancy() * 100.f << "% occupied" << endl;
+	}
+	cout << "  texture binds per frame when drawing each image once: " << images.size() << " -> " << pages.size()
+		 << " (" << images.size() - pages.size() << " eliminated)" << endl;
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		return usage();
+	}
+
+	string command = argv[1];
+	if (command == "texture")
+	{
+		BakeOptions options;
+		int arg = 2;
+		for (; arg < argc && strncmp(argv[arg], "--", 2) == 0; arg++)
+		{
+			if (strcmp(argv[arg], "--compress") == 0)
+			{
+				options.compress = true;
+			}
+			else if (strcmp(argv[arg], "--fast") == 0)
+			{
+				options.quality = BC_FAST;
+			}
+			else if (strcmp(argv[arg], "--kaiser") == 0)
+			{
+				options.mips.filter = MIP_KAISER;
+			}
+			else if (strcmp(argv[arg], "--alpha-cutoff") == 0 && arg + 1 < argc)
+			{
+				options.mips.alphaCutoff = (float)atof(argv[++arg]);
+			}
+			else
+			{
+				return usage();
+			}
+		}
+		if (argc - arg != 2)
+		{
+			return usage();
+		}
+
+		if (!TextureBaker::bake(argv[arg], argv[arg + 1], options))
+		{
+			return 1;
+		}
+		cout << "baked " << argv[arg] << " -> " << argv[arg + 1] << endl;
+		return 0;
+	}
+	if (command == "bc-report" && argc == 3)
+	{
+		return bcReport(argv[2]);
+	}
+	if (command == "atlas")
+	{
+		return atlas(argc, argv);
+	}
+	if (command == "mip-report" && argc == 3)
+	{
+		return mipReport(argv[2]);
+	}
+	if (command == "jpeg-report" && argc >= 3)
+	{
+		return jpegReport(argc, argv);
+	}
+	if (command == "vt")
+	{
+		return virtualTexture(argc, argv);
+	}
+	if (command == "mesh" || command == "mesh-grid" || command == "meshes")
+	{
+		MeshBakeOptions options;
+		int arg = 2;
+		for (; arg < argc && strncmp(argv[arg], "--", 2) == 0; arg++)
+		{
+			if (strcmp(argv[arg], "--no-optimize") == 0)
+			{
+				options.optimize = false;
+			}
+			else if (strcmp(argv[arg], "--no-lods") == 0)
+			{
+				options.lods = false;
+			}
+			else if (strcmp(argv[arg], "--vertex-format") != 0 || arg + 1 >= argc || !MeshQuantizer::parseFormat(argv[++arg], options.format))
+			{
+				return usage();
+			}
+		}
+		if (command == "meshes")
+		{
+			return argc - arg >= 2 ? meshes(argv[arg], argv + arg + 1, argc - arg - 1, options) : usage();
+		}
+		if (argc - arg != 2)
+		{
+			return usage();
+		}
+		return command == "mesh" ? mesh(argv[arg], argv[arg + 1], options) : meshGrid(atoi(argv[arg]), argv[arg + 1], options);
+	}
+	if (command == "optimize-report" && argc >= 3)
+	{
+		return optimizeReport(argc, argv);
+	}
+	if (command == "quantize-report" && argc >= 3)
+	{
+		return quantizeReport(argc, argv);
+	}
+	if (command == "gltf-report" && argc >= 3)
+	{
+		return gltfReport(argc, argv);
+	}
+
+	return usage();
+}
\ No newline at end of file
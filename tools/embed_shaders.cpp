@@ -0,0 +1,168 @@
+// Build step: turns the GLSL files given on the command line into a header of constexpr string
+// data, so the executable does not need res/shaders at runtime.
+//
+//	embed_shaders [--minify] <output header> <shader files...>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static string fileName(const string &path)
+{
+	size_t slash = path.find_last_of("/\\");
+	return slash == string::npos ? path : path.substr(slash + 1);
+}
+
+// drops comments, indentation, trailing whitespace and blank lines, preprocessor lines stay intact
+static string minify(const string &source)
+{
+	string withoutComments;
+	withoutComments.reserve(source.size());
+	for (size_t i = 0; i < source.size(); i++)
+	{
+		if (source.compare(i, 2, "//") == 0)
+		{
+			while (i < source.size() && source[i] != '\n')
+			{
+				i++;
+			}
+			withoutComments += '\n';
+		}
+		else if (source.compare(i, 2, "/*") == 0)
+		{
+			size_t end = source.find("*/", i + 2);
+			end = end == string::npos ? source.size() : end + 2;
+			// keep line breaks so a following directive still starts its own line
+			for (size_t j = i; j < end; j++)
+			{
+				if (source[j] == '\n')
+				{
+					withoutComments += '\n';
+				}
+			}
+			withoutComments += ' ';
+			i = end - 1;
+		}
+		else
+		{
+			withoutComments += source[i];
+		}
+	}
+
+	string result;
+	istringstream lines(withoutComments);
+	string line;
+	while (getline(lines, line))
+	{
+		size_t first = line.find_first_not_of(" \t\r");
+		if (first == string::npos)
+		{
+			continue;
+		}
+		size_t last = line.find_last_not_of(" \t\r");
+		result += line.substr(first, last - first + 1) + "\n";
+	}
+	return result;
+}
+
+static string escape(const string &source)
+{
+	string result;
+	for (char c : source)
+	{
+		switch (c)
+		{
+		case '\\':
+			result += "\\\\";
+			break;
+		case '"':
+			result += "\\\"";
+			break;
+		case '\n':
+			result += "\\n\"\n\t\t\"";
+			break;
+		case '\t':
+			result += "\\t";
+			break;
+		case '\r':
+			break;
+		default:
+			result += c;
+		}
+	}
+	return result;
+}
+
+int main(int argc, char **argv)
+{
+	int arg = 1;
+	bool minified = false;
+	if (arg < argc && string(argv[arg]) == "--minify")
+	{
+		minified = true;
+		arg++;
+	}
+	if (argc - arg < 1)
+	{
+		cout << "usage: embed_shaders [--minify] <output header> <shader files...>" << endl;
+		return 1;
+	}
+
+	string outputPath = argv[arg++];
+	stringstream header;
+	header << "// generated by tools/embed_shaders.cpp, do not edit\n"
+		   << "#ifndef GENERATED_EMBEDDEDSHADERS_HPP\n"
+		   << "#define GENERATED_EMBEDDEDSHADERS_HPP\n\n"
+		   << "#include <cstddef>\n\n"
+		   << "struct EmbeddedShader\n{\n\tconst char *name;\n\tconst char *source;\n\tsize_t length;\n};\n\n"
+		   << "constexpr EmbeddedShader EMBEDDED_SHADERS[] = {\n";
+
+	int count = 0;
+	for (; arg < argc; arg++)
+	{
+		ifstream file(argv[arg], ios::binary);
+		if (!file)
+		{
+			cout << "ERROR::EMBED_SHADERS::FILE_NOT_READ " << argv[arg] << endl;
+			return 1;
+		}
+		stringstream stream;
+		stream << file.rdbuf();
+		string source = minified ? minify(stream.str()) : stream.str();
+		// CRLF checkouts embed as LF, and the recorded length has to match what the literal holds
+		source.erase(remove(source.begin(), source.end(), '\r'), source.end());
+
+		header << "\t{\"" << fileName(argv[arg]) << "\",\n\t\t\"" << escape(source) << "\",\n\t\t" << source.size() << "},\n";
+		count++;
+	}
+
+	header << "};\n\n"
+		   << "constexpr size_t EMBEDDED_SHADER_COUNT = " << count << ";\n\n"
+		   << "#endif // GENERATED_EMBEDDEDSHADERS_HPP\n";
+
+	// only touch the header when it changes, so make does not rebuild the executable for nothing
+	string content = header.str();
+	ifstream existing(outputPath, ios::binary);
+	stringstream previous;
+	previous << existing.rdbuf();
+	if (existing && previous.str() == content)
+	{
+		return 0;
+	}
+	existing.close();
+
+	ofstream output(outputPath, ios::binary | ios::trunc);
+	if (!output)
+	{
+		cout << "ERROR::EMBED_SHADERS::CANNOT_WRITE " << outputPath << endl;
+		return 1;
+	}
+	output << content;
+	cout << "embedded " << count << " shaders into " << outputPath << endl;
+	return 0;
+}
\ No newline at end of file